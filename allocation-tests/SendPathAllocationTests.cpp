@@ -0,0 +1,92 @@
+// Exécutable à part (AllocationTests) : l'operator new global y est remplacé pour compter les allocations,
+// ce qui ne doit toucher ni les autres tests, ni Catch2, ni JUCE du binaire Tests.
+
+#include <Common/RtpFanout.h>
+#include <Common/RtpPacketPool.h>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Allocateur global instrumenté : compte les allocations du thread courant pendant une mesure
+namespace
+{
+    thread_local bool countingAllocations = false;
+    thread_local size_t allocationCount = 0;
+
+    void* countedAllocate (const std::size_t size)
+    {
+        if (countingAllocations)
+            ++allocationCount;
+        if (void* pointer = std::malloc (size == 0 ? 1 : size))
+            return pointer;
+        throw std::bad_alloc();
+    }
+
+    struct AllocationCounter
+    {
+        AllocationCounter()
+        {
+            allocationCount = 0;
+            countingAllocations = true;
+        }
+        ~AllocationCounter() { countingAllocations = false; }
+
+        [[nodiscard]] size_t getCount() const noexcept { return allocationCount; }
+    };
+}
+
+void* operator new (const std::size_t size) { return countedAllocate (size); }
+void* operator new[] (const std::size_t size) { return countedAllocate (size); }
+void operator delete (void* pointer) noexcept { std::free (pointer); }
+void operator delete[] (void* pointer) noexcept { std::free (pointer); }
+void operator delete (void* pointer, std::size_t) noexcept { std::free (pointer); }
+void operator delete[] (void* pointer, std::size_t) noexcept { std::free (pointer); }
+
+TEST_CASE ("Sender packetisation does not allocate", "[rtp][allocation]")
+{
+    // Même enchaînement que WebRTCAudioSenderService::encodeAndSendFrame et
+    // WebRTCSenderConnexionHandler::sendAudioPacket : encodage dans la réserve, puis réécriture de l'en-tête
+    // et envoi pour chaque auditeur. Seul track->send est remplacé, libdatachannel copiant le paquet de toute façon.
+    constexpr int frameSamples = 480;
+    constexpr int numChannels = 2;
+    OpusEncoderWrapper encoder (48000, numChannels, 10, 96000);
+    RtpPacketPool<8> pool;
+    std::array outputs { RtpFanoutOutput (1, 100, 0), RtpFanoutOutput (2, 200, 1000) };
+    std::array<unsigned char, RtpPacketBuffer::capacity> wire {};
+
+    std::vector<float> frame (static_cast<size_t> (frameSamples * numChannels));
+    for (size_t i = 0; i < frame.size(); ++i)
+        frame[i] = 0.25f * static_cast<float> (std::sin (0.05 * static_cast<double> (i / numChannels)));
+
+    uint32_t timestamp = 0;
+    size_t sentBytes = 0;
+    bool allEncoded = true;
+    const auto send = [&] (const std::span<const std::byte> bytes) {
+        std::memcpy (wire.data(), bytes.data(), bytes.size());
+        sentBytes += bytes.size();
+        return true;
+    };
+
+    // Aucune assertion Catch dans la boucle mesurée : elles pourraient elles-mêmes allouer
+    const AllocationCounter counter;
+    for (int i = 0; i < 200; ++i)
+    {
+        auto* packet = pool.encode (encoder, frame.data(), frameSamples);
+        allEncoded = allEncoded && packet != nullptr;
+        if (packet == nullptr)
+            continue;
+        timestamp += frameSamples;
+        for (auto& output : outputs)
+            output.send (*packet, timestamp, 0, send);
+    }
+    const auto allocations = counter.getCount();
+
+    CHECK (allocations == 0);
+    CHECK (allEncoded);
+    CHECK (outputs[0].getSentPackets() == 200);
+    CHECK (outputs[1].getSentPackets() == 200);
+    CHECK (sentBytes > 400 * RtpHeaderTemplate::size);
+}
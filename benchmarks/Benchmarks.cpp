@@ -1,20 +1,21 @@
-#include "PluginEditor.h"
+#include "MainAudioProcessor.h"
 #include "catch2/benchmark/catch_benchmark_all.hpp"
 #include "catch2/catch_test_macros.hpp"
+#include <chrono>
 
 TEST_CASE ("Boot performance")
 {
     BENCHMARK_ADVANCED ("Processor constructor")
     (Catch::Benchmark::Chronometer meter)
     {
-        std::vector<Catch::Benchmark::storage_for<PluginProcessor>> storage (size_t (meter.runs()));
+        std::vector<Catch::Benchmark::storage_for<MainAudioProcessor>> storage (size_t (meter.runs()));
         meter.measure ([&] (int i) { storage[(size_t) i].construct(); });
     };
 
     BENCHMARK_ADVANCED ("Processor destructor")
     (Catch::Benchmark::Chronometer meter)
     {
-        std::vector<Catch::Benchmark::destructable_object<PluginProcessor>> storage (size_t (meter.runs()));
+        std::vector<Catch::Benchmark::destructable_object<MainAudioProcessor>> storage (size_t (meter.runs()));
         for (auto& s : storage)
             s.construct();
         meter.measure ([&] (int i) { storage[(size_t) i].destruct(); });
@@ -23,7 +24,7 @@ TEST_CASE ("Boot performance")
     BENCHMARK_ADVANCED ("Editor open and close")
     (Catch::Benchmark::Chronometer meter)
     {
-        PluginProcessor plugin;
+        MainAudioProcessor plugin;
 
         // due to complex construction logic of the editor, let's measure open/close together
         meter.measure ([&] (int /* i */) {
@@ -34,3 +35,19 @@ TEST_CASE ("Boot performance")
         });
     };
 }
+
+TEST_CASE ("Editor opening budget")
+{
+    // L'éditeur n'est qu'une vue du moteur détenu par le processeur : l'ouvrir reste sous 50 ms,
+    // y compris la première fois, où il démarre le moteur sans attendre le réseau
+    MainAudioProcessor plugin;
+    for (int i = 0; i < 5; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto* editor = plugin.createEditorIfNeeded();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        plugin.editorBeingDeleted (editor);
+        delete editor;
+        CHECK (elapsed < std::chrono::milliseconds (50));
+    }
+}
@@ -0,0 +1,194 @@
+#include "LocalMeloServer.h"
+#include "Api/ApiService.h"
+#include "Config.h"
+#include "EngineContext.h"
+#include "RtcReceiver/WebRTCAudioReceiverService.h"
+#include "RtcSender/WebRTCAudioSenderService.h"
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr auto connectionTimeout = std::chrono::seconds (10);
+
+    // Suit, depuis les threads de libdatachannel, la connexion de l'émetteur et l'arrivée des paquets chez le récepteur
+    class ConnectionProbe
+    {
+    public:
+        ConnectionProbe (EventManager& senderEvents, EventManager& receiverEvents)
+        {
+            stateSubscription = senderEvents.subscribe<RTCStateChangeEvent> ([this] (const RTCStateChangeEvent& event) {
+                update ([&] { connected = event.state == rtc::PeerConnection::State::Connected; });
+            });
+            packetSubscription = receiverEvents.subscribe<AudioBlockReceivedEvent> ([this] (const AudioBlockReceivedEvent&) {
+                update ([&] { packetReceived = true; });
+            });
+        }
+
+        void reset()
+        {
+            update ([&] {
+                connected = false;
+                packetReceived = false;
+            });
+        }
+
+        bool waitForConnected() { return waitFor ([&] { return connected; }); }
+        bool waitForFirstPacket() { return waitFor ([&] { return packetReceived; }); }
+        bool waitForDisconnected() { return waitFor ([&] { return !connected; }); }
+
+    private:
+        template <typename Update>
+        void update (Update&& apply)
+        {
+            {
+                const std::lock_guard lock (mutex);
+                apply();
+            }
+            condition.notify_all();
+        }
+
+        template <typename Predicate>
+        bool waitFor (Predicate&& predicate)
+        {
+            std::unique_lock lock (mutex);
+            return condition.wait_for (lock, connectionTimeout, predicate);
+        }
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool connected = false;
+        bool packetReceived = false;
+
+        EventSubscription stateSubscription, packetSubscription;
+    };
+
+    // Joue le rôle de processBlock : 10 ms de sinus stéréo toutes les 10 ms dans la FIFO de capture
+    class CaptureFeeder
+    {
+    public:
+        explicit CaptureFeeder (SpscAudioFifo& fifo) : captureFifo (fifo)
+        {
+            thread = std::thread ([this] {
+                constexpr int numFrames = 441;
+                std::vector<float> block (numFrames * 2);
+                for (int frame = 0; frame < numFrames; ++frame)
+                    block[static_cast<size_t> (frame * 2)] = block[static_cast<size_t> (frame * 2 + 1)] = 0.25f * static_cast<float> (std::sin (0.0627 * frame));
+
+                auto next = std::chrono::steady_clock::now();
+                while (running.load())
+                {
+                    captureFifo.write (block.data(), block.size());
+                    next += std::chrono::milliseconds (10);
+                    std::this_thread::sleep_until (next);
+                }
+            });
+        }
+
+        ~CaptureFeeder()
+        {
+            running.store (false);
+            thread.join();
+        }
+
+    private:
+        SpscAudioFifo& captureFifo;
+        std::atomic<bool> running { true };
+        std::thread thread;
+    };
+
+    // Un émetteur et un récepteur dans le même processus, reliés par le serveur local
+    struct LocalSession
+    {
+        explicit LocalSession (const PopulatedSession& session)
+        {
+            captureFifo.prepare (44100);
+            // Comme après GetMyOngoingSessions : connexion aux routes RTC et pré-chauffage de l'émetteur
+            senderContext.getEventManager().publish (OngoingSessionsChangedEvent { { session } });
+            senderContext.getEventManager().publish (OngoingSessionChangedEvent { session });
+            receiverContext.getEventManager().publish (OngoingSessionChangedEvent { session });
+        }
+
+        EngineContext senderContext, receiverContext;
+        SpscAudioFifo captureFifo;
+        AudioPlayout audioPlayout;
+        WebRTCAudioSenderService sender { senderContext, captureFifo };
+        WebRTCAudioReceiverService receiver { receiverContext, audioPlayout };
+        ConnectionProbe probe { senderContext.getEventManager(), receiverContext.getEventManager() };
+        CaptureFeeder feeder { captureFifo };
+    };
+}
+
+// Établissement de la connexion de bout en bout contre le serveur local (tools/LocalServer) plutôt que staging :
+// les mesures ne dépendent que du code du plugin et de libdatachannel, pas du réseau ni de la charge du serveur.
+TEST_CASE ("Connection setup performance", "[connection]")
+{
+    LocalMeloServer server (LocalMeloServer::defaultPort + 100);
+    REQUIRE (server.start());
+    const auto previousUrls = Config::getServerUrls();
+    Config::setServerUrls ({ server.getApiUrl(), server.getWebsocketUrl() });
+
+    // La session passe par l'API, comme dans le plugin
+    const auto ongoingSessions = PopulatedSession::parseArrayFromJsonString (ApiService::makeGETRequest (ApiRoute::GetMyOngoingSessions));
+    REQUIRE (ongoingSessions.size() == 1);
+
+    LocalSession session (ongoingSessions.getFirst());
+    // Le serveur ne garde rien : les deux routes RTC doivent être ouvertes avant la première offre
+    const auto deadline = std::chrono::steady_clock::now() + connectionTimeout;
+    while (server.getNumConnectedClients() < 2 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for (std::chrono::milliseconds (5));
+    REQUIRE (server.getNumConnectedClients() == 2);
+
+    BENCHMARK_ADVANCED ("Time to connected (pre-warmed offer)")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        session.sender.disconnect();
+        session.probe.waitForDisconnected();
+        session.sender.prewarmConnection();
+        session.probe.reset();
+
+        meter.measure ([&] {
+            session.sender.setupConnection();
+            return session.probe.waitForConnected();
+        });
+    };
+
+    BENCHMARK_ADVANCED ("Time to first packet")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        session.sender.disconnect();
+        session.probe.waitForDisconnected();
+        session.sender.prewarmConnection();
+        session.probe.reset();
+
+        meter.measure ([&] {
+            session.sender.setupConnection();
+            return session.probe.waitForFirstPacket();
+        });
+    };
+
+    BENCHMARK_ADVANCED ("Reconnect to first packet")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        if (! session.sender.isConnected())
+            session.sender.setupConnection();
+        session.probe.waitForFirstPacket();
+        session.probe.reset();
+
+        // Même chemin que la reprise après une coupure ICE (attemptReconnect)
+        meter.measure ([&] {
+            session.sender.resetConnection();
+            return session.probe.waitForFirstPacket();
+        });
+    };
+
+    CHECK (server.getNumRelayedMessages() > 0);
+    Config::setServerUrls (previousUrls);
+}
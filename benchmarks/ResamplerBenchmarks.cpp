@@ -0,0 +1,61 @@
+#include <Common/AdaptiveResampler.h>
+#include <Common/StreamingResampler.h>
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Bloc de 10 ms de sinus stéréo entrelacé
+    std::vector<float> makeInterleavedSine (const int numFrames, const int numChannels, const double sampleRate)
+    {
+        std::vector<float> block (static_cast<size_t> (numFrames * numChannels));
+        for (int frame = 0; frame < numFrames; ++frame)
+            for (int channel = 0; channel < numChannels; ++channel)
+                block[static_cast<size_t> (frame * numChannels + channel)] = static_cast<float> (std::sin (2.0 * 3.14159265358979 * 440.0 * frame / sampleRate));
+        return block;
+    }
+}
+
+TEST_CASE ("Resampler performance")
+{
+    constexpr int numChannels = 2;
+
+    BENCHMARK_ADVANCED ("Send path 44.1 kHz -> 48 kHz, 10 ms stereo block")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        constexpr int captureFrames = 441;
+        StreamingResampler resampler;
+        resampler.prepare (44100.0, 48000.0, numChannels, captureFrames);
+        const auto input = makeInterleavedSine (captureFrames, numChannels, 44100.0);
+        std::vector<float> output (static_cast<size_t> (resampler.getMaxOutputFrames() * numChannels));
+
+        meter.measure ([&] { return resampler.processInterleaved (input.data(), captureFrames, output); });
+    };
+
+    BENCHMARK_ADVANCED ("Send path 48 kHz passthrough, 10 ms stereo block")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        constexpr int captureFrames = 480;
+        StreamingResampler resampler;
+        resampler.prepare (48000.0, 48000.0, numChannels, captureFrames);
+        const auto input = makeInterleavedSine (captureFrames, numChannels, 48000.0);
+        std::vector<float> output (static_cast<size_t> (resampler.getMaxOutputFrames() * numChannels));
+
+        meter.measure ([&] { return resampler.processInterleaved (input.data(), captureFrames, output); });
+    };
+
+    BENCHMARK_ADVANCED ("Playout 48 kHz -> 44.1 kHz with drift correction, 10 ms mono frame")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        constexpr int frameSamples = 480;
+        AdaptiveResampler resampler;
+        resampler.prepare (48000.0, 44100.0, frameSamples);
+        resampler.setRatio (1.0002);
+        const auto input = makeInterleavedSine (frameSamples, 1, 48000.0);
+        std::vector<float> output (static_cast<size_t> (resampler.getMaxOutputSamples()));
+
+        meter.measure ([&] { return resampler.process (input.data(), frameSamples, output.data()); });
+    };
+}
@@ -1,5 +1,6 @@
 #include "ApiService.h"
 #include "../Common/JuceLocalStorage.h"
+#include "../Config.h"
 
 // Méthode GET
 juce::String ApiService::makeGETRequest(const ApiRoute route)
@@ -40,7 +41,8 @@ juce::String ApiService::makeHttpRequest(const ApiRoute route, RequestConfig con
 
         auto res = stream->readEntireStreamAsString();
         const auto jsonResponse = juce::JSON::parse(res);
-        if (!jsonResponse.isObject())
+        // Les listes (ex. sessions en cours) sont renvoyées telles quelles
+        if (!jsonResponse.isObject() && !jsonResponse.isArray())
         {
             juce::Logger::outputDebugString("Réponse non valide : " + res);
             return "";
@@ -96,5 +98,5 @@ juce::URL::InputStreamOptions ApiService::buildOptions()
 // Méthode pour construire l'URL complète
 juce::String ApiService::buildApiUrl(const ApiRoute route)
 {
-    return Config::apiUrl + getApiRouteString(route);
+    return Config::getServerUrls().apiUrl + getApiRouteString(route);
 }
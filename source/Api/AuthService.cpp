@@ -3,10 +3,9 @@
 #include "../Utils/StringUtils.h"
 #include "../Common//JuceLocalStorage.h"
 #include "../Common/EventManager.h"
+#include "../Common/CrashHandler.h"
 
-AuthService &AuthService::getInstance() {
-    static AuthService instance;
-    return instance;
+AuthService::AuthService(EventManager &eventManager): eventManager(eventManager) {
 }
 
 juce::String AuthService::login(const juce::String &email, const juce::String &password) {
@@ -23,7 +22,7 @@ juce::String AuthService::login(const juce::String &email, const juce::String &p
         auto accessToken = StringUtils::parseJsonStringToKeyPair(res).getValue("access_token", "");
         JuceLocalStorage::getInstance().saveValue("access_token", accessToken);
         fetchUserContext();
-        EventManager::getInstance().notifyLogin(accessToken);
+        eventManager.publish(LoginEvent{accessToken});
         return accessToken;
     } catch (std::exception &e) {
         juce::Logger::outputDebugString("Login failed : " + juce::String(e.what()));
@@ -38,15 +37,27 @@ std::optional<UserContext> AuthService::fetchUserContext() {
         logout();
         return std::nullopt;
     }
-    userContext = UserContext().fromJsonString(myUserContext);
-    return userContext;
+    const auto fetchedContext = UserContext::fromJsonString(myUserContext);
+    {
+        const std::lock_guard lock(userContextMutex);
+        userContext = fetchedContext;
+    }
+    CrashHandler::setUserId(fetchedContext.user._id);
+    eventManager.publish(UserContextChangedEvent{fetchedContext});
+    return fetchedContext;
 }
 
 void AuthService::logout() {
     JuceLocalStorage::getInstance().removeValue("access_token");
-    EventManager::getInstance().notifyLogout();
+    {
+        const std::lock_guard lock(userContextMutex);
+        userContext.reset();
+    }
+    eventManager.publish(UserContextChangedEvent{});
+    eventManager.publish(LogoutEvent{});
 }
 
 std::optional<UserContext> AuthService::getUserContext() const {
+    const std::lock_guard lock(userContextMutex);
     return userContext;
 }
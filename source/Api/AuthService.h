@@ -1,20 +1,28 @@
 #pragma once
 #include <juce_core/juce_core.h>
+#include <mutex>
 #include "../Models/UserContext.h"
 
+class EventManager;
+
+// Session de l'utilisateur pour une instance du plugin. Le jeton d'accès reste stocké dans
+// JuceLocalStorage (commun au processus) ; connexion, déconnexion et contexte utilisateur sont publiés
+// sur le bus de l'instance. Les méthodes qui interrogent l'API sont bloquantes : hors message thread.
 class AuthService
 {
 public:
+    explicit AuthService(EventManager& eventManager);
+
     juce::String login(const juce::String& email, const juce::String& password);
 
-    static void logout();
-    static AuthService& getInstance();
+    void logout();
     std::optional<UserContext> getUserContext() const;
     std::optional<UserContext> fetchUserContext();
 
 private:
+    EventManager& eventManager;
+    mutable std::mutex userContextMutex;
     std::optional<UserContext> userContext;
-    AuthService() {}
     AuthService(const AuthService&) = delete;
     AuthService& operator=(const AuthService&) = delete;
 };
\ No newline at end of file
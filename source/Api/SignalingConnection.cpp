@@ -0,0 +1,195 @@
+#include "SignalingConnection.h"
+#include "WebSocketService.h"
+#include "../Common/JuceLocalStorage.h"
+#include "../Config.h"
+#include "../ThirdParty/json.hpp"
+
+std::shared_ptr<SignalingConnection> SignalingConnection::acquire(const juce::String &wsRoute) {
+    static std::mutex registryMutex;
+    static std::map<juce::String, std::weak_ptr<SignalingConnection>> connections;
+
+    const std::lock_guard lock(registryMutex);
+    auto &entry = connections[wsRoute];
+    if (auto connection = entry.lock()) {
+        return connection;
+    }
+    auto connection = std::make_shared<SignalingConnection>(wsRoute);
+    entry = connection;
+    return connection;
+}
+
+SignalingConnection::SignalingConnection(const juce::String &route): wsRoute(route) {
+    juce::Logger::outputDebugString(juce::String::fromUTF8("WebSocket initialisé : ") + wsRoute);
+    juce::File certDir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+    ix::SocketTLSOptions tlsOptions;
+    tlsOptions.caFile = certDir.getChildFile("ca-certificates.crt").getFullPathName().toStdString();
+    tlsOptions.disable_hostname_validation = true;
+    webSocket.setTLSOptions(tlsOptions);
+    webSocket.setOnMessageCallback([this](const ix::WebSocketMessagePtr &msg) { onMessage(msg); });
+}
+
+SignalingConnection::~SignalingConnection() {
+    webSocket.stop();
+}
+
+void SignalingConnection::addListener(WebSocketService &listener) {
+    const std::lock_guard lock(listenersMutex);
+    if (std::find(listeners.begin(), listeners.end(), &listener) == listeners.end()) {
+        listeners.push_back(&listener);
+    }
+}
+
+void SignalingConnection::removeListener(WebSocketService &listener) {
+    bool isLastListener = false;
+    {
+        std::unique_lock lock(listenersMutex);
+        listeners.erase(std::remove(listeners.begin(), listeners.end(), &listener), listeners.end());
+        isLastListener = listeners.empty();
+        // L'inscrit peut être détruit au retour : on attend qu'il ait fini de recevoir, sauf s'il se retire
+        // lui-même depuis cette remise (il attendrait alors son propre thread)
+        deliveryFinished.wait(lock, [&] {
+            return deliveringTo != &listener || deliveringThread == std::this_thread::get_id();
+        });
+    }
+    if (!isLastListener) {
+        return;
+    }
+
+    {
+        const std::lock_guard lock(connectionMutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+        reconnectAfterStop = false;
+    }
+    // Hors de tout verrou : stop() attend le thread ixwebsocket, qui peut être en train de remettre un
+    // message à un gestionnaire qui envoie, donc appelle connect()
+    webSocket.stop();
+
+    bool shouldReconnect = false;
+    {
+        const std::lock_guard lock(connectionMutex);
+        stopping = false;
+        shouldReconnect = reconnectAfterStop;
+    }
+    if (!shouldReconnect) {
+        bool hasListeners = false;
+        {
+            const std::lock_guard lock(listenersMutex);
+            hasListeners = !listeners.empty();
+        }
+        if (!hasListeners) {
+            // Plus personne pour les envoyer : offres et candidats en attente seraient périmés à la prochaine connexion
+            const std::lock_guard outboundLock(outboundMutex);
+            pendingMessages.clear();
+        }
+        return;
+    }
+    connect();
+}
+
+bool SignalingConnection::isOpen() const {
+    return webSocket.getReadyState() == ix::ReadyState::Open;
+}
+
+void SignalingConnection::connect() {
+    const std::lock_guard lock(connectionMutex);
+    // Une fermeture est en cours sur un autre thread : la connexion sera relancée quand elle aura abouti
+    if (stopping) {
+        reconnectAfterStop = true;
+        return;
+    }
+    if (webSocket.getReadyState() == ix::ReadyState::Open || webSocket.getReadyState() == ix::ReadyState::Connecting) {
+        return;
+    }
+    // URL relue à chaque connexion, comme le jeton : le serveur peut être remplacé (serveur local de test)
+    const auto url = Config::getServerUrls().websocketUrl + wsRoute;
+    juce::Logger::outputDebugString("Connecting to WebSocket server at " + url);
+    webSocket.setUrl(url.toStdString());
+
+    // Jeton lu à chaque connexion : la connexion peut être créée avant que l'utilisateur ne se connecte
+    if (const auto accessToken = JuceLocalStorage::getInstance().loadValue("access_token"); accessToken.isNotEmpty()) {
+        webSocket.setExtraHeaders({{"Authorization", "Bearer " + accessToken.toStdString()}});
+    }
+    webSocket.start();
+}
+
+void SignalingConnection::send(std::string message) {
+    {
+        const std::lock_guard lock(outboundMutex);
+        if (pendingMessages.empty() && webSocket.getReadyState() == ix::ReadyState::Open) {
+            webSocket.sendText(message);
+            return;
+        }
+        if (pendingMessages.size() >= maxPendingMessages) {
+            pendingMessages.pop_front();
+        }
+        pendingMessages.push_back(std::move(message));
+    }
+    if (webSocket.getReadyState() == ix::ReadyState::Closed) {
+        connect();
+    }
+}
+
+// Thread ixwebsocket, à l'ouverture (y compris après une reconnexion automatique)
+void SignalingConnection::flushPendingMessages() {
+    const std::lock_guard lock(outboundMutex);
+    if (!pendingMessages.empty()) {
+        juce::Logger::outputDebugString("Sending " + std::to_string(pendingMessages.size()) + " queued messages");
+    }
+    while (!pendingMessages.empty() && webSocket.getReadyState() == ix::ReadyState::Open) {
+        webSocket.sendText(pendingMessages.front());
+        pendingMessages.pop_front();
+    }
+}
+
+void SignalingConnection::onMessage(const ix::WebSocketMessagePtr &msg) {
+    switch (msg->type) {
+        case ix::WebSocketMessageType::Open:
+            juce::Logger::outputDebugString("WebSocket ouvert : " + juce::String(msg->openInfo.uri));
+            flushPendingMessages();
+            break;
+        case ix::WebSocketMessageType::Message: {
+            // Analysé une seule fois, quel que soit le nombre d'instances inscrites
+            const auto receivedMessage = nlohmann::json::parse(msg->str);
+            const std::string type = receivedMessage["type"];
+            juce::Logger::outputDebugString("Message de type " + type + " reçu.");
+
+            std::vector<WebSocketService*> recipients;
+            {
+                const std::lock_guard lock(listenersMutex);
+                recipients = listeners;
+            }
+            const auto &data = receivedMessage["data"];
+            for (auto *listener: recipients) {
+                {
+                    // Un inscrit peut s'être retiré pendant la remise du message précédent
+                    const std::lock_guard lock(listenersMutex);
+                    if (std::find(listeners.begin(), listeners.end(), listener) == listeners.end()) {
+                        continue;
+                    }
+                    deliveringTo = listener;
+                    deliveringThread = std::this_thread::get_id();
+                }
+                // Verrou relâché : le gestionnaire peut s'inscrire, se retirer ou envoyer
+                listener->deliver(type, data);
+                {
+                    const std::lock_guard lock(listenersMutex);
+                    deliveringTo = nullptr;
+                    deliveringThread = {};
+                }
+                deliveryFinished.notify_all();
+            }
+            break;
+        }
+        case ix::WebSocketMessageType::Error:
+            juce::Logger::outputDebugString("Erreur WebSocket : " + juce::String(msg->errorInfo.reason));
+            break;
+        case ix::WebSocketMessageType::Close:
+            juce::Logger::outputDebugString("WebSocket fermee");
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <ixwebsocket/ixwebsocket/IXWebSocket.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WebSocketService;
+
+// Connexion WebSocket de signalisation partagée par toutes les instances du plugin du processus :
+// une seule poignée de main TLS et un seul thread ixwebsocket par route, quel que soit le nombre d'instances.
+// Chaque WebSocketService connecté y est inscrit ; un message reçu est analysé une fois puis remis à chacun,
+// qui le publie sur le bus de son instance. Les gestionnaires filtrent ensuite sur le type du message.
+// La connexion est ouverte à la première inscription et fermée au départ du dernier inscrit.
+// Les envois ne bloquent jamais : offres, réponses et candidats ICE émis pendant la connexion sont mis
+// en file et partent dès l'ouverture, plutôt que d'être perdus.
+class SignalingConnection
+{
+public:
+    // Connexion de la route, créée au premier appel et détruite quand plus aucun service ne la référence
+    static std::shared_ptr<SignalingConnection> acquire(const juce::String& wsRoute);
+
+    explicit SignalingConnection(const juce::String& route);
+    ~SignalingConnection();
+
+    SignalingConnection(const SignalingConnection&) = delete;
+    SignalingConnection& operator=(const SignalingConnection&) = delete;
+
+    void addListener(WebSocketService& listener);
+    // Attend la fin d'une remise en cours à cet inscrit. Le départ du dernier inscrit ferme la connexion et
+    // ne doit donc pas venir du thread ixwebsocket
+    void removeListener(WebSocketService& listener);
+
+    [[nodiscard]] bool isOpen() const;
+    // Lance la connexion sans attendre : l'ouverture est signalée par le thread ixwebsocket
+    void connect();
+    // N'attend jamais : envoyé tout de suite si la connexion est ouverte, sinon mis en file (et la connexion
+    // relancée si elle est fermée) puis envoyé, dans l'ordre, dès l'ouverture
+    void send(std::string message);
+
+    // Messages au-delà desquels les plus anciens en attente sont abandonnés
+    static constexpr size_t maxPendingMessages = 256;
+
+private:
+    void onMessage(const ix::WebSocketMessagePtr& msg);
+    void flushPendingMessages();
+
+    juce::String wsRoute;
+    ix::WebSocket webSocket;
+
+    // Ordonne ouverture et fermeture de la connexion. Jamais tenu pendant stop() ni pendant la remise d'un
+    // message : un gestionnaire peut envoyer (et donc relancer la connexion) depuis le thread ixwebsocket
+    std::mutex connectionMutex;
+    // Fermeture en cours hors de connectionMutex : connect() est alors reporté à la fin de stop()
+    bool stopping = false;
+    bool reconnectAfterStop = false;
+
+    // Ne protège que la liste : les messages sont remis à une copie, verrou relâché
+    std::mutex listenersMutex;
+    std::condition_variable deliveryFinished;
+    std::vector<WebSocketService*> listeners;
+    // Inscrit en train de recevoir un message, et thread qui le lui remet : removeListener() attend la fin
+    // de cette remise avant que l'inscrit ne puisse être détruit
+    WebSocketService* deliveringTo = nullptr;
+    std::thread::id deliveringThread;
+
+    // Messages sérialisés en attente de l'ouverture ; aussi tenu pendant l'envoi pour garder l'ordre
+    std::mutex outboundMutex;
+    std::deque<std::string> pendingMessages;
+};
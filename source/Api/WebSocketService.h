@@ -1,20 +1,36 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
-#include <ixwebsocket/ixwebsocket/IXWebSocket.h>
+#include <atomic>
+#include <memory>
+#include "../ThirdParty/json.hpp"
+#include "SignalingConnection.h"
 
+class EventManager;
+
+// Accès d'une instance du plugin à une route de signalisation. La connexion WebSocket elle-même est partagée
+// entre les instances (voir SignalingConnection) ; ce service ne fait qu'y inscrire son instance.
 class WebSocketService
 {
 public:
-    explicit WebSocketService(const juce::String& wsRoute);
+    // Les messages reçus sont publiés sur le bus de l'instance qui a ouvert la connexion
+    WebSocketService(const juce::String& wsRoute, EventManager& instanceEventManager);
     ~WebSocketService();
 
+    WebSocketService(const WebSocketService&) = delete;
+    WebSocketService& operator=(const WebSocketService&) = delete;
+
     bool isConnected() const;
     void connectToServer();
     void disconnectToServer();
-    void sendMessage(const std::string& message, int retryCounter = 0);
+    // Message déjà sérialisé (une seule fois, par l'appelant) ; type ne sert qu'au journal. N'attend jamais.
+    void sendMessage(const std::string& type, std::string message);
+
+    // Thread de la connexion partagée : publie un message reçu sur le bus de l'instance
+    void deliver(const std::string& type, const nlohmann::json& data);
 
 private:
-    juce::String wsRoute;
-    ix::WebSocket webSocket;
+    EventManager& eventManager;
+    std::shared_ptr<SignalingConnection> connection;
+    std::atomic<bool> listening { false };
 };
@@ -1,85 +1,127 @@
 #pragma once
-
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Réglages audio d'une instance du plugin, détenus par son EngineContext.
+// Les réglages sont publiés ensemble, sous forme d'instantané versionné : un lecteur (thread audio,
+// tâche d'encodage) obtient toujours un ensemble cohérent, sans verrou, et compare la version pour
+// savoir s'il doit reconstruire sa chaîne de traitement.
 class AudioSettings
 {
 public:
-    static AudioSettings& getInstance() {
-        static AudioSettings instance;
-        return instance;
-    }
+    struct Snapshot {
+        int sampleRate = 44100;
+        int blockSize = 256;
+        int numChannels = 2;
+        int bitDepth = 16;
+        int opusSampleRate = 48000;
+        int latency = 20;
+        int opusBitRate = 64000;
+        // Incrémentée à chaque publication qui change au moins une valeur ; 0 avant la première
+        uint64_t version = 0;
+
+        [[nodiscard]] bool hasSameValues(const Snapshot& other) const noexcept {
+            return sampleRate == other.sampleRate && blockSize == other.blockSize && numChannels == other.numChannels
+                   && bitDepth == other.bitDepth && opusSampleRate == other.opusSampleRate && latency == other.latency
+                   && opusBitRate == other.opusBitRate;
+        }
+    };
 
-    [[nodiscard]] int getSampleRate() const noexcept {
-        return sampleRate;
-    }
+    AudioSettings() = default;
 
-    [[nodiscard]] int getNumChannels() const noexcept {
-        return numChannels;
-    }
+    AudioSettings(const AudioSettings&) = delete;
+    AudioSettings& operator=(const AudioSettings&) = delete;
 
-    [[nodiscard]] int getBlockSize() const noexcept {
-        return blockSize;
+    // Lecture cohérente de tous les réglages (seqlock) : ne bloque jamais, réessaie si une publication est en cours
+    [[nodiscard]] Snapshot getSnapshot() const noexcept {
+        for (;;) {
+            const uint64_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0) {
+                continue;
+            }
+            Snapshot snapshot;
+            snapshot.sampleRate = sampleRate.load(std::memory_order_relaxed);
+            snapshot.blockSize = blockSize.load(std::memory_order_relaxed);
+            snapshot.numChannels = numChannels.load(std::memory_order_relaxed);
+            snapshot.bitDepth = bitDepth.load(std::memory_order_relaxed);
+            snapshot.opusSampleRate = opusSampleRate.load(std::memory_order_relaxed);
+            snapshot.latency = latency.load(std::memory_order_relaxed);
+            snapshot.opusBitRate = opusBitRate.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                snapshot.version = before / 2;
+                return snapshot;
+            }
+        }
     }
 
-    [[nodiscard]] int getBitDepth() const noexcept {
-        return bitDepth;
+    [[nodiscard]] uint64_t getVersion() const noexcept {
+        return sequence.load(std::memory_order_acquire) / 2;
     }
 
-    [[nodiscard]] int getOpusSampleRate() const noexcept {
-        return opusSampleRate;
+    // Publie un nouvel ensemble de réglages (la version de l'instantané fourni est ignorée).
+    // Renvoie false, sans changer la version, si les valeurs sont identiques aux réglages courants.
+    bool publish(const Snapshot& newSettings) {
+        const std::lock_guard lock(writerMutex);
+        if (newSettings.hasSameValues(getSnapshot())) {
+            return false;
+        }
+
+        const uint64_t current = sequence.load(std::memory_order_relaxed);
+        sequence.store(current + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        sampleRate.store(newSettings.sampleRate, std::memory_order_relaxed);
+        blockSize.store(newSettings.blockSize, std::memory_order_relaxed);
+        numChannels.store(newSettings.numChannels, std::memory_order_relaxed);
+        bitDepth.store(newSettings.bitDepth, std::memory_order_relaxed);
+        opusSampleRate.store(newSettings.opusSampleRate, std::memory_order_relaxed);
+        latency.store(newSettings.latency, std::memory_order_relaxed);
+        opusBitRate.store(newSettings.opusBitRate, std::memory_order_relaxed);
+        sequence.store(current + 2, std::memory_order_release);
+        return true;
     }
 
-    // Mutateurs pour définir les paramètres audio
-    void setSampleRate(int newSampleRate) noexcept {
-        sampleRate = newSampleRate;
-    }
-
-    void setOpusSampleRate(int newOpusSampleRate) noexcept {
-        opusSampleRate = newOpusSampleRate;
+    // Valeurs courantes prises isolément ; utiliser getSnapshot() pour plusieurs réglages liés
+    [[nodiscard]] int getSampleRate() const noexcept {
+        return sampleRate.load(std::memory_order_relaxed);
     }
 
-    void setBlockSize(int newBlockSize) noexcept {
-        blockSize = newBlockSize;
+    [[nodiscard]] int getNumChannels() const noexcept {
+        return numChannels.load(std::memory_order_relaxed);
     }
 
-    void setNumChannels(int newNumChannels) noexcept {
-        numChannels = newNumChannels;
+    [[nodiscard]] int getBlockSize() const noexcept {
+        return blockSize.load(std::memory_order_relaxed);
     }
 
-    void setBitDepth(int newBitDepth) noexcept {
-        bitDepth = newBitDepth;
+    [[nodiscard]] int getBitDepth() const noexcept {
+        return bitDepth.load(std::memory_order_relaxed);
     }
 
-    void setLatency(int newLatency) noexcept {
-        latency = newLatency;
+    [[nodiscard]] int getOpusSampleRate() const noexcept {
+        return opusSampleRate.load(std::memory_order_relaxed);
     }
 
     [[nodiscard]] int getLatency() const noexcept {
-        return latency;
-    }
-
-    void setOpusBitRate(int newOpusBitRate) noexcept {
-        opusBitRate = newOpusBitRate;
+        return latency.load(std::memory_order_relaxed);
     }
 
     [[nodiscard]] int getOpusBitRate() const noexcept {
-        return opusBitRate;
+        return opusBitRate.load(std::memory_order_relaxed);
     }
 
 private:
-    // Constructeur et destructeur privés pour le Singleton
-    AudioSettings() = default;
-    ~AudioSettings() = default;
-
-    // Suppression des méthodes de copie et d'affectation pour garantir l'unicité
-    AudioSettings(const AudioSettings&) = delete;
-    AudioSettings& operator=(const AudioSettings&) = delete;
+    // Impair pendant une publication ; la version vaut sequence / 2
+    std::atomic<uint64_t> sequence { 0 };
+    std::mutex writerMutex;
 
     // Données membres pour stocker les paramètres audio
-    int sampleRate = 44100;
-    int blockSize = 256;
-    int numChannels = 2;
-    int bitDepth = 16;
-    int opusSampleRate = 48000;
-    int latency = 20;
-    int opusBitRate = 64000;
+    std::atomic<int> sampleRate { Snapshot().sampleRate };
+    std::atomic<int> blockSize { Snapshot().blockSize };
+    std::atomic<int> numChannels { Snapshot().numChannels };
+    std::atomic<int> bitDepth { Snapshot().bitDepth };
+    std::atomic<int> opusSampleRate { Snapshot().opusSampleRate };
+    std::atomic<int> latency { Snapshot().latency };
+    std::atomic<int> opusBitRate { Snapshot().opusBitRate };
 };
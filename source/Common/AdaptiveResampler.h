@@ -0,0 +1,97 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "StreamingResampler.h"
+
+// Rééchantillonneur mono en continu à rapport finement ajustable, pour compenser la dérive d'horloge.
+// Deux étages : une interpolation Hermite cubique au rapport variable (quelques centaines de ppm autour de 1),
+// suivie de la conversion fixe et de haute qualité de StreamingResampler (r8brain) vers la fréquence de l'hôte,
+// r8brain ne sachant pas faire varier son rapport en cours de route.
+// Toute la mémoire est allouée dans prepare() : process() peut être appelé depuis le thread audio.
+class AdaptiveResampler
+{
+public:
+    // Écart maximal du rapport fin, au-delà duquel les tampons préalloués ne suffiraient plus
+    static constexpr double maxRatioDeviation = 0.01;
+
+    // maxInputSamples : taille maximale d'un bloc passé à process()
+    void prepare(const double sourceRate, const double targetRate, const int maxInputSamples)
+    {
+        maxInput = maxInputSamples;
+
+        fineInput.assign(static_cast<size_t>(maxInputSamples + historySize), 0.0f);
+        maxFineOutput = static_cast<int>(std::ceil(maxInputSamples / (1.0 - maxRatioDeviation))) + historySize + 1;
+        fineOutput.assign(static_cast<size_t>(maxFineOutput), 0.0f);
+        resampler.prepare(sourceRate, targetRate, 1, maxFineOutput);
+        reset();
+    }
+
+    // Vide l'état des filtres (nouveau flux)
+    void reset() noexcept
+    {
+        std::fill(fineInput.begin(), fineInput.end(), 0.0f);
+        position = 1.0;
+        resampler.reset();
+    }
+
+    // Rapport de vitesse : nombre d'échantillons d'entrée consommés par échantillon produit au premier étage
+    void setRatio(const double newRatio) noexcept
+    {
+        ratio = std::clamp(newRatio, 1.0 - maxRatioDeviation, 1.0 + maxRatioDeviation);
+    }
+
+    [[nodiscard]] double getRatio() const noexcept { return ratio; }
+
+    // Nombre maximal d'échantillons que process() peut écrire pour un bloc de maxInputSamples
+    [[nodiscard]] int getMaxOutputSamples() const noexcept
+    {
+        return resampler.getMaxOutputFrames();
+    }
+
+    // Renvoie le nombre d'échantillons écrits dans output (au plus getMaxOutputSamples())
+    int process(const float* input, const int numInput, float* output) noexcept
+    {
+        const int numSamples = std::min(numInput, maxInput);
+        std::copy(input, input + numSamples, fineInput.begin() + historySize);
+
+        // Interpolation entre fineInput[i] et fineInput[i + 1] ; les historySize premiers échantillons
+        // sont la fin du bloc précédent
+        const int available = numSamples + historySize;
+        int numFine = 0;
+        for (int i = static_cast<int>(position); i + 2 < available && numFine < maxFineOutput; i = static_cast<int>(position))
+        {
+            const auto t = static_cast<float>(position - i);
+            fineOutput[static_cast<size_t>(numFine++)] = hermite(fineInput[static_cast<size_t>(i - 1)], fineInput[static_cast<size_t>(i)],
+                fineInput[static_cast<size_t>(i + 1)], fineInput[static_cast<size_t>(i + 2)], t);
+            position += ratio;
+        }
+        position = std::max(position - numSamples, 1.0);
+        std::copy(fineInput.begin() + numSamples, fineInput.begin() + available, fineInput.begin());
+
+        float* const outputChannels[] = { output };
+        return resampler.process(fineOutput.data(), numFine, outputChannels);
+    }
+
+private:
+    static constexpr int historySize = 3;
+
+    // Hermite cubique (Catmull-Rom) entre y1 et y2, t dans [0, 1[
+    static float hermite(const float y0, const float y1, const float y2, const float y3, const float t) noexcept
+    {
+        const float c1 = 0.5f * (y2 - y0);
+        const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+        const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+        return ((c3 * t + c2) * t + c1) * t + y1;
+    }
+
+    int maxInput = 0;
+    int maxFineOutput = 0;
+
+    std::vector<float> fineInput;
+    std::vector<float> fineOutput;
+    StreamingResampler resampler;
+
+    double ratio = 1.0;
+    double position = 1.0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Estime l'écart d'horloge entre l'interface audio de l'émetteur et celle du récepteur.
+// Le remplissage du tampon côté réception (timestamps RTP reçus mais pas encore joués) dérive lentement
+// quand les deux horloges diffèrent : un régulateur PI sur ce remplissage, lissé pour ignorer la gigue
+// et le découpage en trames, donne le rapport de vitesse de lecture qui le ramène vers la cible.
+// Appelé uniquement depuis le thread audio.
+class ClockDriftEstimator
+{
+public:
+    // Correction maximale : 1000 ppm, soit 1,7 cent, inaudible
+    static constexpr double maxCorrectionPpm = 1000.0;
+
+    explicit ClockDriftEstimator(const double nominalSampleRate = 48000.0) : sampleRate(nominalSampleRate) {}
+
+    void reset() noexcept
+    {
+        smoothedError = 0.0;
+        integral = 0.0;
+        correctionPpm = 0.0;
+        hasError = false;
+    }
+
+    // bufferedSamples : remplissage courant, targetSamples : remplissage visé,
+    // elapsedSamples : échantillons joués depuis l'appel précédent (tous à sampleRate).
+    // Renvoie le rapport de vitesse à appliquer à la lecture (> 1 : consommer plus vite).
+    double update(const double bufferedSamples, const double targetSamples, const double elapsedSamples) noexcept
+    {
+        const double elapsedSeconds = elapsedSamples / sampleRate;
+        const double error = bufferedSamples - targetSamples;
+
+        // Lissage exponentiel (constante de temps smoothingSeconds)
+        if (! hasError)
+        {
+            smoothedError = error;
+            hasError = true;
+        }
+        else
+        {
+            const double alpha = 1.0 - std::exp(-elapsedSeconds / smoothingSeconds);
+            smoothedError += alpha * (error - smoothedError);
+        }
+
+        // Le terme intégral converge vers la dérive constante entre les deux horloges,
+        // le terme proportionnel ramène le remplissage vers la cible
+        const double maxIntegral = maxCorrectionPpm / integralGain;
+        integral = std::clamp(integral + smoothedError * elapsedSeconds, -maxIntegral, maxIntegral);
+        correctionPpm = std::clamp(proportionalGain * smoothedError + integralGain * integral, -maxCorrectionPpm, maxCorrectionPpm);
+        return getRatio();
+    }
+
+    [[nodiscard]] double getRatio() const noexcept { return 1.0 + correctionPpm * 1.0e-6; }
+
+    [[nodiscard]] double getCorrectionPpm() const noexcept { return correctionPpm; }
+
+private:
+    static constexpr double smoothingSeconds = 2.0;
+    // ppm par échantillon d'écart : 10 ms d'avance (480 échantillons à 48 kHz) donnent 480 ppm
+    static constexpr double proportionalGain = 1.0;
+    // ppm par échantillon·seconde : le terme intégral rattrape la dérive en une minute environ, sans dépassement notable
+    static constexpr double integralGain = proportionalGain / 60.0;
+
+    const double sampleRate;
+    double smoothedError = 0.0;
+    double integral = 0.0;
+    double correctionPpm = 0.0;
+    bool hasError = false;
+};
@@ -1,11 +1,18 @@
 #pragma once
 #include <exception>
+#include <mutex>
 #include "../Api/ApiService.h"
-#include "../Api/AuthService.h"
 #include <juce_core/juce_core.h>
 
 class CrashHandler {
 public:
+    // Le gestionnaire de terminaison est commun au processus : il retient le dernier utilisateur
+    // identifié par l'une des instances du plugin
+    static void setUserId(const std::string& newUserId) {
+        const std::lock_guard lock(userIdMutex);
+        userId = newUserId;
+    }
+
     static void reportCrash(const std::string& message) {
         nlohmann::json jsonBody = {
             {"message", message},
@@ -13,8 +20,11 @@ public:
             {"stackTrace", message},
             {"screenName", "MainApp"},
         };
-        if (AuthService::getInstance().getUserContext().has_value() ) {
-            jsonBody["userId"] = AuthService::getInstance().getUserContext().value().user._id;
+        {
+            const std::lock_guard lock(userIdMutex);
+            if (!userId.empty()) {
+                jsonBody["userId"] = userId;
+            }
         }
         auto res = ApiService::makePOSTRequest(ApiRoute::CreateCrashReport, jsonBody);
     }
@@ -32,4 +42,8 @@ public:
         // Appeler le gestionnaire par défaut après votre rapport
         std::abort();
     }
+
+private:
+    static inline std::mutex userIdMutex;
+    static inline std::string userId;
 };
\ No newline at end of file
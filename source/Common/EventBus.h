@@ -0,0 +1,392 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <juce_events/juce_events.h>
+
+// Mode de livraison choisi à l'abonnement
+enum class EventDelivery
+{
+    // Le callback est appelé sur le thread qui publie, pendant publish()
+    Synchronous,
+    // Le dernier événement est conservé et livré plus tard sur le message thread ; les événements
+    // publiés entre deux livraisons sont fusionnés (seul le plus récent est livré). publish() prend alors
+    // un SpinLock et poste un message JUCE : jamais depuis le thread audio.
+    MessageThread
+};
+
+namespace EventBusDetail
+{
+    // État partagé entre un canal et l'abonnement qui l'a créé
+    struct SubscriberState
+    {
+        virtual ~SubscriberState() = default;
+
+        // Annule la livraison MessageThread en attente, une fois plus aucune livraison en cours
+        virtual void cancelPendingDelivery() {}
+
+        std::atomic<bool> active { true };
+        // Nombre de callbacks (et de mises en file MessageThread) en cours d'exécution, tous threads confondus
+        std::atomic<int> callbacksInFlight { 0 };
+    };
+
+    // Marque un callback en cours sur le thread courant. Le compteur est incrémenté avant de relire
+    // active (ordre seq_cst des deux côtés) : soit le désabonnement voit le callback en cours et l'attend,
+    // soit le callback voit l'abonné inactif et ne s'exécute pas.
+    class CallbackScope
+    {
+    public:
+        explicit CallbackScope(SubscriberState& subscriber) noexcept : state(subscriber)
+        {
+            state.callbacksInFlight.fetch_add(1);
+            assert(depth < maxDepth);
+            if (depth < maxDepth)
+                stack[depth] = &state;
+            ++depth;
+        }
+
+        ~CallbackScope()
+        {
+            --depth;
+            state.callbacksInFlight.fetch_sub(1);
+        }
+
+        CallbackScope(const CallbackScope&) = delete;
+        CallbackScope& operator=(const CallbackScope&) = delete;
+
+        [[nodiscard]] bool shouldDeliver() const noexcept { return state.active.load(); }
+
+        // Callbacks de cet abonné en cours sur le thread courant : un abonné qui se désabonne
+        // depuis son propre callback ne doit pas s'attendre lui-même
+        [[nodiscard]] static int countOnThisThread(const SubscriberState* subscriber) noexcept
+        {
+            int count = 0;
+            for (int i = 0; i < std::min(depth, maxDepth); ++i)
+                count += stack[i] == subscriber ? 1 : 0;
+            return count;
+        }
+
+    private:
+        static constexpr int maxDepth = 16;
+        static inline thread_local const SubscriberState* stack[maxDepth] {};
+        static inline thread_local int depth = 0;
+
+        SubscriberState& state;
+    };
+
+    struct ChannelBase
+    {
+        virtual ~ChannelBase() = default;
+        virtual void unsubscribe(const SubscriberState* subscriber) = 0;
+    };
+
+    template <typename Event>
+    class Subscriber final : public SubscriberState, public std::enable_shared_from_this<Subscriber<Event>>
+    {
+    public:
+        Subscriber(std::function<void(const Event&)> eventCallback, const EventDelivery eventDelivery)
+            : callback(std::move(eventCallback)), delivery(eventDelivery) {}
+
+        // Appelé sur le thread qui publie. La mise en file MessageThread compte aussi comme un callback en
+        // cours : le désabonnement l'attend avant d'annuler la livraison, aucune ne reste donc en attente.
+        void deliver(const Event& event)
+        {
+            const CallbackScope scope(*this);
+            if (!scope.shouldDeliver())
+                return;
+
+            if (delivery == EventDelivery::Synchronous)
+            {
+                callback(event);
+                return;
+            }
+            {
+                const juce::SpinLock::ScopedLockType lock(pendingLock);
+                pendingEvent = event;
+            }
+            pendingUpdate->triggerAsyncUpdate();
+        }
+
+        void cancelPendingDelivery() override
+        {
+            if (pendingUpdate != nullptr)
+                pendingUpdate->cancelPendingUpdate();
+        }
+
+        // Crée le déclencheur asynchrone à l'abonnement, pour que deliver() n'alloue jamais
+        void prepareQueuedDelivery()
+        {
+            if (delivery == EventDelivery::MessageThread)
+                pendingUpdate = std::make_unique<PendingUpdate>(this->weak_from_this());
+        }
+
+    private:
+        // Fusionne les publications sur le message thread ; ne garde qu'une référence faible vers l'abonné
+        class PendingUpdate final : public juce::AsyncUpdater
+        {
+        public:
+            explicit PendingUpdate(std::weak_ptr<Subscriber> subscriber) : owner(std::move(subscriber)) {}
+
+            void handleAsyncUpdate() override
+            {
+                // La référence forte garde l'abonné (et son callback) vivant le temps de la livraison,
+                // même s'il se désabonne depuis son propre callback
+                if (const auto subscriber = owner.lock())
+                    subscriber->deliverPending();
+            }
+
+        private:
+            std::weak_ptr<Subscriber> owner;
+        };
+
+        void deliverPending()
+        {
+            const CallbackScope scope(*this);
+            if (!scope.shouldDeliver())
+                return;
+
+            std::optional<Event> event;
+            {
+                const juce::SpinLock::ScopedLockType lock(pendingLock);
+                event.swap(pendingEvent);
+            }
+            if (event.has_value())
+                callback(*event);
+        }
+
+        std::function<void(const Event&)> callback;
+        const EventDelivery delivery;
+
+        juce::SpinLock pendingLock;
+        std::optional<Event> pendingEvent;
+        std::unique_ptr<PendingUpdate> pendingUpdate;
+    };
+
+    // Liste des abonnés d'un type d'événement, protégée par RCU : publish() ne prend aucun verrou et
+    // n'alloue rien, il parcourt un instantané immuable. Abonnement et désabonnement (sous mutex) publient
+    // une nouvelle liste et retirent l'ancienne.
+    //
+    // Récupération par époques : chaque lecteur s'inscrit dans le compteur de l'époque courante (deux
+    // compteurs, selon sa parité). Une liste retirée pendant l'époque E n'est plus visible des lecteurs
+    // inscrits ensuite ; elle est libérée quand l'époque avance au-delà de E et que les lecteurs de E sont
+    // sortis. Sous publication continue, les lecteurs d'une époque révolue finissent toujours par sortir :
+    // au plus deux époques de listes retirées restent en mémoire.
+    template <typename Event>
+    class Channel final : public ChannelBase
+    {
+    public:
+        using SubscriberList = std::vector<std::shared_ptr<Subscriber<Event>>>;
+
+        Channel() : current(new SubscriberList()) {}
+
+        ~Channel() override
+        {
+            delete current.load();
+        }
+
+        void publish(const Event& event)
+        {
+            // Chemin rapide : personne n'écoute, aucune écriture partagée
+            if (numSubscribers.load(std::memory_order_relaxed) == 0)
+                return;
+
+            const auto slot = enterReadSection();
+            const auto* subscribers = current.load();
+            for (const auto& subscriber : *subscribers)
+                subscriber->deliver(event);
+            readers[slot].fetch_sub(1);
+        }
+
+        std::shared_ptr<Subscriber<Event>> subscribe(std::function<void(const Event&)> callback, const EventDelivery delivery)
+        {
+            auto subscriber = std::make_shared<Subscriber<Event>>(std::move(callback), delivery);
+            subscriber->prepareQueuedDelivery();
+
+            const std::lock_guard lock(writerMutex);
+            auto next = std::make_unique<SubscriberList>(*current.load());
+            next->push_back(subscriber);
+            replaceList(std::move(next));
+            return subscriber;
+        }
+
+        void unsubscribe(const SubscriberState* subscriber) override
+        {
+            {
+                const std::lock_guard lock(writerMutex);
+                auto next = std::make_unique<SubscriberList>();
+                for (const auto& existing : *current.load())
+                    if (existing.get() != subscriber)
+                        next->push_back(existing);
+                replaceList(std::move(next));
+            }
+
+            // Après retour, plus aucun callback ne s'exécute (sauf celui d'où l'on se désabonne)
+            while (subscriber->callbacksInFlight.load() > CallbackScope::countOnThisThread(subscriber))
+                std::this_thread::yield();
+        }
+
+        [[nodiscard]] size_t getNumSubscribers() const noexcept { return numSubscribers.load(std::memory_order_relaxed); }
+
+        // Listes retirées pas encore libérées
+        [[nodiscard]] size_t getNumRetiredLists()
+        {
+            const std::lock_guard lock(writerMutex);
+            return retired[0].size() + retired[1].size();
+        }
+
+    private:
+        // Inscrit le lecteur dans l'époque courante. Si l'époque a avancé entre la lecture et l'inscription,
+        // l'écrivain a pu ne pas voir ce lecteur : il se réinscrit dans la nouvelle.
+        size_t enterReadSection() noexcept
+        {
+            for (;;)
+            {
+                const auto observed = epoch.load();
+                const auto slot = static_cast<size_t>(observed & 1);
+                readers[slot].fetch_add(1);
+                if (epoch.load() == observed)
+                    return slot;
+                readers[slot].fetch_sub(1);
+            }
+        }
+
+        // writerMutex doit être tenu
+        void replaceList(std::unique_ptr<SubscriberList> next)
+        {
+            numSubscribers.store(next->size(), std::memory_order_relaxed);
+            retired[epoch.load() & 1].emplace_back(current.exchange(next.release()));
+
+            // Deux avancées libèrent aussi la liste qui vient d'être retirée si aucun lecteur n'est en cours
+            for (int i = 0; i < 2 && tryAdvanceEpoch(); ++i) {}
+        }
+
+        // writerMutex doit être tenu. Les listes retirées pendant l'époque précédente sont libérées dès que
+        // ses lecteurs sont sortis, puis l'époque avance.
+        bool tryAdvanceEpoch()
+        {
+            const auto observed = epoch.load();
+            const auto previous = static_cast<size_t>((observed + 1) & 1);
+            if (readers[previous].load() != 0)
+                return false;
+            retired[previous].clear();
+            epoch.store(observed + 1);
+            return true;
+        }
+
+        std::atomic<SubscriberList*> current;
+        std::atomic<uint64_t> epoch { 0 };
+        std::atomic<int> readers[2] {};
+        std::atomic<size_t> numSubscribers { 0 };
+
+        std::mutex writerMutex;
+        std::vector<std::unique_ptr<SubscriberList>> retired[2];
+    };
+}
+
+// Abonnement RAII : le callback n'est plus appelé une fois l'abonnement détruit ou réinitialisé.
+// À déclarer après les membres utilisés par le callback, pour être détruit avant eux.
+class EventSubscription
+{
+public:
+    EventSubscription() = default;
+
+    EventSubscription(std::shared_ptr<EventBusDetail::ChannelBase> eventChannel,
+                      std::shared_ptr<EventBusDetail::SubscriberState> eventSubscriber)
+        : channel(std::move(eventChannel)), subscriber(std::move(eventSubscriber)) {}
+
+    ~EventSubscription() { reset(); }
+
+    EventSubscription(EventSubscription&& other) noexcept
+        : channel(std::move(other.channel)), subscriber(std::move(other.subscriber)) {}
+
+    EventSubscription& operator=(EventSubscription&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            channel = std::move(other.channel);
+            subscriber = std::move(other.subscriber);
+        }
+        return *this;
+    }
+
+    EventSubscription(const EventSubscription&) = delete;
+    EventSubscription& operator=(const EventSubscription&) = delete;
+
+    void reset()
+    {
+        if (channel != nullptr && subscriber != nullptr)
+        {
+            subscriber->active.store(false);
+            channel->unsubscribe(subscriber.get());
+            subscriber->cancelPendingDelivery();
+        }
+        channel.reset();
+        subscriber.reset();
+    }
+
+    [[nodiscard]] bool isActive() const noexcept { return subscriber != nullptr; }
+
+private:
+    std::shared_ptr<EventBusDetail::ChannelBase> channel;
+    std::shared_ptr<EventBusDetail::SubscriberState> subscriber;
+};
+
+// Bus d'événements typé : un canal par type d'événement, résolu à la compilation.
+// publish() ne touche que les abonnés du type publié. Pour les abonnés Synchronous, il est sans verrou
+// ni allocation ; un abonné MessageThread copie l'événement sous SpinLock et poste un message JUCE, ce qui
+// n'a pas sa place sur le thread audio.
+template <typename... Events>
+class EventBus
+{
+public:
+    EventBus() : channels(std::make_shared<EventBusDetail::Channel<Events>>()...) {}
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    template <typename Event>
+    [[nodiscard]] EventSubscription subscribe(std::function<void(const Event&)> callback,
+                                              const EventDelivery delivery = EventDelivery::Synchronous)
+    {
+        auto& channel = getChannel<Event>();
+        auto subscriber = channel->subscribe(std::move(callback), delivery);
+        return { channel, std::move(subscriber) };
+    }
+
+    template <typename Event>
+    void publish(const Event& event)
+    {
+        getChannel<Event>()->publish(event);
+    }
+
+    template <typename Event>
+    [[nodiscard]] size_t getNumSubscribers() const noexcept
+    {
+        return std::get<std::shared_ptr<EventBusDetail::Channel<Event>>>(channels)->getNumSubscribers();
+    }
+
+    template <typename Event>
+    [[nodiscard]] size_t getNumRetiredLists()
+    {
+        return getChannel<Event>()->getNumRetiredLists();
+    }
+
+private:
+    template <typename Event>
+    std::shared_ptr<EventBusDetail::Channel<Event>>& getChannel() noexcept
+    {
+        return std::get<std::shared_ptr<EventBusDetail::Channel<Event>>>(channels);
+    }
+
+    std::tuple<std::shared_ptr<EventBusDetail::Channel<Events>>...> channels;
+};
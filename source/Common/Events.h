@@ -1,17 +1,13 @@
 #pragma once
 
 #include "../Models/Session.h"
+#include "../Models/UserContext.h"
+#include <optional>
+#include <string>
+#include <vector>
 #include <rtc/rtc.hpp>
 #include "../ThirdParty/json.hpp"
 
-struct AudioBlockProcessedEvent {
-    const std::vector<float> data;
-    int numChannels;
-    int numSamples;
-    double sampleRate;
-    uint32_t timestamp;
-};
-
 struct AudioBlockSentEvent {
     const std::vector<float> data;
 };
@@ -31,8 +27,20 @@ struct LoginEvent {
 };
 
 struct LogoutEvent {};
+
+// Contexte de l'utilisateur connecté, rechargé en arrière-plan ; vide après une déconnexion ou un échec
+struct UserContextChangedEvent {
+    std::optional<UserContext> userContext;
+};
+
+// Session en cours de l'utilisateur ; vide s'il n'en a pas (ou plus). La première s'il en a plusieurs
 struct OngoingSessionChangedEvent {
-    PopulatedSession ongoingSession;
+    std::optional<PopulatedSession> ongoingSession;
+};
+
+// Toutes les sessions en cours de l'utilisateur : un ingénieur peut en mener plusieurs à la fois
+struct OngoingSessionsChangedEvent {
+    std::vector<PopulatedSession> ongoingSessions;
 };
 
 struct MessageWsReceivedEvent {
@@ -44,4 +52,6 @@ struct RTCStateChangeEvent {
     rtc::PeerConnection::State state;
     rtc::PeerConnection::IceState iceState;
     rtc::PeerConnection::SignalingState signalingState;
+    // Session de la connexion qui a changé d'état (une connexion par session côté émetteur)
+    std::string sessionId;
 };
\ No newline at end of file
@@ -0,0 +1,268 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Tampon de gigue indexé sur le numéro de séquence RTP.
+// Un seul producteur (thread réseau, insert()) et un seul consommateur (thread audio, consume()) :
+// chaque case possède son propre état atomique, aucune des deux opérations ne prend de verrou ni n'alloue.
+// La gigue d'arrivée est estimée comme dans la RFC 3550 (§6.4.1) et pilote le délai de lecture cible.
+class JitterBuffer
+{
+public:
+    static constexpr int numSlots = 64; // 640 ms de paquets de 10 ms
+    static constexpr size_t maxPayloadSize = 1500;
+
+    enum class PopResult
+    {
+        Packet, // le paquet attendu a été consommé
+        Missing, // paquet absent mais des paquets plus récents sont arrivés : perdu ou trop en retard
+        Empty // rien n'est arrivé à partir de cette séquence
+    };
+
+    struct Packet
+    {
+        int64_t sequence = 0;
+        uint32_t timestamp = 0;
+        int numSamples = 0;
+        size_t size = 0;
+        std::array<unsigned char, maxPayloadSize> payload {};
+    };
+
+    // rtpClockRate : fréquence de l'horloge RTP (48 kHz pour Opus)
+    explicit JitterBuffer(const int rtpClockRate = 48000) : clockRate(rtpClockRate) {}
+
+    // Thread réseau. arrivalTime est exprimé dans l'horloge RTP (échantillons à clockRate).
+    // Renvoie false si le paquet est rejeté (trop tardif, trop en avance, doublon ou trop grand).
+    bool insert(const int64_t sequence, const uint32_t timestamp, const unsigned char* payload, const size_t size,
+        const int numSamples, const int64_t arrivalTime) noexcept
+    {
+        if (size > maxPayloadSize || numSamples <= 0)
+            return false;
+
+        int64_t next = nextSequence.load(std::memory_order_acquire);
+        if (next < 0 && nextSequence.compare_exchange_strong(next, sequence, std::memory_order_acq_rel))
+            next = sequence;
+
+        if (sequence < next)
+        {
+            latePackets.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (sequence >= next + numSlots)
+        {
+            // Le flux reprend après une coupure plus longue que le tampon : la lecture se recale sur ce
+            // paquet au prochain consume() au lieu de rejeter indéfiniment tous les paquets suivants
+            resyncSequence.store(sequence, std::memory_order_release);
+            overflowPackets.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto& slot = slots[static_cast<size_t>(sequence % numSlots)];
+        int expected = slotEmpty;
+        if (! slot.state.compare_exchange_strong(expected, slotWriting, std::memory_order_acquire))
+        {
+            // Une case pleine d'un paquet déjà dépassé par la lecture peut être récupérée.
+            // Seul ce thread écrit packet.sequence, la lecture ci-dessous est donc stable.
+            const bool isStale = expected == slotFull && slot.packet.sequence < nextSequence.load(std::memory_order_acquire);
+            if (! isStale || ! slot.state.compare_exchange_strong(expected, slotWriting, std::memory_order_acquire))
+            {
+                duplicatePackets.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        slot.packet.sequence = sequence;
+        slot.packet.timestamp = timestamp;
+        slot.packet.numSamples = numSamples;
+        slot.packet.size = size;
+        std::memcpy(slot.packet.payload.data(), payload, size);
+        slot.state.store(slotFull, std::memory_order_release);
+
+        if (sequence > highestSequence.load(std::memory_order_relaxed))
+            highestSequence.store(sequence, std::memory_order_release);
+        lastNumSamples.store(numSamples, std::memory_order_relaxed);
+        updateJitter(timestamp, arrivalTime);
+        return true;
+    }
+
+    // Thread audio. Si le paquet de la séquence attendue est présent, onPacket(const Packet&) est appelé
+    // avant que la case ne soit libérée. La séquence attendue avance dans tous les cas sauf Empty.
+    template <typename PacketCallback>
+    PopResult consume(PacketCallback&& onPacket) noexcept
+    {
+        applyResync();
+        const int64_t sequence = nextSequence.load(std::memory_order_acquire);
+        if (sequence < 0)
+            return PopResult::Empty;
+
+        auto& slot = slots[static_cast<size_t>(sequence % numSlots)];
+        int expected = slotFull;
+        if (slot.state.compare_exchange_strong(expected, slotReading, std::memory_order_acquire))
+        {
+            // La case ne peut plus être récupérée par insert() tant qu'elle est en lecture
+            const bool isExpected = slot.packet.sequence == sequence;
+            if (isExpected)
+                onPacket(slot.packet);
+            slot.state.store(slotEmpty, std::memory_order_release);
+            if (isExpected)
+            {
+                nextSequence.store(sequence + 1, std::memory_order_release);
+                return PopResult::Packet;
+            }
+        }
+
+        if (highestSequence.load(std::memory_order_acquire) > sequence)
+        {
+            nextSequence.store(sequence + 1, std::memory_order_release);
+            return PopResult::Missing;
+        }
+        return PopResult::Empty;
+    }
+
+    // Thread audio : lit le paquet de la séquence attendue sans le consommer (ex. pour sa FEC).
+    // Renvoie false s'il n'est pas encore arrivé.
+    template <typename PacketCallback>
+    bool peek(PacketCallback&& onPacket) noexcept
+    {
+        const int64_t sequence = nextSequence.load(std::memory_order_acquire);
+        if (sequence < 0)
+            return false;
+
+        auto& slot = slots[static_cast<size_t>(sequence % numSlots)];
+        int expected = slotFull;
+        if (! slot.state.compare_exchange_strong(expected, slotReading, std::memory_order_acquire))
+            return false;
+
+        const bool isExpected = slot.packet.sequence == sequence;
+        if (isExpected)
+            onPacket(slot.packet);
+        slot.state.store(slotFull, std::memory_order_release);
+        return isExpected;
+    }
+
+    // Thread audio : abandonne le paquet le plus ancien pour réduire la latence
+    void skip() noexcept
+    {
+        consume([](const Packet&) {});
+    }
+
+    // Thread audio : abandonne d'un coup tout ce qui précède sequence (reprise après une coupure).
+    // Les cases dépassées sont libérées par consume() ou récupérées par insert().
+    void skipTo(const int64_t sequence) noexcept
+    {
+        applyResync();
+        const int64_t next = nextSequence.load(std::memory_order_acquire);
+        if (next >= 0 && sequence > next)
+            nextSequence.store(sequence, std::memory_order_release);
+    }
+
+    // Thread audio : applique le recalage demandé par insert() après une longue coupure (aussi fait par consume()),
+    // pour que la lecture à l'arrêt voie les paquets de la reprise
+    void applyResync() noexcept
+    {
+        if (resyncSequence.load(std::memory_order_relaxed) < 0)
+            return;
+        const int64_t resync = resyncSequence.exchange(-1, std::memory_order_acquire);
+        if (resync > nextSequence.load(std::memory_order_relaxed))
+            nextSequence.store(resync, std::memory_order_release);
+    }
+
+    // Séquence attendue par la lecture et plus haute séquence reçue ; -1 avant le premier paquet
+    [[nodiscard]] int64_t getNextSequence() const noexcept { return nextSequence.load(std::memory_order_acquire); }
+    [[nodiscard]] int64_t getHighestSequence() const noexcept { return highestSequence.load(std::memory_order_acquire); }
+
+    // Thread audio : durée mise en tampon, en échantillons à clockRate, à partir de la séquence attendue
+    [[nodiscard]] int64_t getBufferedSamples() const noexcept
+    {
+        const int64_t next = nextSequence.load(std::memory_order_acquire);
+        if (next < 0)
+            return 0;
+        const int64_t packets = highestSequence.load(std::memory_order_acquire) - next + 1;
+        return std::max<int64_t>(0, packets) * lastNumSamples.load(std::memory_order_relaxed);
+    }
+
+    // Délai de lecture visé : une trame plus quatre fois la gigue estimée, borné à [minimumDelay, maximumDelay]
+    [[nodiscard]] int64_t getTargetDelaySamples() const noexcept
+    {
+        const auto frame = static_cast<double>(lastNumSamples.load(std::memory_order_relaxed));
+        const double target = frame + 4.0 * jitter.load(std::memory_order_relaxed);
+        const double minimumDelay = frame;
+        const double maximumDelay = frame * (numSlots / 2);
+        return static_cast<int64_t>(std::clamp(target, minimumDelay, maximumDelay));
+    }
+
+    [[nodiscard]] int getFrameSamples() const noexcept { return lastNumSamples.load(std::memory_order_relaxed); }
+
+    // Gigue d'arrivée estimée, en échantillons à clockRate
+    [[nodiscard]] double getJitterSamples() const noexcept { return jitter.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] double getJitterMs() const noexcept { return getJitterSamples() * 1000.0 / clockRate; }
+
+    [[nodiscard]] uint64_t getNumLatePackets() const noexcept { return latePackets.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t getNumOverflowPackets() const noexcept { return overflowPackets.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t getNumDuplicatePackets() const noexcept { return duplicatePackets.load(std::memory_order_relaxed); }
+
+    // Réinitialise le tampon (nouveau flux). Ne doit pas être appelé pendant insert() ou consume().
+    void reset() noexcept
+    {
+        for (auto& slot : slots)
+            slot.state.store(slotEmpty, std::memory_order_relaxed);
+        nextSequence.store(-1, std::memory_order_relaxed);
+        highestSequence.store(-1, std::memory_order_relaxed);
+        resyncSequence.store(-1, std::memory_order_relaxed);
+        jitter.store(0.0, std::memory_order_relaxed);
+        hasTransit = false;
+        latePackets.store(0, std::memory_order_relaxed);
+        overflowPackets.store(0, std::memory_order_relaxed);
+        duplicatePackets.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int slotEmpty = 0;
+    static constexpr int slotWriting = 1;
+    static constexpr int slotFull = 2;
+    static constexpr int slotReading = 3;
+
+    struct Slot
+    {
+        std::atomic<int> state { slotEmpty };
+        Packet packet;
+    };
+
+    // RFC 3550 : J += (|D| - J) / 16, avec D la variation du temps de transit entre deux paquets
+    void updateJitter(const uint32_t timestamp, const int64_t arrivalTime) noexcept
+    {
+        const int64_t transit = arrivalTime - static_cast<int64_t>(timestamp);
+        if (hasTransit)
+        {
+            // Différence sur 32 bits pour rester correcte au repli du timestamp RTP
+            const auto delta = static_cast<double>(static_cast<int32_t>(static_cast<uint32_t>(transit - lastTransit)));
+            const double current = jitter.load(std::memory_order_relaxed);
+            jitter.store(current + (std::abs(delta) - current) / 16.0, std::memory_order_relaxed);
+        }
+        lastTransit = transit;
+        hasTransit = true;
+    }
+
+    const int clockRate;
+    std::array<Slot, numSlots> slots;
+
+    alignas(64) std::atomic<int64_t> nextSequence { -1 };
+    alignas(64) std::atomic<int64_t> highestSequence { -1 };
+    // Écrit par insert() quand un paquet arrive trop loin devant la lecture, consommé par le thread audio
+    std::atomic<int64_t> resyncSequence { -1 };
+    std::atomic<int> lastNumSamples { 480 };
+    std::atomic<double> jitter { 0.0 };
+
+    // État propre au thread réseau
+    int64_t lastTransit = 0;
+    bool hasTransit = false;
+
+    std::atomic<uint64_t> latePackets { 0 };
+    std::atomic<uint64_t> overflowPackets { 0 };
+    std::atomic<uint64_t> duplicatePackets { 0 };
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// Garde des rappels reçus sur des threads tiers (libdatachannel) qui capturent this. Un rappel ouvre une
+// Scope sur l'état capturé et ne touche à l'objet que si elle est valide. invalidate(), en tête du
+// destructeur, attend la fin des rappels en cours sur les autres threads ; ensuite plus aucun n'entre.
+// Les rappels capturent getState(), jamais le jeton lui-même, qui disparaît avec l'objet.
+class LivenessToken
+{
+public:
+    struct State
+    {
+        std::atomic<bool> alive { true };
+        std::atomic<int> callbacksInFlight { 0 };
+    };
+
+    // Le compteur est incrémenté avant de relire alive (ordre seq_cst des deux côtés) : soit invalidate()
+    // voit le rappel en cours et l'attend, soit le rappel voit l'objet détruit et ne fait rien.
+    class Scope
+    {
+    public:
+        explicit Scope(State& tokenState) noexcept : state(tokenState)
+        {
+            state.callbacksInFlight.fetch_add(1);
+            if (depth < maxDepth)
+                stack[depth] = &state;
+            ++depth;
+        }
+
+        ~Scope()
+        {
+            --depth;
+            state.callbacksInFlight.fetch_sub(1);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        explicit operator bool() const noexcept { return state.alive.load(); }
+
+        // Rappels de cet état en cours sur le thread courant : un objet détruit depuis l'un de ses propres
+        // rappels (dernière référence relâchée sur ce thread) ne doit pas s'attendre lui-même
+        [[nodiscard]] static int countOnThisThread(const State* tokenState) noexcept
+        {
+            int count = 0;
+            for (int i = 0; i < std::min(depth, maxDepth); ++i)
+                count += stack[i] == tokenState ? 1 : 0;
+            return count;
+        }
+
+    private:
+        static constexpr int maxDepth = 16;
+        static inline thread_local const State* stack[maxDepth] {};
+        static inline thread_local int depth = 0;
+
+        State& state;
+    };
+
+    LivenessToken() = default;
+    ~LivenessToken() { invalidate(); }
+
+    LivenessToken(const LivenessToken&) = delete;
+    LivenessToken& operator=(const LivenessToken&) = delete;
+
+    [[nodiscard]] std::shared_ptr<State> getState() const noexcept { return state; }
+
+    // Sans effet au-delà du premier appel
+    void invalidate() noexcept
+    {
+        state->alive.store(false);
+        while (state->callbacksInFlight.load() > Scope::countOnThisThread(state.get()))
+            std::this_thread::yield();
+    }
+
+private:
+    std::shared_ptr<State> state = std::make_shared<State>();
+};
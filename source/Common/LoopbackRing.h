@@ -0,0 +1,392 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+// Transport local entre un MeloVSTSend et un MeloVSTReceive de la même machine et de la même session :
+// trames float mono à 48 kHz échangées dans un anneau en mémoire partagée (fichier projeté en mémoire,
+// nommé d'après la session), sans Opus, SRTP, ICE ni STUN.
+// Un seul écrivain (l'émetteur qui a revendiqué l'anneau) et un seul lecteur. Chaque côté signale sa
+// présence par un battement de cœur : l'émetteur n'écrit que si un récepteur est là, le récepteur ne
+// lit (et ignore le flux RTP) que tant que l'émetteur est là. L'écrivain n'attend jamais : un lecteur
+// trop lent perd les trames les plus anciennes, comme des paquets perdus pour son tampon de gigue.
+// L'en-tête compte les projections ouvertes : la dernière fermée supprime le fichier.
+class LoopbackRing
+{
+public:
+    static constexpr int sampleRate = 48000;
+    // 5 ms : la trame tient dans une case du tampon de gigue (JitterBuffer::maxPayloadSize)
+    static constexpr int frameSamples = 240;
+    static constexpr int numSlots = 128; // 640 ms
+    // Sans battement de cœur depuis ce délai, l'autre côté est considéré comme parti (instance fermée, hôte planté)
+    static constexpr int64_t peerTimeoutMs = 500;
+
+    enum class Role
+    {
+        Writer,
+        Reader
+    };
+
+    struct FrameInfo
+    {
+        // Index de la trame depuis la création de l'anneau, continu d'un émetteur à l'autre
+        uint64_t index = 0;
+        // Identifiant de l'émetteur qui l'a écrite : change quand un autre émetteur reprend l'anneau
+        uint32_t writerId = 0;
+        int numSamples = 0;
+    };
+
+    LoopbackRing() = default;
+    ~LoopbackRing() { close(); }
+
+    LoopbackRing(const LoopbackRing&) = delete;
+    LoopbackRing& operator=(const LoopbackRing&) = delete;
+
+    // Fichier de l'anneau d'une session, dans le dossier temporaire de l'utilisateur
+    static juce::File getRingFile(const juce::String& sessionId)
+    {
+        return juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getChildFile(juce::File::createLegalFileName("MeloLoopback-" + sessionId + ".ring"));
+    }
+
+    // Projette l'anneau en mémoire (le crée s'il n'existe pas). Jamais depuis le thread audio.
+    bool open(const juce::File& file, const Role newRole)
+    {
+        close();
+        // Un anneau retiré par son dernier utilisateur va être supprimé : on attend qu'il le soit pour en
+        // créer un neuf. Toujours là après le délai, son dernier utilisateur a disparu entre les deux : on le
+        // supprime, s'il s'agit bien toujours du même fichier retiré
+        uint64_t retiredFileId = 0;
+        for (int attempt = 0; attempt <= maxRetiredWaitMs; ++attempt)
+        {
+            if (attempt == maxRetiredWaitMs && retiredFileId != 0)
+                removeRetiredRing(file, retiredFileId);
+
+            uint64_t fileId = 0;
+            switch (mapAndAttach(file, newRole, fileId))
+            {
+                case AttachResult::attached:
+                    ringFile = file;
+                    ringFileId = fileId;
+                    return true;
+                case AttachResult::failed:
+                    return false;
+                case AttachResult::retired:
+                    retiredFileId = fileId;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    break;
+            }
+        }
+        return false;
+    }
+
+    // Annonce le départ à l'autre côté. Pas pendant un write() ou un read() d'un autre thread.
+    void close()
+    {
+        if (header != nullptr)
+        {
+            if (role == Role::Writer)
+            {
+                uint64_t expected = token;
+                header->writerToken.compare_exchange_strong(expected, 0);
+            }
+            else
+            {
+                header->readerHeartbeatMs.store(0);
+            }
+        }
+
+        bool isLastUser = false;
+        if (header != nullptr)
+        {
+            uint32_t users = header->users.load();
+            while (!header->users.compare_exchange_weak(users, users <= 1 ? retiredUsers : users - 1)) {}
+            isLastUser = users <= 1;
+        }
+        header = nullptr;
+        slots = nullptr;
+        mapping.reset();
+
+        if (isLastUser)
+            removeRetiredRing(ringFile, ringFileId);
+        ringFile = juce::File();
+        ringFileId = 0;
+    }
+
+    [[nodiscard]] bool isOpen() const noexcept { return header != nullptr; }
+
+    // À appeler régulièrement (au moins toutes les peerTimeoutMs / 2) par le thread qui écrit ou lit.
+    // L'émetteur revendique ici un anneau libre ou abandonné.
+    void heartbeat() noexcept
+    {
+        if (header == nullptr)
+            return;
+        const int64_t now = nowMs();
+        if (role == Role::Reader)
+        {
+            header->readerHeartbeatMs.store(now, std::memory_order_release);
+            return;
+        }
+
+        uint64_t owner = header->writerToken.load(std::memory_order_acquire);
+        if (owner != token && (owner == 0 || isStale(header->writerHeartbeatMs.load(std::memory_order_acquire), now)))
+            header->writerToken.compare_exchange_strong(owner, token, std::memory_order_acq_rel);
+        if (ownsRing())
+            header->writerHeartbeatMs.store(now, std::memory_order_release);
+    }
+
+    // Émetteur : vrai s'il a revendiqué l'anneau (un autre émetteur de la session peut l'avoir déjà)
+    [[nodiscard]] bool ownsRing() const noexcept
+    {
+        return header != nullptr && role == Role::Writer && header->writerToken.load(std::memory_order_acquire) == token;
+    }
+
+    // L'autre côté est-il présent ? Pour le récepteur, un émetteur qui a revendiqué l'anneau
+    [[nodiscard]] bool isPeerPresent() const noexcept
+    {
+        if (header == nullptr)
+            return false;
+        const int64_t now = nowMs();
+        if (role == Role::Writer)
+            return !isStale(header->readerHeartbeatMs.load(std::memory_order_acquire), now);
+        return header->writerToken.load(std::memory_order_acquire) != 0
+               && !isStale(header->writerHeartbeatMs.load(std::memory_order_acquire), now);
+    }
+
+    // Émetteur, sans verrou ni allocation. numSamples est ramené à frameSamples ; sans effet si l'anneau
+    // appartient à un autre émetteur.
+    void write(const float* samples, const int numSamples) noexcept
+    {
+        if (!ownsRing() || numSamples <= 0)
+            return;
+
+        const uint64_t index = header->writeIndex.load(std::memory_order_relaxed);
+        auto& slot = slots[index % numSlots];
+        // Version impaire pendant l'écriture : un lecteur qui lit la case en même temps recommence
+        slot.version.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.writerId = static_cast<uint32_t>(token);
+        slot.numSamples = std::min(numSamples, frameSamples);
+        std::memcpy(slot.samples, samples, static_cast<size_t>(slot.numSamples) * sizeof(float));
+        slot.version.store(index * 2 + 2, std::memory_order_release);
+        header->writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    // Récepteur : copie la prochaine trame (frameSamples échantillons au plus) dans destination.
+    // Renvoie false s'il n'y en a pas de nouvelle. Les trames écrasées avant d'être lues sont sautées.
+    bool read(FrameInfo& info, float* destination) noexcept
+    {
+        if (header == nullptr)
+            return false;
+
+        for (;;)
+        {
+            const uint64_t written = header->writeIndex.load(std::memory_order_acquire);
+            if (readIndex >= written)
+                return false;
+            if (written - readIndex > maxBacklog)
+            {
+                overruns += written - readIndex - maxBacklog;
+                readIndex = written - maxBacklog;
+            }
+
+            const auto& slot = slots[readIndex % numSlots];
+            const uint64_t expectedVersion = readIndex * 2 + 2;
+            if (slot.version.load(std::memory_order_acquire) == expectedVersion)
+            {
+                const int numSamples = std::clamp(slot.numSamples, 0, frameSamples);
+                const uint32_t writerId = slot.writerId;
+                std::memcpy(destination, slot.samples, static_cast<size_t>(numSamples) * sizeof(float));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.version.load(std::memory_order_relaxed) == expectedVersion)
+                {
+                    info.index = readIndex++;
+                    info.writerId = writerId;
+                    info.numSamples = numSamples;
+                    return true;
+                }
+            }
+            // Case réécrite pendant la copie : l'écrivain a pris un tour d'avance, on se recale
+            ++overruns;
+            ++readIndex;
+        }
+    }
+
+    // Récepteur : trames perdues parce que l'émetteur a fait le tour de l'anneau
+    [[nodiscard]] uint64_t getNumOverruns() const noexcept { return overruns; }
+
+private:
+    static constexpr uint32_t magic = 0x4D4C4F50; // "MLOP"
+    static constexpr uint32_t layoutVersion = 2;
+    // Valeur de Header::users quand le dernier utilisateur a fermé l'anneau : plus personne ne s'y attache
+    static constexpr uint32_t retiredUsers = 0xFFFFFFFF;
+    static constexpr int maxRetiredWaitMs = 100;
+    // Trames lisibles au plus : la case suivante est peut-être en cours d'écriture
+    static constexpr uint64_t maxBacklog = numSlots - 1;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free,
+                  "les atomiques partagés entre processus doivent être sans verrou");
+
+    struct Header
+    {
+        std::atomic<uint32_t> state; // 0 vierge, 1 en cours d'initialisation, 2 prêt
+        uint32_t magicNumber;
+        uint32_t version;
+        int32_t ringSampleRate;
+        int32_t ringFrameSamples;
+        int32_t ringNumSlots;
+        std::atomic<uint32_t> users; // projections ouvertes, ou retiredUsers
+        alignas(64) std::atomic<uint64_t> writerToken;
+        std::atomic<int64_t> writerHeartbeatMs;
+        alignas(64) std::atomic<int64_t> readerHeartbeatMs;
+        alignas(64) std::atomic<uint64_t> writeIndex;
+    };
+
+    struct Slot
+    {
+        std::atomic<uint64_t> version;
+        uint32_t writerId;
+        int32_t numSamples;
+        float samples[frameSamples];
+    };
+
+    static constexpr size_t headerSize = (sizeof(Header) + 63) / 64 * 64;
+    static constexpr size_t totalSize = headerSize + sizeof(Slot) * numSlots;
+
+    enum class AttachResult
+    {
+        attached,
+        retired, // anneau retiré, ou fichier remplacé pendant la projection : à retenter
+        failed
+    };
+
+    // Supprime le fichier d'un anneau retiré, seulement s'il est toujours à son chemin : un autre utilisateur a
+    // pu le supprimer et créer un anneau neuf à la place. Le fichier est d'abord renommé sous un nom unique,
+    // ce que seul l'un des candidats à la suppression réussit, puis vérifié avant d'être supprimé.
+    static void removeRetiredRing(const juce::File& file, const uint64_t retiredFileId)
+    {
+        if (retiredFileId == 0 || file.getFileIdentifier() != retiredFileId)
+            return;
+
+        const auto claimed = file.getSiblingFile(file.getFileName() + "."
+                                                 + juce::String::toHexString(juce::Random::getSystemRandom().nextInt64())
+                                                 + ".retired");
+        if (!file.moveFileTo(claimed))
+            return;
+        if (claimed.getFileIdentifier() == retiredFileId)
+        {
+            claimed.deleteFile();
+            return;
+        }
+        // Anneau neuf déplacé par erreur entre la vérification et le renommage : il retrouve son chemin
+        if (!file.exists())
+            claimed.moveFileTo(file);
+        else
+            claimed.deleteFile();
+    }
+
+    // fileId : identifiant du fichier projeté (inode), pour ne jamais supprimer un autre anneau que celui-ci
+    AttachResult mapAndAttach(const juce::File& file, const Role newRole, uint64_t& fileId)
+    {
+        if (!file.existsAsFile() && !file.create().wasOk())
+            return AttachResult::failed;
+
+        // Agrandi sans jamais remplacer le fichier : l'autre côté l'a peut-être déjà projeté
+        if (const auto existingSize = file.getSize(); existingSize < static_cast<int64_t>(totalSize))
+        {
+            juce::FileOutputStream stream(file);
+            if (!stream.openedOk())
+                return AttachResult::failed;
+            juce::MemoryBlock zeros(totalSize - static_cast<size_t>(existingSize), true);
+            stream.write(zeros.getData(), zeros.getSize());
+        }
+
+        const auto idBeforeMapping = file.getFileIdentifier();
+        auto newMapping = std::make_unique<juce::MemoryMappedFile>(file, juce::Range<int64_t>(0, static_cast<int64_t>(totalSize)),
+                                                                   juce::MemoryMappedFile::readWrite, false);
+        if (newMapping->getData() == nullptr || newMapping->getSize() < totalSize)
+            return AttachResult::failed;
+        // Fichier remplacé pendant la projection (anneau retiré puis recréé) : on recommence sur le nouveau
+        fileId = file.getFileIdentifier();
+        if (fileId != idBeforeMapping)
+        {
+            fileId = 0;
+            return AttachResult::retired;
+        }
+
+        mapping = std::move(newMapping);
+        const auto result = attach(mapping->getData(), newRole);
+        if (result != AttachResult::attached)
+            mapping.reset();
+        return result;
+    }
+
+    AttachResult attach(void* memory, const Role newRole)
+    {
+        auto* newHeader = static_cast<Header*>(memory);
+
+        // Le premier arrivé initialise l'en-tête ; la mémoire d'un fichier neuf est à zéro
+        uint32_t state = 0;
+        if (newHeader->state.compare_exchange_strong(state, 1))
+        {
+            newHeader->magicNumber = magic;
+            newHeader->version = layoutVersion;
+            newHeader->ringSampleRate = sampleRate;
+            newHeader->ringFrameSamples = frameSamples;
+            newHeader->ringNumSlots = numSlots;
+            newHeader->state.store(2, std::memory_order_release);
+        }
+        for (int i = 0; i < 100 && newHeader->state.load(std::memory_order_acquire) != 2; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if (newHeader->state.load(std::memory_order_acquire) != 2 || newHeader->magicNumber != magic
+            || newHeader->version != layoutVersion || newHeader->ringSampleRate != sampleRate
+            || newHeader->ringFrameSamples != frameSamples || newHeader->ringNumSlots != numSlots)
+            return AttachResult::failed;
+
+        uint32_t users = newHeader->users.load();
+        do
+        {
+            if (users == retiredUsers)
+                return AttachResult::retired;
+        } while (!newHeader->users.compare_exchange_weak(users, users + 1));
+
+        header = newHeader;
+        slots = reinterpret_cast<Slot*>(static_cast<char*>(memory) + headerSize);
+        role = newRole;
+        token = static_cast<uint64_t>(juce::Random::getSystemRandom().nextInt64()) | 1;
+        // Le récepteur commence au direct, pas au début de l'historique de l'anneau
+        readIndex = header->writeIndex.load(std::memory_order_acquire);
+        overruns = 0;
+        heartbeat();
+        return AttachResult::attached;
+    }
+
+    static int64_t nowMs() noexcept
+    {
+        // Horloge monotone commune aux processus de la machine
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static bool isStale(const int64_t heartbeatMs, const int64_t now) noexcept
+    {
+        return heartbeatMs == 0 || now - heartbeatMs > peerTimeoutMs;
+    }
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    juce::File ringFile;
+    uint64_t ringFileId = 0;
+    Header* header = nullptr;
+    Slot* slots = nullptr;
+    Role role = Role::Reader;
+    uint64_t token = 0;
+
+    // Récepteur uniquement
+    uint64_t readIndex = 0;
+    uint64_t overruns = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <opus.h>
+#include <stdexcept>
+#include <string>
+
+class OpusDecoderWrapper {
+public:
+    OpusDecoderWrapper(const int sample_rate, const int channels): numChannels(channels), sampleRate(sample_rate) {
+        int error;
+        decoder = opus_decoder_create(sample_rate, channels, &error);
+        if (error != OPUS_OK)
+            throw std::runtime_error("Failed to create Opus decoder: " + std::string(opus_strerror(error)));
+    }
+
+    ~OpusDecoderWrapper() {
+        if (decoder)
+            opus_decoder_destroy(decoder);
+    }
+
+    OpusDecoderWrapper(const OpusDecoderWrapper&) = delete;
+    OpusDecoderWrapper& operator=(const OpusDecoderWrapper&) = delete;
+
+    // Décode un paquet dans pcm (entrelacé), sans allocation.
+    // Renvoie le nombre d'échantillons par canal, ou un code d'erreur Opus négatif.
+    int decode_float(const unsigned char* packet, const size_t size, float* pcm, const int maxFrameSize) const {
+        return opus_decode_float(decoder, packet, static_cast<opus_int32>(size), pcm, maxFrameSize, 0);
+    }
+
+    // Récupère la trame perdue juste avant packet à partir de sa FEC intégrée (LBRR).
+    // frameSize doit être la durée exacte de la trame perdue ; sans FEC dans le paquet, Opus applique la PLC.
+    int decode_fec_float(const unsigned char* packet, const size_t size, float* pcm, const int frameSize) const {
+        return opus_decode_float(decoder, packet, static_cast<opus_int32>(size), pcm, frameSize, 1);
+    }
+
+    // Dissimulation de perte (PLC) : synthétise frameSize échantillons par canal à la place d'un paquet manquant
+    int conceal_float(float* pcm, const int frameSize) const {
+        return opus_decode_float(decoder, nullptr, 0, pcm, frameSize, 0);
+    }
+
+    void reset() const {
+        opus_decoder_ctl(decoder, OPUS_RESET_STATE);
+    }
+
+    [[nodiscard]] int getNumChannels() const noexcept { return numChannels; }
+    [[nodiscard]] int getSampleRate() const noexcept { return sampleRate; }
+
+private:
+    OpusDecoder *decoder = nullptr;
+    int numChannels;
+    int sampleRate;
+};
@@ -3,6 +3,7 @@
 #include <vector>
 #include <stdexcept>
 #include <functional>
+#include <algorithm>
 
 #define MAX_OPUS_PACKET_SIZE 1500
 
@@ -17,9 +18,11 @@ public:
         // Configuration de l'encodeur
         opus_encoder_ctl(encoder, OPUS_SET_BITRATE(bitrate));
         // opus_encoder_ctl(encoder, OPUS_SET_BITRATE(OPUS_AUTO));
-        // opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(0));
         // opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(5));
-        // opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(0));
+        // FEC intégrée (LBRR) : chaque paquet transporte une copie basse qualité de la trame précédente.
+        // Le taux de perte attendu est ensuite ajusté avec setPacketLossPercent() selon les rapports RTCP.
+        opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(1));
+        opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(defaultPacketLossPercent));
         // opus_encoder_ctl(encoder, OPUS_SET_DTX(0));
         // opus_decoder_ctl(decoder, OPUS_SET_GAIN(1));
 
@@ -45,6 +48,19 @@ public:
         return res;
     }
 
+    // Encode directement dans un tampon fourni par l'appelant, sans allocation.
+    // Renvoie la taille du paquet en octets ou un code d'erreur Opus (< 0).
+    int encodeInto(const float* pcm, const int nbSamples, unsigned char* output, const int maxBytes) const noexcept {
+        return opus_encode_float(encoder, pcm, nbSamples, output, maxBytes);
+    }
+
+    // Taux de perte attendu (0-100) : plus il est élevé, plus l'encodeur consacre de débit à la FEC
+    void setPacketLossPercent(const int percent) const {
+        opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(std::clamp(percent, 0, 100)));
+    }
+
+    static constexpr int defaultPacketLossPercent = 5;
+
 private:
     std::vector<int16_t> in_buffer_;
     std::vector<float> in_buffer_float_;
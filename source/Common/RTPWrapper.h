@@ -1,7 +1,10 @@
 #pragma once
 #include <vector>
+#include <cstddef>
 #include <cstring>
+#include <span>
 #include <stdexcept>
+#include <optional>
 #include <arpa/inet.h> // Pour htons et htonl
 
 // Constants
@@ -20,6 +23,83 @@ struct RTPHeader {
     uint32_t ssrc; // Synchronization Source Identifier
 };
 
+// Vue non propriétaire sur un paquet RTP reçu : l'en-tête est analysé en place (RFC 3550 §5.1),
+// CSRC, extension et bourrage compris, et la charge utile reste dans le tampon d'origine.
+// La vue n'est valide que tant que ce tampon existe.
+class RtpPacketView {
+public:
+    static constexpr size_t minHeaderSize = 12;
+
+    // Renvoie std::nullopt si le paquet est tronqué, d'une autre version ou sans charge utile
+    static std::optional<RtpPacketView> parse(const std::span<const std::byte> packet) {
+        if (packet.size() < minHeaderSize) {
+            return std::nullopt;
+        }
+
+        const uint8_t v_p_x_cc = byteAt(packet, 0);
+        if (((v_p_x_cc >> 6) & 0x03) != RTP_VERSION) {
+            return std::nullopt;
+        }
+
+        // 12 octets + 4 octets par CSRC
+        size_t headerSize = minHeaderSize + static_cast<size_t>(v_p_x_cc & 0x0F) * 4;
+        if ((v_p_x_cc >> 4) & 0x01) {
+            // En-tête d'extension : 16 bits de profil puis 16 bits de longueur en mots de 32 bits
+            if (packet.size() < headerSize + 4) {
+                return std::nullopt;
+            }
+            headerSize += 4 + static_cast<size_t>(readUInt16(packet, headerSize + 2)) * 4;
+        }
+        if (packet.size() <= headerSize) {
+            return std::nullopt;
+        }
+
+        // Bourrage : le dernier octet donne le nombre d'octets à retirer, lui compris
+        size_t paddingSize = 0;
+        if ((v_p_x_cc >> 5) & 0x01) {
+            paddingSize = byteAt(packet, packet.size() - 1);
+            if (paddingSize == 0 || paddingSize >= packet.size() - headerSize) {
+                return std::nullopt;
+            }
+        }
+
+        return RtpPacketView(packet, packet.subspan(headerSize, packet.size() - headerSize - paddingSize));
+    }
+
+    [[nodiscard]] bool getMarker() const noexcept { return (byteAt(packet, 1) >> 7) & 0x01; }
+    [[nodiscard]] uint8_t getPayloadType() const noexcept { return byteAt(packet, 1) & 0x7F; }
+    [[nodiscard]] uint16_t getSequenceNumber() const noexcept { return readUInt16(packet, 2); }
+    [[nodiscard]] uint32_t getTimestamp() const noexcept { return readUInt32(packet, 4); }
+    [[nodiscard]] uint32_t getSsrc() const noexcept { return readUInt32(packet, 8); }
+
+    [[nodiscard]] std::span<const std::byte> getPayload() const noexcept { return payload; }
+
+    // Charge utile sous la forme attendue par libopus
+    [[nodiscard]] const unsigned char *getPayloadData() const noexcept {
+        return reinterpret_cast<const unsigned char *>(payload.data());
+    }
+
+private:
+    RtpPacketView(const std::span<const std::byte> packetBytes, const std::span<const std::byte> payloadBytes)
+        : packet(packetBytes), payload(payloadBytes) {
+    }
+
+    static uint8_t byteAt(const std::span<const std::byte> data, const size_t offset) noexcept {
+        return std::to_integer<uint8_t>(data[offset]);
+    }
+
+    static uint16_t readUInt16(const std::span<const std::byte> data, const size_t offset) noexcept {
+        return static_cast<uint16_t>((byteAt(data, offset) << 8) | byteAt(data, offset + 1));
+    }
+
+    static uint32_t readUInt32(const std::span<const std::byte> data, const size_t offset) noexcept {
+        return (static_cast<uint32_t>(readUInt16(data, offset)) << 16) | readUInt16(data, offset + 2);
+    }
+
+    std::span<const std::byte> packet;
+    std::span<const std::byte> payload;
+};
+
 class RTPWrapper {
 public:
     static std::vector<uint8_t> createRTPPacket(const std::vector<unsigned char> &audioData, uint16_t seqNum,
@@ -44,47 +124,44 @@ public:
     static constexpr size_t RTP_MIN_HEADER_SIZE = 12;
 
     static std::vector<unsigned char> removeRTPHeader(const std::vector<unsigned char> &rtpPacket) {
-        // Vérifier que le paquet est assez grand pour contenir le header minimal
-        if (rtpPacket.size() < RTP_MIN_HEADER_SIZE) {
-            throw std::runtime_error("Invalid RTP packet: too small to contain a header");
+        const auto packet = RtpPacketView::parse(std::as_bytes(std::span(rtpPacket)));
+        if (!packet) {
+            throw std::runtime_error("Invalid RTP packet");
         }
 
-        // Le premier octet contient : version (bits 7-6), padding (bit 5), extension (bit 4) et CSRC count (bits 3-0)
-        const unsigned char v_p_x_cc = rtpPacket[0];
-
-        // Extraire la version RTP
-        const unsigned char version = (v_p_x_cc >> 6) & 0x03;
-        if (version != RTP_VERSION) {
-            throw std::runtime_error("Invalid RTP packet: unsupported version");
-        }
-
-        // Extraire le CSRC count (nombre d'identifiants CSRC)
-        const unsigned char csrcCount = v_p_x_cc & 0x0F;
+        // Retourner uniquement le payload (sans l'en-tête RTP ni le bourrage)
+        const auto payload = packet->getPayload();
+        return std::vector<unsigned char>(packet->getPayloadData(), packet->getPayloadData() + payload.size());
+    }
 
-        // Taille de l'en-tête RTP de base : 12 octets + 4 octets par CSRC
-        size_t headerSize = RTP_MIN_HEADER_SIZE + (csrcCount * 4);
+    static constexpr uint8_t RTCP_SENDER_REPORT = 200;
+    static constexpr uint8_t RTCP_RECEIVER_REPORT = 201;
 
-        // Vérifier le flag d'extension (bit 4 du premier octet)
-        const unsigned char extensionFlag = (v_p_x_cc >> 4) & 0x01;
-        if (extensionFlag) {
-            // Pour une extension, il faut au moins 4 octets supplémentaires pour l'en-tête d'extension
-            if (rtpPacket.size() < headerSize + 4) {
-                throw std::runtime_error("Invalid RTP packet: not enough data for extension header");
+    // Parcourt un paquet RTCP composé et renvoie la "fraction lost" (0-255, RFC 3550 §6.4.1)
+    // du premier bloc de rapport trouvé dans un SR ou un RR.
+    static std::optional<uint8_t> getRTCPFractionLost(const unsigned char *data, const size_t size) {
+        size_t offset = 0;
+        while (offset + 8 <= size) {
+            const unsigned char *packet = data + offset;
+            if (((packet[0] >> 6) & 0x03) != RTP_VERSION) {
+                return std::nullopt;
+            }
+            const unsigned char reportCount = packet[0] & 0x1F;
+            const unsigned char packetType = packet[1];
+            const size_t length = (static_cast<size_t>((packet[2] << 8) | packet[3]) + 1) * 4;
+            if (offset + length > size) {
+                return std::nullopt;
             }
-            // L'en-tête d'extension se compose de 4 octets : 16 bits de profil et 16 bits de longueur (en mots 32 bits)
-            // La longueur est située aux octets headerSize+2 et headerSize+3 (en big-endian)
-            uint16_t extensionLength = (static_cast<uint16_t>(rtpPacket[headerSize + 2]) << 8) |
-                                       static_cast<uint16_t>(rtpPacket[headerSize + 3]);
-            // La taille de l'extension est de 4 octets pour le header + extensionLength * 4 octets supplémentaires
-            headerSize += 4 + (extensionLength * 4);
-        }
 
-        // Vérifier que le paquet contient des données payload après l'en-tête
-        if (rtpPacket.size() <= headerSize) {
-            throw std::runtime_error("Invalid RTP packet: no payload data");
+            // En-tête (4 octets) + SSRC de l'émetteur (4 octets), plus 20 octets d'infos émetteur pour un SR
+            const size_t firstBlock = packetType == RTCP_SENDER_REPORT ? 28 : 8;
+            if ((packetType == RTCP_SENDER_REPORT || packetType == RTCP_RECEIVER_REPORT)
+                && reportCount > 0 && length >= firstBlock + 24) {
+                // Bloc de rapport : SSRC source (4 octets) puis fraction lost (1 octet)
+                return packet[firstBlock + 4];
+            }
+            offset += length;
         }
-
-        // Retourner uniquement le payload (sans l'en-tête RTP)
-        return std::vector<unsigned char>(rtpPacket.begin() + headerSize, rtpPacket.end());
+        return std::nullopt;
     }
 };
@@ -0,0 +1,337 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <pthread.h>
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #include <sched.h>
+    #include <sys/syscall.h>
+#elif defined(__APPLE__)
+    #include <pthread/qos.h>
+#endif
+
+// Réglages temps réel des threads d'encodage et de réception (StreamWorkerPool) et verrouillage en mémoire
+// de leur jeu de travail. Sur une machine chargée, un thread à la priorité par défaut est préempté par
+// l'interface ou l'indexation et ses trames partent en retard.
+//
+// Linux : SCHED_RR avec SCHED_RESET_ON_FORK, comme l'accorde rtkit, et dans la limite de RLIMIT_RTPRIO. Les
+// limites du processus appartiennent à l'hôte et ne sont jamais modifiées (pas de RLIMIT_RTTIME imposé à ses
+// propres threads). Sans droit au temps réel, la priorité « nice » du thread est relevée dans la limite de RLIMIT_NICE.
+// macOS : classe de QoS « user interactive », l'affinité n'y est pas exposée.
+// Windows : rien n'est encore demandé, les threads gardent leur priorité et la mémoire reste paginable.
+// Rien n'est jamais imposé : chaque appel rapporte ce qu'il a obtenu.
+namespace RealtimeThreads
+{
+    enum class Elevation
+    {
+        Unchanged, // priorité par défaut
+        Raised,    // priorité relevée sans ordonnancement temps réel (nice, QoS)
+        Realtime   // SCHED_RR
+    };
+
+    struct Options
+    {
+        // Priorité SCHED_RR demandée (1-99), volontairement sous celle des threads audio des hôtes
+        int realtimePriority = 10;
+        // Valeur nice visée quand le temps réel est refusé
+        int niceValue = -10;
+        // Cœur sur lequel fixer le thread (parmi getAllowedCpus()), -1 pour le laisser migrer
+        int cpu = -1;
+    };
+
+    struct Report
+    {
+        Elevation elevation = Elevation::Unchanged;
+        // Priorité SCHED_RR ou valeur nice obtenue
+        int priority = 0;
+        bool affinitySet = false;
+
+        [[nodiscard]] std::string describe() const
+        {
+            std::string text = elevation == Elevation::Realtime ? "SCHED_RR " + std::to_string(priority)
+                               : elevation == Elevation::Raised ? "nice " + std::to_string(priority)
+                                                                : std::string("default priority");
+            return affinitySet ? text + ", pinned" : text;
+        }
+    };
+
+    // Cœurs sur lesquels le processus a le droit de tourner (cpuset, taskset), par ordre croissant ;
+    // vide là où l'affinité n'est pas exposée
+    inline std::vector<int> getAllowedCpus()
+    {
+        std::vector<int> cpus;
+#if defined(__linux__)
+        // Masque du processus (son thread principal), pas celui du thread appelant, peut-être déjà fixé
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(getpid(), sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+        }
+#endif
+        return cpus;
+    }
+
+    // Cœur du index-ième thread d'une réserve : un par thread, en partant du dernier cœur autorisé (le premier
+    // reçoit le plus souvent les interruptions). -1 si l'affinité n'est pas disponible.
+    inline int getWorkerCpu(const int index)
+    {
+        const auto cpus = getAllowedCpus();
+        if (cpus.empty() || index < 0)
+            return -1;
+        return cpus[cpus.size() - 1 - static_cast<size_t>(index) % cpus.size()];
+    }
+
+    namespace detail
+    {
+        inline Elevation raiseNice(const int niceValue, int& obtained)
+        {
+#if defined(__linux__)
+            // Sous Linux, la valeur nice s'applique au thread désigné par son identifiant noyau
+            const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+            rlimit limit {};
+            int target = niceValue;
+            if (getrlimit(RLIMIT_NICE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+                target = std::max(niceValue, 20 - static_cast<int>(limit.rlim_cur));
+            if (target < 0 && setpriority(PRIO_PROCESS, tid, target) == 0)
+            {
+                obtained = target;
+                return Elevation::Raised;
+            }
+            return Elevation::Unchanged;
+#elif defined(__APPLE__)
+            std::ignore = niceValue;
+            if (pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0)
+            {
+                obtained = 0;
+                return Elevation::Raised;
+            }
+            return Elevation::Unchanged;
+#else
+            std::ignore = niceValue;
+            std::ignore = obtained;
+            return Elevation::Unchanged;
+#endif
+        }
+
+        inline bool requestRealtime(const int requestedPriority, int& obtained)
+        {
+#if defined(__linux__)
+            rlimit limit {};
+            int priority = std::clamp(requestedPriority, sched_get_priority_min(SCHED_RR), sched_get_priority_max(SCHED_RR));
+            if (getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+            {
+                // Pas de droit au temps réel (cas par défaut d'un utilisateur sans groupe audio)
+                if (limit.rlim_cur == 0 && geteuid() != 0)
+                    return false;
+                if (geteuid() != 0)
+                    priority = std::min(priority, static_cast<int>(limit.rlim_cur));
+            }
+
+            sched_param parameters {};
+            parameters.sched_priority = priority;
+            // Les processus créés depuis ce thread ne gardent pas sa priorité
+            if (pthread_setschedparam(pthread_self(), SCHED_RR | SCHED_RESET_ON_FORK, &parameters) != 0)
+                return false;
+            obtained = priority;
+            return true;
+#else
+            std::ignore = requestedPriority;
+            std::ignore = obtained;
+            return false;
+#endif
+        }
+
+        inline bool pinToCpu(const int cpu)
+        {
+#if defined(__linux__)
+            // Un cœur hors du cpuset serait refusé par le noyau : on ne le demande même pas
+            if (const auto allowed = getAllowedCpus(); std::find(allowed.begin(), allowed.end(), cpu) == allowed.end())
+                return false;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+            std::ignore = cpu;
+            return false;
+#endif
+        }
+    }
+
+    // Applique les options au thread appelant, à appeler une fois au démarrage du thread
+    inline Report promoteCurrentThread(const Options& options)
+    {
+        Report report;
+        if (detail::requestRealtime(options.realtimePriority, report.priority))
+            report.elevation = Elevation::Realtime;
+        else
+            report.elevation = detail::raiseNice(options.niceValue, report.priority);
+        if (options.cpu >= 0)
+            report.affinitySet = detail::pinToCpu(options.cpu);
+        return report;
+    }
+
+    namespace detail
+    {
+        // Pages verrouillées par le processus et nombre de régions qui les utilisent : le noyau ne compte pas les
+        // verrous, une page n'est déverrouillée qu'au départ de la dernière région qui la couvre
+        struct PageLocks
+        {
+            std::mutex mutex;
+            std::map<uintptr_t, int> users;
+        };
+
+        inline PageLocks& getPageLocks()
+        {
+            // Jamais détruit : des régions peuvent être relâchées pendant la destruction des statiques
+            static auto* locks = new PageLocks();
+            return *locks;
+        }
+
+        inline size_t getPageSize() noexcept
+        {
+#if defined(__linux__) || defined(__APPLE__)
+            static const auto pageSize = static_cast<size_t>(std::max(1L, sysconf(_SC_PAGESIZE)));
+            return pageSize;
+#else
+            return 4096;
+#endif
+        }
+
+        inline bool lockPages(const uintptr_t first, const size_t size) noexcept
+        {
+#if defined(__linux__) || defined(__APPLE__)
+            return mlock(reinterpret_cast<const void*>(first), size) == 0;
+#else
+            std::ignore = first;
+            std::ignore = size;
+            return false;
+#endif
+        }
+
+        inline void unlockPages(const uintptr_t first, const size_t size) noexcept
+        {
+#if defined(__linux__) || defined(__APPLE__)
+            munlock(reinterpret_cast<const void*>(first), size);
+#else
+            std::ignore = first;
+            std::ignore = size;
+#endif
+        }
+    }
+
+    // Régions verrouillées en mémoire physique (mlock) : le jeu de travail du thread audio et de l'encodeur ne
+    // part pas en swap et ne provoque aucun défaut de page en cours de traitement. Le verrouillage porte sur des
+    // pages entières, comptées pour tout le processus : une page partagée avec une autre région reste verrouillée
+    // tant que l'une d'elles la couvre. Limité par RLIMIT_MEMLOCK ; une région refusée reste simplement pageable.
+    //
+    // Pour reconstruire un jeu de travail, verrouiller les nouvelles régions dans une autre instance puis la
+    // déplacer dans l'ancienne : les pages communes aux deux ne sont jamais déverrouillées entre-temps.
+    class LockedMemory
+    {
+    public:
+        LockedMemory() = default;
+        ~LockedMemory() { unlockAll(); }
+
+        LockedMemory(const LockedMemory&) = delete;
+        LockedMemory& operator=(const LockedMemory&) = delete;
+
+        LockedMemory(LockedMemory&& other) noexcept
+            : regions(std::exchange(other.regions, {})), lockedBytes(std::exchange(other.lockedBytes, 0)) {}
+
+        // Les régions d'other sont déjà verrouillées quand les nôtres sont relâchées
+        LockedMemory& operator=(LockedMemory&& other) noexcept
+        {
+            if (this != &other)
+            {
+                unlockAll();
+                regions = std::exchange(other.regions, {});
+                lockedBytes = std::exchange(other.lockedBytes, 0);
+            }
+            return *this;
+        }
+
+        // Renvoie faux si le système refuse (limite atteinte, plateforme sans mlock)
+        bool lock(const void* data, const size_t size)
+        {
+            if (data == nullptr || size == 0)
+                return true;
+
+            const auto pageSize = detail::getPageSize();
+            const auto first = reinterpret_cast<uintptr_t>(data) / pageSize * pageSize;
+            const auto end = (reinterpret_cast<uintptr_t>(data) + size + pageSize - 1) / pageSize * pageSize;
+
+            auto& pages = detail::getPageLocks();
+            const std::lock_guard lock(pages.mutex);
+            // Toujours redemandé, même pour des pages déjà comptées : une page libérée puis réattribuée par
+            // l'allocateur (munmap, mmap) a perdu son verrou
+            if (!detail::lockPages(first, end - first))
+                return false;
+            for (auto page = first; page < end; page += pageSize)
+                ++pages.users[page];
+            regions.emplace_back(first, end - first);
+            lockedBytes += size;
+            return true;
+        }
+
+        template <typename Container>
+        bool lockContainer(const Container& container)
+        {
+            return lock(container.data(), container.size() * sizeof(typename Container::value_type));
+        }
+
+        void unlockAll() noexcept
+        {
+            if (regions.empty())
+                return;
+
+            const auto pageSize = detail::getPageSize();
+            auto& pages = detail::getPageLocks();
+            const std::lock_guard lock(pages.mutex);
+            for (const auto& [first, size]: regions)
+            {
+                for (auto page = first; page < first + size; page += pageSize)
+                {
+                    const auto entry = pages.users.find(page);
+                    if (entry == pages.users.end() || --entry->second > 0)
+                        continue;
+                    pages.users.erase(entry);
+                    detail::unlockPages(page, pageSize);
+                }
+            }
+            regions.clear();
+            lockedBytes = 0;
+        }
+
+        [[nodiscard]] size_t getLockedBytes() const noexcept { return lockedBytes; }
+
+        // Pages verrouillées par l'ensemble des LockedMemory du processus
+        [[nodiscard]] static size_t getNumLockedPages()
+        {
+            auto& pages = detail::getPageLocks();
+            const std::lock_guard lock(pages.mutex);
+            return pages.users.size();
+        }
+
+    private:
+        // Plages de pages entières (début, taille)
+        std::vector<std::pair<uintptr_t, size_t>> regions;
+        size_t lockedBytes = 0;
+    };
+}
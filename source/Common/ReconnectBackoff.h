@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+// Délais entre les tentatives de reprise d'une connexion : croissance exponentielle plafonnée, avec une
+// gigue aléatoire pour que plusieurs instances coupées en même temps (changement de point d'accès Wi-Fi)
+// ne retentent pas toutes au même instant. Le premier délai est court : la plupart des coupures se
+// rétablissent dès la première tentative.
+class ReconnectBackoff
+{
+public:
+    struct Parameters
+    {
+        int initialDelayMs = 100;
+        int maxDelayMs = 4000;
+        int maxAttempts = 8;
+    };
+
+    ReconnectBackoff() : ReconnectBackoff(Parameters {}) {}
+
+    explicit ReconnectBackoff(const Parameters& parameters, const uint32_t seed = std::random_device {}())
+        : params(parameters), random(seed) {}
+
+    // Délai avant la prochaine tentative, entre la moitié et la totalité du plafond courant ;
+    // -1 quand toutes les tentatives ont été faites
+    int nextDelayMs()
+    {
+        if (isExhausted())
+            return -1;
+        const int ceiling = getCeilingMs(attempts++);
+        std::uniform_int_distribution<int> jitter(ceiling / 2, ceiling);
+        return jitter(random);
+    }
+
+    // Plafond du délai de la tentative attempt (0 pour la première)
+    [[nodiscard]] int getCeilingMs(const int attempt) const noexcept
+    {
+        int64_t ceiling = params.initialDelayMs;
+        for (int i = 0; i < attempt && ceiling < params.maxDelayMs; ++i)
+            ceiling *= 2;
+        return static_cast<int>(std::min<int64_t>(ceiling, params.maxDelayMs));
+    }
+
+    // Connexion rétablie : la prochaine coupure repart du délai initial
+    void reset() noexcept { attempts = 0; }
+
+    [[nodiscard]] int getAttempts() const noexcept { return attempts; }
+    [[nodiscard]] bool isExhausted() const noexcept { return attempts >= params.maxAttempts; }
+
+private:
+    Parameters params;
+    std::mt19937 random;
+    int attempts = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+
+#include "RtpPacketPool.h"
+
+// Sortie RTP d'un auditeur dans la diffusion d'un encodeur unique vers plusieurs pistes : la charge Opus
+// est encodée une seule fois dans un RtpPacketBuffer partagé, chaque sortie n'y réécrit que les 12 octets
+// d'en-tête avec son propre SSRC, sa séquence et son décalage de timestamp avant l'envoi. Le coût par
+// auditeur se limite donc à cette réécriture et à l'envoi, sans encodeur ni rééchantillonneur de plus.
+//
+// Chaque sortie gère aussi sa contre-pression : une piste dont le tampon d'envoi déborde, ou dont les envois
+// échouent, saute des trames sans ralentir les autres. Utilisée par la seule tâche d'encodage.
+class RtpFanoutOutput {
+public:
+    // Au-delà, la piste est en retard : la trame est sautée plutôt que d'allonger la latence
+    static constexpr size_t maxBufferedBytes = 16 * 1024;
+    // Après autant d'échecs consécutifs, la piste est laissée au repos pendant failureBackoffFrames trames
+    static constexpr int maxConsecutiveFailures = 5;
+    static constexpr int failureBackoffFrames = 50;
+
+    RtpFanoutOutput(const uint32_t outputSsrc, const uint16_t firstSequenceNumber, const uint32_t mediaTimestampOffset) noexcept
+        : header(PAYLOAD_TYPE, outputSsrc), ssrc(outputSsrc), sequenceNumber(firstSequenceNumber), timestampOffset(mediaTimestampOffset) {
+    }
+
+    // SSRC, séquence initiale et décalage de timestamp aléatoires (RFC 3550 §5.1) : deux auditeurs d'une
+    // même instance ne partagent aucun état RTP
+    static RtpFanoutOutput withRandomState() {
+        std::random_device device;
+        std::mt19937 generator(device());
+        std::uniform_int_distribution<uint32_t> distribution;
+        const uint32_t ssrc = distribution(generator);
+        const auto firstSequenceNumber = static_cast<uint16_t>(distribution(generator));
+        return {ssrc == 0 ? 1u : ssrc, firstSequenceNumber, distribution(generator)};
+    }
+
+    // Complète l'en-tête du paquet partagé pour cette piste puis l'envoie par send(bytes) -> bool.
+    // mediaTimestamp est l'horloge RTP de l'encodeur, commune à toutes les sorties. Renvoie faux si la
+    // trame n'a pas été envoyée sur cette piste (contre-pression, repos ou échec).
+    template <typename SendFn>
+    bool send(RtpPacketBuffer& packet, const uint32_t mediaTimestamp, const size_t bufferedAmount, SendFn&& sendFn) {
+        // La séquence avance aussi pour une trame sautée : le récepteur la voit comme une perte et la masque
+        // (FEC, PLC) au lieu de recoller deux trames non contiguës
+        if (backoffFrames > 0) {
+            --backoffFrames;
+            skip();
+            return false;
+        }
+        if (bufferedAmount > maxBufferedBytes) {
+            skip();
+            return false;
+        }
+
+        header.write(packet.data.data(), sequenceNumber++, mediaTimestamp + timestampOffset, markNextPacket);
+        if (!sendFn(packet.bytes())) {
+            ++droppedPackets;
+            if (++consecutiveFailures >= maxConsecutiveFailures) {
+                consecutiveFailures = 0;
+                backoffFrames = failureBackoffFrames;
+            }
+            return false;
+        }
+        markNextPacket = false;
+        consecutiveFailures = 0;
+        ++sentPackets;
+        return true;
+    }
+
+    // La piste (re)devient disponible : le prochain paquet porte le bit marker (début de flux, RFC 3551 §4.1)
+    // et l'éventuel repos est levé. La séquence et le timestamp continuent.
+    void restart() noexcept {
+        markNextPacket = true;
+        consecutiveFailures = 0;
+        backoffFrames = 0;
+    }
+
+    [[nodiscard]] uint32_t getSsrc() const noexcept { return ssrc; }
+    [[nodiscard]] uint16_t getNextSequenceNumber() const noexcept { return sequenceNumber; }
+    [[nodiscard]] uint64_t getSentPackets() const noexcept { return sentPackets; }
+    [[nodiscard]] uint64_t getDroppedPackets() const noexcept { return droppedPackets; }
+
+private:
+    void skip() noexcept {
+        ++sequenceNumber;
+        ++droppedPackets;
+    }
+
+    RtpHeaderTemplate header;
+    uint32_t ssrc;
+    uint16_t sequenceNumber;
+    uint32_t timestampOffset;
+    bool markNextPacket = true;
+    int consecutiveFailures = 0;
+    int backoffFrames = 0;
+    uint64_t sentPackets = 0;
+    uint64_t droppedPackets = 0;
+};
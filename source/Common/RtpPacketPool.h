@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "OpusEncoderWrapper.h"
+#include "RTPWrapper.h"
+
+// En-tête RTP de 12 octets précalculé (version, type de charge, SSRC) : seuls le numéro de séquence,
+// le timestamp et le bit marker sont réécrits en place pour chaque paquet.
+class RtpHeaderTemplate {
+public:
+    static constexpr size_t size = RtpPacketView::minHeaderSize;
+
+    RtpHeaderTemplate(const uint8_t payloadType, const uint32_t ssrc) noexcept {
+        bytes[0] = static_cast<uint8_t>((RTP_VERSION << 6) | (PADDING << 5) | (EXTENSION << 4) | CC);
+        bytes[1] = static_cast<uint8_t>(payloadType & 0x7F);
+        writeUInt32(bytes.data() + 8, ssrc);
+    }
+
+    void write(unsigned char* destination, const uint16_t sequenceNumber, const uint32_t timestamp,
+               const bool marker = false) const noexcept {
+        std::memcpy(destination, bytes.data(), size);
+        if (marker) {
+            destination[1] |= 0x80;
+        }
+        destination[2] = static_cast<unsigned char>(sequenceNumber >> 8);
+        destination[3] = static_cast<unsigned char>(sequenceNumber & 0xFF);
+        writeUInt32(destination + 4, timestamp);
+    }
+
+private:
+    static void writeUInt32(unsigned char* destination, const uint32_t value) noexcept {
+        destination[0] = static_cast<unsigned char>(value >> 24);
+        destination[1] = static_cast<unsigned char>((value >> 16) & 0xFF);
+        destination[2] = static_cast<unsigned char>((value >> 8) & 0xFF);
+        destination[3] = static_cast<unsigned char>(value & 0xFF);
+    }
+
+    std::array<unsigned char, size> bytes {};
+};
+
+// Paquet RTP à capacité fixe : l'encodeur Opus écrit directement après l'emplacement réservé à l'en-tête,
+// il n'y a donc ni copie de la charge utile ni allocation.
+struct RtpPacketBuffer {
+    static constexpr size_t capacity = RtpHeaderTemplate::size + MAX_OPUS_PACKET_SIZE;
+
+    std::array<unsigned char, capacity> data {};
+    size_t size = 0;
+
+    [[nodiscard]] unsigned char* payload() noexcept { return data.data() + RtpHeaderTemplate::size; }
+    [[nodiscard]] static constexpr int maxPayloadSize() noexcept { return static_cast<int>(MAX_OPUS_PACKET_SIZE); }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+        return std::as_bytes(std::span(data.data(), size));
+    }
+};
+
+// Réserve circulaire de paquets préalloués, utilisée par un seul thread (l'encodeur).
+// Un paquet reste valide jusqu'à ce que numPackets autres paquets aient été pris ; l'envoi par
+// libdatachannel copiant le paquet, il peut être réutilisé dès le retour de send().
+template <size_t numPackets>
+class RtpPacketPool {
+public:
+    static_assert(numPackets > 0);
+
+    RtpPacketBuffer& acquire() noexcept {
+        auto& packet = packets[next];
+        next = (next + 1) % numPackets;
+        packet.size = 0;
+        return packet;
+    }
+
+    // Encode une trame directement dans le prochain paquet, en-tête laissé à compléter par chaque sortie.
+    // nullptr si l'encodeur n'a rien produit.
+    RtpPacketBuffer* encode(const OpusEncoderWrapper& encoder, const float* frame, const int numFrameSamples) noexcept {
+        auto& packet = acquire();
+        const int payloadSize = encoder.encodeInto(frame, numFrameSamples, packet.payload(), RtpPacketBuffer::maxPayloadSize());
+        if (payloadSize <= 0) {
+            return nullptr;
+        }
+        packet.size = RtpHeaderTemplate::size + static_cast<size_t>(payloadSize);
+        return &packet;
+    }
+
+private:
+    std::array<RtpPacketBuffer, numPackets> packets {};
+    size_t next = 0;
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+
+// Suivi des numéros de séquence RTP d'un flux (RFC 3550, annexe A.1) :
+// extension 16 -> 64 bits avec repli, détection des doublons sur une fenêtre glissante,
+// détection d'un redémarrage du flux et statistiques de perte et de réordonnancement.
+// update() n'est appelé que depuis le thread réseau ; les statistiques peuvent être lues depuis n'importe quel thread.
+class RtpSequenceTracker
+{
+public:
+    enum class Result
+    {
+        Accepted, // premier exemplaire de ce paquet
+        Duplicate, // déjà reçu
+        Invalid, // saut de séquence en attente de confirmation
+        Restarted // nouveau flux (SSRC différent ou saut confirmé) : l'état a été réinitialisé
+    };
+
+    struct Statistics
+    {
+        uint64_t received = 0;
+        uint64_t duplicates = 0;
+        uint64_t reordered = 0;
+        uint64_t lost = 0;
+    };
+
+    // Un paquet en retard de plus de maxMisorder est traité comme un saut, la fenêtre des doublons le couvre donc entièrement
+    static constexpr int64_t maxDropout = 3000;
+    static constexpr int64_t maxMisorder = 100;
+    static constexpr int reorderWindow = 128;
+    static_assert(reorderWindow > maxMisorder);
+
+    // Renvoie le résultat et, sauf pour Invalid, écrit la séquence étendue dans extendedSequence
+    Result update(const uint16_t sequenceNumber, const uint32_t ssrc, int64_t& extendedSequence) noexcept
+    {
+        if (highestSequence < 0 || ssrc != currentSsrc)
+        {
+            const bool isRestart = highestSequence >= 0;
+            start(sequenceNumber, ssrc);
+            extendedSequence = highestSequence;
+            return isRestart ? Result::Restarted : Result::Accepted;
+        }
+
+        // Séquence étendue la plus proche de la plus haute déjà reçue
+        const auto delta = static_cast<int16_t>(static_cast<uint16_t>(sequenceNumber - static_cast<uint16_t>(highestSequence)));
+        const int64_t sequence = highestSequence + delta;
+
+        if (delta > maxDropout || -delta > maxMisorder)
+        {
+            // Grand saut : on attend un second paquet consécutif pour confirmer un redémarrage de l'émetteur
+            if (sequenceNumber == badSequence)
+            {
+                start(sequenceNumber, ssrc);
+                extendedSequence = highestSequence;
+                return Result::Restarted;
+            }
+            badSequence = static_cast<uint16_t>(sequenceNumber + 1);
+            return Result::Invalid;
+        }
+
+        extendedSequence = sequence;
+        if (sequence > highestSequence)
+        {
+            const int64_t advance = sequence - highestSequence;
+            window = advance >= reorderWindow ? std::bitset<reorderWindow> {} : window << static_cast<size_t>(advance);
+            window.set(0);
+            highestSequence = sequence;
+            received.fetch_add(1, std::memory_order_relaxed);
+            highestStored.store(highestSequence, std::memory_order_relaxed);
+            return Result::Accepted;
+        }
+
+        const int64_t age = highestSequence - sequence;
+        if (window.test(static_cast<size_t>(age)))
+        {
+            duplicates.fetch_add(1, std::memory_order_relaxed);
+            return Result::Duplicate;
+        }
+
+        window.set(static_cast<size_t>(age));
+        received.fetch_add(1, std::memory_order_relaxed);
+        reordered.fetch_add(1, std::memory_order_relaxed);
+        return Result::Accepted;
+    }
+
+    [[nodiscard]] Statistics getStatistics() const noexcept
+    {
+        Statistics statistics;
+        statistics.received = received.load(std::memory_order_relaxed);
+        statistics.duplicates = duplicates.load(std::memory_order_relaxed);
+        statistics.reordered = reordered.load(std::memory_order_relaxed);
+
+        // Perte cumulée : paquets attendus depuis le début du flux moins paquets distincts reçus
+        const int64_t expected = highestStored.load(std::memory_order_relaxed) - baseStored.load(std::memory_order_relaxed) + 1;
+        if (expected > 0 && static_cast<uint64_t>(expected) > statistics.received)
+            statistics.lost = static_cast<uint64_t>(expected) - statistics.received;
+        return statistics;
+    }
+
+private:
+    void start(const uint16_t sequenceNumber, const uint32_t ssrc) noexcept
+    {
+        currentSsrc = ssrc;
+        highestSequence = sequenceNumber;
+        window.reset();
+        window.set(0);
+        badSequence = 0;
+
+        baseStored.store(highestSequence, std::memory_order_relaxed);
+        highestStored.store(highestSequence, std::memory_order_relaxed);
+        received.store(1, std::memory_order_relaxed);
+        duplicates.store(0, std::memory_order_relaxed);
+        reordered.store(0, std::memory_order_relaxed);
+    }
+
+    // État propre au thread réseau
+    int64_t highestSequence = -1;
+    uint32_t currentSsrc = 0;
+    uint16_t badSequence = 0;
+    std::bitset<reorderWindow> window; // bit i : séquence highestSequence - i reçue
+
+    // Copies lisibles depuis les autres threads
+    std::atomic<int64_t> baseStored { 0 };
+    std::atomic<int64_t> highestStored { -1 };
+    std::atomic<uint64_t> received { 0 };
+    std::atomic<uint64_t> duplicates { 0 };
+    std::atomic<uint64_t> reordered { 0 };
+};
@@ -0,0 +1,269 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <semaphore>
+#include <vector>
+
+// File circulaire d'échantillons float, un seul producteur / un seul consommateur, sans verrou.
+// Toute la mémoire est allouée dans prepare() : write() et read() n'allouent jamais et ne bloquent
+// jamais, ils peuvent donc être appelés depuis le thread audio.
+// Deux politiques en cas de file pleine : write() rejette le nouveau bloc, writeDropOldest() écrase
+// les échantillons les plus anciens pour borner la latence.
+// Le consommateur peut s'endormir dans waitForReady() : le producteur ne le réveille (un seul release
+// de sémaphore) que lorsque le seuil attendu est atteint, et ne fait rien de plus quand personne n'attend.
+class SpscAudioFifo
+{
+public:
+    SpscAudioFifo() = default;
+
+    SpscAudioFifo(const SpscAudioFifo&) = delete;
+    SpscAudioFifo& operator=(const SpscAudioFifo&) = delete;
+
+    // Alloue le tampon, jamais depuis le thread audio ni pendant qu'un producteur ou un consommateur est actif :
+    // l'ancien tampon est libéré. La capacité est arrondie à la puissance de 2 supérieure.
+    void prepare(const size_t minCapacity)
+    {
+        size_t newCapacity = 1;
+        while (newCapacity < minCapacity)
+            newCapacity <<= 1;
+
+        buffer.assign(newCapacity, 0.0f);
+        mask = newCapacity - 1;
+        reset();
+    }
+
+    // Vide la file. Ne doit pas être appelé pendant qu'un producteur ou un consommateur est actif.
+    void reset() noexcept
+    {
+        writePosition.store(0, std::memory_order_relaxed);
+        readPosition.store(0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+        underruns.store(0, std::memory_order_relaxed);
+        droppedSamples.store(0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t getCapacity() const noexcept { return buffer.size(); }
+
+    // Zone de stockage (getCapacity() échantillons), pour la verrouiller en mémoire (RealtimeThreads::LockedMemory)
+    [[nodiscard]] const float* getStorage() const noexcept { return buffer.data(); }
+
+    [[nodiscard]] size_t getNumReady() const noexcept
+    {
+        // Lecture chargée en premier : elle ne peut pas dépasser l'écriture chargée ensuite
+        const uint64_t read = readPosition.load(std::memory_order_acquire);
+        const uint64_t write = writePosition.load(std::memory_order_acquire);
+        return std::min(static_cast<size_t>(write - read), getCapacity());
+    }
+
+    [[nodiscard]] size_t getFreeSpace() const noexcept { return getCapacity() - getNumReady(); }
+
+    // Nombre d'écritures qui n'ont pas trouvé assez de place (bloc rejeté ou anciens échantillons écrasés)
+    [[nodiscard]] uint64_t getNumOverruns() const noexcept { return overruns.load(std::memory_order_relaxed); }
+
+    // Nombre de lectures qui n'ont pas obtenu tous les échantillons demandés
+    [[nodiscard]] uint64_t getNumUnderruns() const noexcept { return underruns.load(std::memory_order_relaxed); }
+
+    // Nombre d'échantillons écrasés par writeDropOldest()
+    [[nodiscard]] uint64_t getNumDroppedSamples() const noexcept { return droppedSamples.load(std::memory_order_relaxed); }
+
+    // Producteur : copie numSamples échantillons. Tout ou rien : si la place manque, le bloc est rejeté.
+    bool write(const float* source, const size_t numSamples) noexcept
+    {
+        const uint64_t write = writePosition.load(std::memory_order_relaxed);
+        const uint64_t read = readPosition.load(std::memory_order_acquire);
+        if (numSamples > getCapacity() - static_cast<size_t>(write - read))
+        {
+            overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        copyIn(write, source, numSamples);
+        writePosition.store(write + numSamples, std::memory_order_release);
+        notifyConsumer();
+        return true;
+    }
+
+    // Producteur : copie numSamples échantillons en écrasant les plus anciens si la place manque.
+    // Le producteur avance lui-même la position de lecture (CAS) avant d'écraser quoi que ce soit,
+    // le consommateur détecte alors que sa copie est invalide et recommence.
+    void writeDropOldest(const float* source, size_t numSamples) noexcept
+    {
+        if (numSamples > getCapacity())
+        {
+            // Seule la fin du bloc peut tenir dans la file
+            droppedSamples.fetch_add(numSamples - getCapacity(), std::memory_order_relaxed);
+            source += numSamples - getCapacity();
+            numSamples = getCapacity();
+        }
+        if (numSamples == 0)
+            return;
+
+        const uint64_t write = writePosition.load(std::memory_order_relaxed);
+        const uint64_t end = write + numSamples;
+        const uint64_t minimumRead = end > getCapacity() ? end - getCapacity() : 0;
+        uint64_t read = readPosition.load(std::memory_order_acquire);
+        bool dropped = false;
+        while (read < minimumRead)
+        {
+            if (readPosition.compare_exchange_weak(read, minimumRead, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                droppedSamples.fetch_add(minimumRead - read, std::memory_order_relaxed);
+                dropped = true;
+                break;
+            }
+        }
+        if (dropped)
+            overruns.fetch_add(1, std::memory_order_relaxed);
+
+        copyIn(write, source, numSamples);
+        writePosition.store(write + numSamples, std::memory_order_release);
+        notifyConsumer();
+    }
+
+    // Producteur : entrelace directement les canaux séparés (L, R, L, R...) dans la file, sans tampon intermédiaire.
+    bool writeInterleaved(const float* const* channels, const int numChannels, const int numFrames) noexcept
+    {
+        const auto numSamples = static_cast<size_t>(numChannels) * static_cast<size_t>(numFrames);
+        const uint64_t write = writePosition.load(std::memory_order_relaxed);
+        const uint64_t read = readPosition.load(std::memory_order_acquire);
+        if (numSamples > getCapacity() - static_cast<size_t>(write - read))
+        {
+            overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        float* data = buffer.data();
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* source = channels[channel];
+            size_t position = (static_cast<size_t>(write) + static_cast<size_t>(channel)) & mask;
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                data[position] = source[frame];
+                position = (position + static_cast<size_t>(numChannels)) & mask;
+            }
+        }
+
+        writePosition.store(write + numSamples, std::memory_order_release);
+        notifyConsumer();
+        return true;
+    }
+
+    // Consommateur : copie au plus numSamples échantillons dans destination.
+    // Renvoie le nombre d'échantillons effectivement lus ; une lecture incomplète compte comme un underrun.
+    size_t read(float* destination, const size_t numSamples) noexcept
+    {
+        uint64_t read = readPosition.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const uint64_t write = writePosition.load(std::memory_order_acquire);
+            if (write - read > getCapacity())
+            {
+                // writeDropOldest() a déjà écrasé cette position : on repart de la nouvelle
+                read = readPosition.load(std::memory_order_acquire);
+                continue;
+            }
+            const size_t toRead = std::min(numSamples, static_cast<size_t>(write - read));
+            if (toRead < numSamples)
+                underruns.fetch_add(1, std::memory_order_relaxed);
+            if (toRead == 0)
+                return 0;
+
+            const size_t start = static_cast<size_t>(read) & mask;
+            const size_t firstPart = std::min(toRead, getCapacity() - start);
+            std::memcpy(destination, buffer.data() + start, firstPart * sizeof(float));
+            std::memcpy(destination + firstPart, buffer.data(), (toRead - firstPart) * sizeof(float));
+
+            // Échec uniquement si writeDropOldest() a avancé la lecture pendant la copie : on relit
+            if (readPosition.compare_exchange_strong(read, read + toRead, std::memory_order_acq_rel, std::memory_order_acquire))
+                return toRead;
+        }
+    }
+
+    // Consommateur : abandonne au plus numSamples échantillons (ex. données périmées au démarrage du flux).
+    size_t discard(const size_t numSamples) noexcept
+    {
+        uint64_t read = readPosition.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const uint64_t write = writePosition.load(std::memory_order_acquire);
+            if (write - read > getCapacity())
+            {
+                read = readPosition.load(std::memory_order_acquire);
+                continue;
+            }
+            const size_t toDiscard = std::min(numSamples, static_cast<size_t>(write - read));
+            if (readPosition.compare_exchange_strong(read, read + toDiscard, std::memory_order_acq_rel, std::memory_order_acquire))
+                return toDiscard;
+        }
+    }
+
+    // Consommateur : attend qu'au moins numSamples échantillons soient prêts, au plus jusqu'à deadline.
+    // Renvoie true si les échantillons sont disponibles. Ne doit pas être appelé depuis le thread audio.
+    template <typename Clock, typename Duration>
+    bool waitForReady(const size_t numSamples, const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        while (getNumReady() < numSamples)
+        {
+            // Le seuil est publié avant de revérifier : soit le producteur le voit, soit on voit ses échantillons
+            wakeThreshold.store(numSamples, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (getNumReady() >= numSamples)
+            {
+                disarmWakeup(numSamples);
+                return true;
+            }
+
+            if (! dataReady.try_acquire_until(deadline))
+            {
+                disarmWakeup(numSamples);
+                return getNumReady() >= numSamples;
+            }
+        }
+        return true;
+    }
+
+private:
+    // Producteur : un seul release par attente armée, jamais quand le consommateur ne dort pas
+    void notifyConsumer() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_t threshold = wakeThreshold.load(std::memory_order_seq_cst);
+        if (threshold != 0 && getNumReady() >= threshold
+            && wakeThreshold.compare_exchange_strong(threshold, 0, std::memory_order_acq_rel))
+            dataReady.release();
+    }
+
+    // Consommateur : retire le seuil ; si le producteur l'a déjà consommé, son release est imminent et doit être absorbé
+    void disarmWakeup(size_t threshold) noexcept
+    {
+        if (! wakeThreshold.compare_exchange_strong(threshold, 0, std::memory_order_acq_rel))
+            dataReady.acquire();
+    }
+
+    void copyIn(const uint64_t write, const float* source, const size_t numSamples) noexcept
+    {
+        const size_t start = static_cast<size_t>(write) & mask;
+        const size_t firstPart = std::min(numSamples, getCapacity() - start);
+        std::memcpy(buffer.data() + start, source, firstPart * sizeof(float));
+        std::memcpy(buffer.data(), source + firstPart, (numSamples - firstPart) * sizeof(float));
+    }
+
+    std::vector<float> buffer;
+    size_t mask = 0;
+
+    // Positions monotones (jamais repliées), séparées sur des lignes de cache distinctes
+    alignas(64) std::atomic<uint64_t> writePosition { 0 };
+    alignas(64) std::atomic<uint64_t> readPosition { 0 };
+    std::atomic<uint64_t> overruns { 0 };
+    std::atomic<uint64_t> underruns { 0 };
+    std::atomic<uint64_t> droppedSamples { 0 };
+
+    // Seuil de réveil du consommateur endormi (0 : personne n'attend)
+    std::atomic<size_t> wakeThreshold { 0 };
+    std::binary_semaphore dataReady { 0 };
+};
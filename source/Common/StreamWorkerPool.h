@@ -0,0 +1,458 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "RealtimeThreads.h"
+
+// Réserve de threads commune au processus pour l'encodage et la réception de toutes les instances du plugin.
+// Chaque flux (encodeur d'un MeloVSTSend, lecture du transport local d'un MeloVSTReceive...) s'enregistre et
+// reçoit une poignée (Stream) ; son travail est une tâche courte, jamais bloquante, qui indique elle-même
+// quand elle doit repasser. Huit instances ne font donc plus huit threads presque toujours endormis.
+//
+// - Le nombre de threads suit le nombre de flux, plafonné au nombre de cœurs.
+// - Chaque thread a sa file ; parmi les tâches prêtes, il prend celle dont l'échéance est la plus proche
+//   (earliest deadline first), et vole celle d'un autre thread quand la sienne est vide.
+// - Les exécutions d'un même flux ne se chevauchent jamais : sa tâche garde un état sans verrou.
+// - Une tâche terminée après son échéance compte comme un retard (getNumDeadlineMisses).
+// - Avec realtimeWorkers, chaque thread demande au démarrage une priorité temps réel et un cœur dédié
+//   (RealtimeThreads) ; ce qu'il a obtenu est rapporté par getThreadReports().
+// - La réserve partagée (acquireShared) est tenue par les poignées de ses flux : créée avec le premier,
+//   arrêtée avec le dernier, sur le thread qui le retire, jamais pendant la destruction des statiques ou le
+//   déchargement du plugin.
+class StreamWorkerPool : public std::enable_shared_from_this<StreamWorkerPool>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Prochaine exécution d'un flux : pas avant releaseTime, terminée si possible avant deadline
+    struct Run
+    {
+        Clock::time_point releaseTime;
+        Clock::time_point deadline;
+    };
+
+    // Renvoie la prochaine exécution, ou std::nullopt pour attendre le prochain schedule()
+    using Job = std::function<std::optional<Run>()>;
+
+private:
+    struct StreamState
+    {
+        explicit StreamState(Job streamJob) : job(std::move(streamJob)) {}
+
+        Job job;
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool registered = true;
+        bool running = false;
+        // schedule() pendant une exécution : retenu pour la fin de celle-ci
+        std::optional<Run> pendingRun;
+        // Les entrées des files d'une génération précédente sont périmées (reprogrammation, retrait)
+        uint64_t generation = 0;
+        int homeWorker = 0;
+
+        std::atomic<uint64_t> runs { 0 };
+        std::atomic<uint64_t> deadlineMisses { 0 };
+    };
+
+public:
+    // Poignée d'un flux enregistré ; le retire à sa destruction
+    class Stream
+    {
+    public:
+        Stream() = default;
+        Stream(Stream&&) noexcept = default;
+        Stream& operator=(Stream&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                pool = other.pool;
+                state = std::move(other.state);
+                sharedPool = std::move(other.sharedPool);
+            }
+            return *this;
+        }
+        ~Stream() { reset(); }
+
+        Stream(const Stream&) = delete;
+        Stream& operator=(const Stream&) = delete;
+
+        // Demande une exécution ; une demande faite pendant l'exécution en cours est servie juste après
+        void schedule(const Run run)
+        {
+            if (pool != nullptr && state != nullptr)
+                pool->schedule(state, run);
+        }
+
+        void scheduleNow(const Clock::duration budget)
+        {
+            const auto now = Clock::now();
+            schedule({ now, now + budget });
+        }
+
+        // Retire le flux : attend la fin de l'exécution en cours, aucune ne démarre ensuite.
+        // Jamais depuis une tâche de la réserve : la dernière poignée y arrêterait ses threads.
+        void reset()
+        {
+            if (state == nullptr)
+                return;
+            {
+                std::unique_lock lock(state->mutex);
+                state->registered = false;
+                state->pendingRun.reset();
+                ++state->generation;
+                state->finished.wait(lock, [this] { return ! state->running; });
+            }
+            pool->unregisterStream();
+            state.reset();
+            pool = nullptr;
+            // Dernière poignée de la réserve partagée : ses threads sont arrêtés ici
+            sharedPool.reset();
+        }
+
+        [[nodiscard]] bool isRegistered() const noexcept { return state != nullptr; }
+        [[nodiscard]] uint64_t getNumRuns() const noexcept { return state != nullptr ? state->runs.load(std::memory_order_acquire) : 0; }
+        [[nodiscard]] uint64_t getNumDeadlineMisses() const noexcept
+        {
+            return state != nullptr ? state->deadlineMisses.load(std::memory_order_relaxed) : 0;
+        }
+
+    private:
+        friend class StreamWorkerPool;
+        Stream(StreamWorkerPool& owner, std::shared_ptr<StreamState> streamState)
+            : pool(&owner), state(std::move(streamState)), sharedPool(owner.weak_from_this().lock()) {}
+
+        StreamWorkerPool* pool = nullptr;
+        std::shared_ptr<StreamState> state;
+        // Nul pour une réserve qui n'appartient pas à un shared_ptr (tests)
+        std::shared_ptr<StreamWorkerPool> sharedPool;
+    };
+
+    // Réserve du processus, créée à la demande (jamais pendant le scan des plugins) et partagée tant qu'une
+    // poignée ou un appelant la tient. La dernière référence est relâchée par les services qui possèdent les
+    // flux, sur leur propre thread, jamais depuis une tâche : la réserve y attend la fin de ses threads.
+    static std::shared_ptr<StreamWorkerPool> acquireShared()
+    {
+        static std::mutex sharedMutex;
+        static std::weak_ptr<StreamWorkerPool> shared;
+
+        const std::lock_guard lock(sharedMutex);
+        if (auto pool = shared.lock())
+            return pool;
+        auto pool = std::make_shared<StreamWorkerPool>(getDefaultMaxThreads(), true);
+        shared = pool;
+        return pool;
+    }
+
+    static int getDefaultMaxThreads() noexcept { return std::max(1, static_cast<int>(std::thread::hardware_concurrency())); }
+
+    explicit StreamWorkerPool(const int maxThreadCount = getDefaultMaxThreads(), const bool realtimeWorkers = false)
+        : maxThreads(std::max(1, maxThreadCount)), realtime(realtimeWorkers)
+    {
+        // Files créées d'avance : les threads, démarrés à la demande, les parcourent sans verrou global
+        queues.reserve(static_cast<size_t>(maxThreads));
+        for (int i = 0; i < maxThreads; ++i)
+            queues.push_back(std::make_unique<WorkerQueue>());
+        threads.reserve(static_cast<size_t>(maxThreads));
+        threadReports.resize(static_cast<size_t>(maxThreads));
+    }
+
+    // Attend ses threads : jamais depuis l'un d'eux (une tâche qui relâcherait la dernière poignée)
+    ~StreamWorkerPool()
+    {
+        assert(! isWorkerThread());
+        {
+            const std::lock_guard lock(sleepMutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& thread: threads)
+            thread.join();
+    }
+
+    StreamWorkerPool(const StreamWorkerPool&) = delete;
+    StreamWorkerPool& operator=(const StreamWorkerPool&) = delete;
+
+    // Enregistre un flux, sans l'exécuter : la première exécution est demandée par Stream::schedule()
+    Stream registerStream(Job job)
+    {
+        auto state = std::make_shared<StreamState>(std::move(job));
+        {
+            const std::lock_guard lock(threadsMutex);
+            ++numStreams;
+            if (static_cast<int>(threads.size()) < std::min(maxThreads, numStreams))
+            {
+                const int index = static_cast<int>(threads.size());
+                threads.emplace_back(&StreamWorkerPool::workerLoop, this, index);
+                numActiveWorkers.store(index + 1, std::memory_order_release);
+            }
+            state->homeWorker = nextHomeWorker++ % numActiveWorkers.load(std::memory_order_relaxed);
+        }
+        return { *this, std::move(state) };
+    }
+
+    [[nodiscard]] int getNumThreads() const noexcept { return numActiveWorkers.load(std::memory_order_acquire); }
+    [[nodiscard]] int getMaxThreads() const noexcept { return maxThreads; }
+    // Appelé depuis l'un des threads de la réserve (une tâche) ?
+    [[nodiscard]] bool isWorkerThread() const
+    {
+        const std::lock_guard lock(threadsMutex);
+        return std::any_of(threads.begin(), threads.end(), [](const std::thread& thread) {
+            return thread.get_id() == std::this_thread::get_id();
+        });
+    }
+    // Tâches prises dans la file d'un autre thread
+    [[nodiscard]] uint64_t getNumSteals() const noexcept { return steals.load(std::memory_order_relaxed); }
+
+    // Réglages obtenus par chaque thread démarré (priorité, affinité) ; un thread qui vient de démarrer
+    // peut ne pas encore avoir appliqué les siens
+    [[nodiscard]] std::vector<RealtimeThreads::Report> getThreadReports() const
+    {
+        const std::lock_guard lock(threadsMutex);
+        return { threadReports.begin(), threadReports.begin() + static_cast<std::ptrdiff_t>(threads.size()) };
+    }
+
+private:
+    struct Entry
+    {
+        Run run;
+        uint64_t generation = 0;
+        std::shared_ptr<StreamState> stream;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+
+    void unregisterStream()
+    {
+        // Les threads restent démarrés : ils dorment sans coût et servent au prochain flux
+        const std::lock_guard lock(threadsMutex);
+        --numStreams;
+    }
+
+    void schedule(const std::shared_ptr<StreamState>& stream, const Run run)
+    {
+        {
+            const std::lock_guard lock(stream->mutex);
+            if (! stream->registered)
+                return;
+            if (stream->running)
+            {
+                if (! stream->pendingRun.has_value() || run.releaseTime < stream->pendingRun->releaseTime)
+                    stream->pendingRun = run;
+                return;
+            }
+            enqueue(stream, run);
+        }
+        notifyWorkers();
+    }
+
+    // stream->mutex tenu. L'entrée garde le flux en vie : une entrée périmée peut survivre à sa poignée.
+    void enqueue(const std::shared_ptr<StreamState>& stream, const Run run)
+    {
+        auto& queue = *queues[static_cast<size_t>(stream->homeWorker)];
+        const std::lock_guard lock(queue.mutex);
+        queue.entries.push_back({ run, ++stream->generation, stream });
+    }
+
+    void notifyWorkers()
+    {
+        {
+            const std::lock_guard lock(sleepMutex);
+            ++epoch;
+        }
+        wakeup.notify_one();
+    }
+
+    // Index de la tâche prête à l'échéance la plus proche dans une file, -1 si aucune ; queue.mutex tenu
+    static int findReady(const WorkerQueue& queue, const Clock::time_point now)
+    {
+        int best = -1;
+        for (size_t i = 0; i < queue.entries.size(); ++i)
+        {
+            const auto& entry = queue.entries[i];
+            if (entry.run.releaseTime <= now && (best < 0 || entry.run.deadline < queue.entries[static_cast<size_t>(best)].run.deadline))
+                best = static_cast<int>(i);
+        }
+        return best;
+    }
+
+    static Entry takeAt(WorkerQueue& queue, const int index)
+    {
+        auto entry = std::move(queue.entries[static_cast<size_t>(index)]);
+        queue.entries[static_cast<size_t>(index)] = std::move(queue.entries.back());
+        queue.entries.pop_back();
+        return entry;
+    }
+
+    std::optional<Entry> takeReady(const int self)
+    {
+        const auto now = Clock::now();
+        {
+            auto& own = *queues[static_cast<size_t>(self)];
+            const std::lock_guard lock(own.mutex);
+            if (const int index = findReady(own, now); index >= 0)
+                return takeAt(own, index);
+        }
+
+        // File vide : vol de la tâche prête la plus urgente des autres threads
+        const int numWorkers = numActiveWorkers.load(std::memory_order_acquire);
+        int victim = -1;
+        Clock::time_point victimDeadline;
+        for (int offset = 1; offset < numWorkers; ++offset)
+        {
+            const int other = (self + offset) % numWorkers;
+            auto& queue = *queues[static_cast<size_t>(other)];
+            const std::lock_guard lock(queue.mutex);
+            if (const int index = findReady(queue, now); index >= 0)
+            {
+                const auto deadline = queue.entries[static_cast<size_t>(index)].run.deadline;
+                if (victim < 0 || deadline < victimDeadline)
+                {
+                    victim = other;
+                    victimDeadline = deadline;
+                }
+            }
+        }
+        if (victim < 0)
+            return std::nullopt;
+
+        auto& queue = *queues[static_cast<size_t>(victim)];
+        const std::lock_guard lock(queue.mutex);
+        const int index = findReady(queue, now);
+        if (index < 0)
+            return std::nullopt;
+        steals.fetch_add(1, std::memory_order_relaxed);
+        return takeAt(queue, index);
+    }
+
+    // Prochaine tâche à devenir prête, toutes files confondues
+    std::optional<Clock::time_point> getNextReleaseTime()
+    {
+        std::optional<Clock::time_point> next;
+        const int numWorkers = numActiveWorkers.load(std::memory_order_acquire);
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            auto& queue = *queues[static_cast<size_t>(i)];
+            const std::lock_guard lock(queue.mutex);
+            for (const auto& entry: queue.entries)
+            {
+                if (! next.has_value() || entry.run.releaseTime < *next)
+                    next = entry.run.releaseTime;
+            }
+        }
+        return next;
+    }
+
+    void run(const Entry& entry, const int self)
+    {
+        auto& stream = *entry.stream;
+        {
+            const std::lock_guard lock(stream.mutex);
+            // Entrée périmée (flux reprogrammé ou retiré depuis)
+            if (! stream.registered || stream.running || entry.generation != stream.generation)
+                return;
+            stream.running = true;
+            // Le flux reste sur le thread qui l'exécute : ses données sont déjà dans ce cache
+            stream.homeWorker = self;
+        }
+
+        auto next = stream.job();
+        if (Clock::now() > entry.run.deadline)
+            stream.deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+        stream.runs.fetch_add(1, std::memory_order_release);
+
+        bool scheduled = false;
+        {
+            const std::lock_guard lock(stream.mutex);
+            stream.running = false;
+            if (stream.pendingRun.has_value() && (! next.has_value() || stream.pendingRun->releaseTime < next->releaseTime))
+                next = stream.pendingRun;
+            stream.pendingRun.reset();
+            if (stream.registered && next.has_value())
+            {
+                enqueue(entry.stream, *next);
+                scheduled = true;
+            }
+            stream.finished.notify_all();
+        }
+        if (scheduled)
+            notifyWorkers();
+    }
+
+    void promoteWorker(const int self)
+    {
+        RealtimeThreads::Report report;
+        if (realtime)
+        {
+            // Un cœur autorisé par thread (cpuset compris), en partant du dernier
+            RealtimeThreads::Options options;
+            options.cpu = RealtimeThreads::getWorkerCpu(self);
+            report = RealtimeThreads::promoteCurrentThread(options);
+        }
+        const std::lock_guard lock(threadsMutex);
+        threadReports[static_cast<size_t>(self)] = report;
+    }
+
+    void workerLoop(const int self)
+    {
+        promoteWorker(self);
+        for (;;)
+        {
+            uint64_t seenEpoch = 0;
+            {
+                const std::lock_guard lock(sleepMutex);
+                if (stopping)
+                    return;
+                seenEpoch = epoch;
+            }
+
+            if (const auto entry = takeReady(self))
+            {
+                run(*entry, self);
+                continue;
+            }
+
+            // Rien de prêt : sommeil jusqu'à la prochaine échéance de mise à disposition ou un nouveau schedule()
+            const auto nextRelease = getNextReleaseTime();
+            std::unique_lock lock(sleepMutex);
+            const auto predicate = [this, seenEpoch] { return stopping || epoch != seenEpoch; };
+            if (nextRelease.has_value())
+                wakeup.wait_until(lock, *nextRelease, predicate);
+            else
+                wakeup.wait(lock, predicate);
+        }
+    }
+
+    const int maxThreads;
+    const bool realtime;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    mutable std::mutex threadsMutex;
+    std::vector<std::thread> threads;
+    std::vector<RealtimeThreads::Report> threadReports;
+    int numStreams = 0;
+    int nextHomeWorker = 0;
+    std::atomic<int> numActiveWorkers { 0 };
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    uint64_t epoch = 0;
+    bool stopping = false;
+
+    std::atomic<uint64_t> steals { 0 };
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <vector>
+#include <r8brain/CDSPResampler.h>
+
+// Rééchantillonneur multicanal en continu, bâti sur r8brain : un filtre (et donc un état) par canal,
+// conservé d'un bloc à l'autre pour éviter toute discontinuité aux frontières.
+// Toute la mémoire est allouée dans prepare() ; process() n'alloue jamais.
+// r8brain ne travaille qu'en double : la conversion se fait dans des tampons préalloués, canal par canal,
+// pendant le désentrelacement. Si les deux fréquences sont égales, les échantillons sont simplement copiés.
+class StreamingResampler
+{
+public:
+    StreamingResampler() = default;
+
+    StreamingResampler(const StreamingResampler&) = delete;
+    StreamingResampler& operator=(const StreamingResampler&) = delete;
+
+    // maxInputFrames : nombre maximal de trames (échantillons par canal) passées à chaque appel de process()
+    void prepare(const double sourceRate, const double targetRate, const int channels, const int maxInputFrames)
+    {
+        sourceSampleRate = sourceRate;
+        targetSampleRate = targetRate;
+        numChannels = channels;
+        maxInput = maxInputFrames;
+
+        resamplers.clear();
+        if (sourceRate != targetRate)
+        {
+            for (int channel = 0; channel < channels; ++channel)
+                resamplers.push_back(std::make_unique<r8b::CDSPResampler24>(sourceRate, targetRate, maxInputFrames));
+        }
+
+        maxOutput = resamplers.empty() ? maxInputFrames : resamplers.front()->getMaxOutLen(maxInputFrames);
+        channelInput.assign(static_cast<size_t>(maxInputFrames), 0.0);
+        channelOutput.assign(static_cast<size_t>(channels) * static_cast<size_t>(maxOutput), 0.0f);
+        channelPointers.assign(static_cast<size_t>(channels), nullptr);
+        for (int channel = 0; channel < channels; ++channel)
+            channelPointers[static_cast<size_t>(channel)] = channelOutput.data() + static_cast<size_t>(channel) * static_cast<size_t>(maxOutput);
+    }
+
+    // Vide l'état des filtres (nouveau flux)
+    void reset() noexcept
+    {
+        for (auto& resampler : resamplers)
+            resampler->clear();
+    }
+
+    [[nodiscard]] int getNumChannels() const noexcept { return numChannels; }
+    [[nodiscard]] int getMaxInputFrames() const noexcept { return maxInput; }
+
+    // Nombre maximal de trames écrites par un appel à process() avec maxInputFrames trames
+    [[nodiscard]] int getMaxOutputFrames() const noexcept { return maxOutput; }
+
+    // Retard de groupe exact, en trames à la fréquence de destination. r8brain retire lui-même ce retard
+    // du début du flux : il correspond aux trames d'entrée consommées avant que la première ne sorte.
+    [[nodiscard]] double getLatencyFrames() const noexcept
+    {
+        if (resamplers.empty())
+            return 0.0;
+        return resamplers.front()->getInLenBeforeOutPos(0) * targetSampleRate / sourceSampleRate;
+    }
+
+    [[nodiscard]] double getLatencySeconds() const noexcept { return getLatencyFrames() / targetSampleRate; }
+
+    // Entrée entrelacée (numFrames trames), sortie désentrelacée dans les canaux fournis par l'appelant,
+    // chacun d'au moins getMaxOutputFrames() échantillons. Renvoie le nombre de trames écrites par canal.
+    int process(const float* interleavedInput, int numFrames, const std::span<float* const> outputChannels) noexcept
+    {
+        numFrames = std::min(numFrames, maxInput);
+        const auto channels = std::min(static_cast<int>(outputChannels.size()), numChannels);
+        int numOutput = 0;
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            float* output = outputChannels[static_cast<size_t>(channel)];
+            if (resamplers.empty())
+            {
+                for (int frame = 0; frame < numFrames; ++frame)
+                    output[frame] = interleavedInput[frame * numChannels + channel];
+                numOutput = numFrames;
+                continue;
+            }
+
+            for (int frame = 0; frame < numFrames; ++frame)
+                channelInput[static_cast<size_t>(frame)] = interleavedInput[frame * numChannels + channel];
+
+            double* resampled = nullptr;
+            numOutput = resamplers[static_cast<size_t>(channel)]->process(channelInput.data(), numFrames, resampled);
+            std::transform(resampled, resampled + numOutput, output, [](const double sample) { return static_cast<float>(sample); });
+        }
+        return numOutput;
+    }
+
+    // Entrée et sortie entrelacées (ex. pour l'encodeur Opus) ; interleavedOutput doit contenir
+    // au moins getMaxOutputFrames() * getNumChannels() échantillons. Renvoie le nombre de trames écrites.
+    int processInterleaved(const float* interleavedInput, const int numFrames, const std::span<float> interleavedOutput) noexcept
+    {
+        const int numOutput = process(interleavedInput, numFrames, channelPointers);
+        const auto writableFrames = static_cast<int>(interleavedOutput.size()) / std::max(numChannels, 1);
+        const int numWritten = std::min(numOutput, writableFrames);
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* source = channelPointers[static_cast<size_t>(channel)];
+            for (int frame = 0; frame < numWritten; ++frame)
+                interleavedOutput[static_cast<size_t>(frame * numChannels + channel)] = source[frame];
+        }
+        return numWritten;
+    }
+
+private:
+    double sourceSampleRate = 48000.0;
+    double targetSampleRate = 48000.0;
+    int numChannels = 0;
+    int maxInput = 0;
+    int maxOutput = 0;
+
+    std::vector<std::unique_ptr<r8b::CDSPResampler24>> resamplers;
+    std::vector<double> channelInput;
+    std::vector<float> channelOutput;
+    std::vector<float*> channelPointers;
+};
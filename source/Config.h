@@ -1,14 +1,103 @@
 #pragma once
 #include <juce_gui_basics/juce_gui_basics.h>
+#include <mutex>
+
+#ifndef MELO_ALLOW_SERVER_OVERRIDE
+ #define MELO_ALLOW_SERVER_OVERRIDE 0
+#endif
 
 namespace Config
 {
     // URL de l'API
-    // static const juce::String apiUrl = "http://localhost:5055/api";
-    // static const juce::String websocketUrl = "ws://localhost:5055";
+    // Serveur local de test (tools/LocalServer) : MELO_API_URL=http://localhost:5055/api MELO_WEBSOCKET_URL=ws://localhost:5055
     static const juce::String apiUrl = "https://staging.studio-melo.com/api";
     static const juce::String websocketUrl = "wss://staging.studio-melo.com";
 
+    // Serveur réellement utilisé : staging par défaut, remplacé par les variables d'environnement MELO_API_URL
+    // et MELO_WEBSOCKET_URL, ou par setServerUrls() (tests et benchmarks qui démarrent leur propre serveur).
+    // Le jeton d'accès part vers ce serveur : hors des cibles de développement (MELO_ALLOW_SERVER_OVERRIDE,
+    // défini pour le serveur local, les tests et les benchmarks), seul un serveur local est accepté
+    struct ServerUrls
+    {
+        juce::String apiUrl;
+        juce::String websocketUrl;
+    };
+
+    // Hôte localhost, 127.x.x.x ou ::1
+    inline bool isLoopbackUrl(const juce::String& url)
+    {
+        auto host = url.fromFirstOccurrenceOf("://", false, false)
+                        .upToFirstOccurrenceOf("/", false, false)
+                        .fromLastOccurrenceOf("@", false, false);
+        if (host.startsWithChar('['))
+            host = host.fromFirstOccurrenceOf("[", false, false).upToFirstOccurrenceOf("]", false, false);
+        else
+            host = host.upToFirstOccurrenceOf(":", false, false);
+
+        return host.equalsIgnoreCase("localhost") || host == "::1"
+            || (host.startsWith("127.") && host.containsOnly("0123456789."));
+    }
+
+    inline bool isStagingServer(const ServerUrls& urls)
+    {
+        return urls.apiUrl == apiUrl && urls.websocketUrl == websocketUrl;
+    }
+
+    inline bool isServerOverrideAllowed(const ServerUrls& urls)
+    {
+#if MELO_ALLOW_SERVER_OVERRIDE
+        juce::ignoreUnused(urls);
+        return true;
+#else
+        return isLoopbackUrl(urls.apiUrl) && isLoopbackUrl(urls.websocketUrl);
+#endif
+    }
+
+    namespace Detail
+    {
+        inline std::mutex& getServerUrlsMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        inline ServerUrls getServerUrlsFromEnvironment()
+        {
+            const ServerUrls urls {
+                juce::SystemStats::getEnvironmentVariable("MELO_API_URL", apiUrl),
+                juce::SystemStats::getEnvironmentVariable("MELO_WEBSOCKET_URL", websocketUrl)
+            };
+            if (isStagingServer(urls) || isServerOverrideAllowed(urls))
+                return urls;
+            juce::Logger::outputDebugString("MELO_API_URL / MELO_WEBSOCKET_URL ignored: not a local server");
+            return { apiUrl, websocketUrl };
+        }
+
+        // getServerUrlsMutex() doit être tenu
+        inline ServerUrls& getServerUrls()
+        {
+            static ServerUrls urls = getServerUrlsFromEnvironment();
+            return urls;
+        }
+    }
+
+    inline ServerUrls getServerUrls()
+    {
+        const std::lock_guard lock(Detail::getServerUrlsMutex());
+        return Detail::getServerUrls();
+    }
+
+    // Pris en compte à la prochaine requête et à la prochaine connexion WebSocket ; false (et rien de changé)
+    // si le serveur n'est pas accepté
+    inline bool setServerUrls(const ServerUrls& urls)
+    {
+        if (!isStagingServer(urls) && !isServerOverrideAllowed(urls))
+            return false;
+        const std::lock_guard lock(Detail::getServerUrlsMutex());
+        Detail::getServerUrls() = urls;
+        return true;
+    }
+
     // Couleurs
     static const auto primaryColor = juce::Colour(0xFF1A1A1A);
     static const juce::Colour gray900 = juce::Colour::fromFloatRGBA(12, 17, 29, 1.0f);
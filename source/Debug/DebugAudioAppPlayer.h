@@ -2,22 +2,22 @@
 #include "DebugAudioAppPlayer.h"
 #include <juce_audio_utils/juce_audio_utils.h>
 #include <deque>
-#include "../Common/EventListener.h"
 #include "../Common/EventManager.h"
 
-class DebugAudioAppPlayer final : public juce::AudioAppComponent, public EventListener
+class DebugAudioAppPlayer final : public juce::AudioAppComponent
 {
 public:
-    DebugAudioAppPlayer()
+    explicit DebugAudioAppPlayer(EventManager& eventManager)
     {
         setAudioChannels(0, 2); // 0 entrées, 2 sorties
-        EventManager::getInstance().addListener(this);
+        decodedBlockSubscription = eventManager.subscribe<AudioBlockReceivedDecodedEvent>(
+            [this](const AudioBlockReceivedDecodedEvent &event) { onAudioBlockReceivedDecoded(event); });
     }
 
     ~DebugAudioAppPlayer() override
     {
+        decodedBlockSubscription.reset();
         shutdownAudio();
-        EventManager::getInstance().removeListener(this);
     }
 
     void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override
@@ -99,4 +99,5 @@ private:
     std::vector<float> currentBlock;
     size_t currentSampleIndex = 0;
     double currentSampleRate = 0;
+    EventSubscription decodedBlockSubscription;
 };
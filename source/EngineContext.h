@@ -0,0 +1,30 @@
+#pragma once
+
+#include "AudioSettings.h"
+#include "Common/EventManager.h"
+#include "Api/AuthService.h"
+
+// Contexte propre à une instance du plugin : réglages audio, bus d'événements et services.
+// Détenu par MainAudioProcessor et transmis par référence à tout ce qui en a besoin, si bien que
+// plusieurs instances d'un même hôte (ex. batterie, basse et claviers) diffusent indépendamment.
+// Restent communs au processus JuceLocalStorage (le jeton de connexion est celui de l'utilisateur) et la
+// réserve de threads d'encodage et de réception (StreamWorkerPool), où chaque instance enregistre ses flux.
+class EngineContext
+{
+public:
+    EngineContext() = default;
+
+    EngineContext(const EngineContext&) = delete;
+    EngineContext& operator=(const EngineContext&) = delete;
+
+    [[nodiscard]] AudioSettings& getAudioSettings() noexcept { return audioSettings; }
+    [[nodiscard]] const AudioSettings& getAudioSettings() const noexcept { return audioSettings; }
+    [[nodiscard]] EventManager& getEventManager() noexcept { return eventManager; }
+    [[nodiscard]] AuthService& getAuthService() noexcept { return authService; }
+
+private:
+    AudioSettings audioSettings;
+    EventManager eventManager;
+    // Publie connexion et déconnexion sur le bus de cette instance
+    AuthService authService { eventManager };
+};
@@ -3,7 +3,7 @@
 //
 #include "LoginPageComponent.h"
 
-LoginPageComponent::LoginPageComponent() {
+LoginPageComponent::LoginPageComponent(AuthService& authService): authService(authService) {
     setSize(600, 400);
     addAndMakeVisible(title);
     addAndMakeVisible(usernameLabel);
@@ -68,7 +68,7 @@ void LoginPageComponent::resized() {
 }
 
 void LoginPageComponent::onLoginButtonClick() {
-    if (const auto res = AuthService::getInstance().login(usernameField.getText(), passwordField.getText()); res.isEmpty()) {
+    if (const auto res = authService.login(usernameField.getText(), passwordField.getText()); res.isEmpty()) {
         errorLabel.setVisible(true);
     }
 }
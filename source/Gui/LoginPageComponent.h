@@ -8,7 +8,7 @@
 class LoginPageComponent final : public juce::Component
 {
 public:
-    explicit LoginPageComponent();
+    explicit LoginPageComponent(AuthService& authService);
     ~LoginPageComponent() override;
     void onLoginButtonClick();
     void resized() override;
@@ -18,6 +18,7 @@ private:
     juce::Label usernameLabel, passwordLabel, title, errorLabel, enterInfosLabel;
     juce::TextEditor usernameField, passwordField;
     juce::TextButton loginButton;
+    AuthService& authService;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoginPageComponent)
 };
\ No newline at end of file
@@ -3,17 +3,10 @@
 //
 #include "MainPageComponent.h"
 #include "../Common/EventManager.h"
-#include "../Api/ApiRoutes.h"
-#include "../Api/SocketRoutes.h"
-#include "../Api/ApiService.h"
 
-MainPageComponent::MainPageComponent():
-#ifdef IN_RECEIVING_MODE
-    webRTCAudioService(WebRTCAudioReceiverService()),
-#else
-    webRTCAudioService(WebRTCAudioSenderService()),
-#endif
-    webSocketService(WebSocketService(getWsRouteString(WsRoute::GetOngoingSession)))
+MainPageComponent::MainPageComponent(MainAudioProcessor& processor):
+    context(processor.getEngineContext()),
+    streamingEngine(processor.getStreamingEngine())
 {
     setSize(600, 400);
     addAndMakeVisible(appName);
@@ -26,7 +19,6 @@ MainPageComponent::MainPageComponent():
     addAndMakeVisible(RTCSignalingStateText);
     addAndMakeVisible(RTCIceCandidateStateText);
 
-    const auto userContext = AuthService::getInstance().getUserContext();
 #ifdef IN_RECEIVING_MODE
     appName.setText(juce::String::fromUTF8("MeloVST Receive"), juce::dontSendNotification);
 #else
@@ -35,26 +27,22 @@ MainPageComponent::MainPageComponent():
     appName.setJustificationType(juce::Justification::centred);
     appName.setFont(30.0f);
 
-    title.setText(juce::String::fromUTF8(("Bienvenue " + userContext->user.firstname).c_str()),
-                  juce::dontSendNotification);
     title.setJustificationType(juce::Justification::centred);
     title.setFont(30.0f);
 
     mainText.setText(juce::String::fromUTF8(("L'audio s'affichera ici")), juce::dontSendNotification);
     mainText.setJustificationType(juce::Justification::centred);
 
-    RTCStateText.setText(juce::String::fromUTF8(("Vous n'êtes pas connecté avec l'artiste")),
-                         juce::dontSendNotification);
     RTCStateText.setJustificationType(juce::Justification::centred);
     RTCIceCandidateStateText.setJustificationType(juce::Justification::centred);
     RTCSignalingStateText.setJustificationType(juce::Justification::centred);
 
     refreshButton.setButtonText(juce::String::fromUTF8("Rafraîchir"));
     refreshButton.onClick = [this] {
-        fetchOngoingSession();
+        streamingEngine.refreshOngoingSession();
     };
     connectButton.setButtonText(juce::String::fromUTF8(("Se connecter avec l'artiste")));
-    connectButton.onClick = [ meloWebRTCServerService = &webRTCAudioService] {
+    connectButton.onClick = [ meloWebRTCServerService = &streamingEngine.getAudioService()] {
         if (meloWebRTCServerService->isConnecting()) {
             juce::Logger::outputDebugString("Already connecting...");
             meloWebRTCServerService->disconnect();
@@ -68,70 +56,95 @@ MainPageComponent::MainPageComponent():
     };
 
     logoutButton.setButtonText(juce::String::fromUTF8("Se déconnecter"));
-    logoutButton.onClick = [] { onLogoutButtonClick(); };
+    logoutButton.onClick = [this] { onLogoutButtonClick(); };
+
+    // État courant du moteur (déjà en mémoire, aucun appel réseau), puis suivi des changements
+    onUserContextChanged(context.getAuthService().getUserContext());
+    onOngoingSessionsChanged(streamingEngine.getOngoingSessions());
+    onRTCStateChanged(streamingEngine.getAudioService().getState());
+
+    auto& eventManager = context.getEventManager();
+    // Plusieurs sessions : l'événement ne porte que sur l'une d'elles, la page affiche l'état d'ensemble du service
+    rtcStateSubscription = eventManager.subscribe<RTCStateChangeEvent>(
+        [this](const RTCStateChangeEvent &) { onRTCStateChanged(streamingEngine.getAudioService().getState()); },
+        EventDelivery::MessageThread);
+    userContextSubscription = eventManager.subscribe<UserContextChangedEvent>(
+        [this](const UserContextChangedEvent &event) { onUserContextChanged(event.userContext); }, EventDelivery::MessageThread);
+    ongoingSessionSubscription = eventManager.subscribe<OngoingSessionsChangedEvent>(
+        [this](const OngoingSessionsChangedEvent &event) { onOngoingSessionsChanged(event.ongoingSessions); }, EventDelivery::MessageThread);
+}
 
-    fetchOngoingSession();
-    EventManager::getInstance().addListener(this);
+void MainPageComponent::onUserContextChanged(const std::optional<UserContext> &userContext) {
+    if (!userContext.has_value()) {
+        title.setText(juce::String::fromUTF8("Chargement de votre compte..."), juce::dontSendNotification);
+        return;
+    }
+    title.setText(juce::String::fromUTF8(("Bienvenue " + userContext->user.firstname).c_str()),
+                  juce::dontSendNotification);
 }
 
-void MainPageComponent::fetchOngoingSession() {
-    if (const auto res = ApiService::makeGETRequest(ApiRoute::GetMyOngoingSessions); res.isNotEmpty()) {
-        ongoingSessions = PopulatedSession::parseArrayFromJsonString(res);
-        if (ongoingSessions.size() > 0) {
-            currentOngoingSession = ongoingSessions[0];
-            mainText.setText(
-                "Vous avez une session en cours avec " + currentOngoingSession.reservedByArtist.user.userAlias,
-                juce::dontSendNotification);
-            mainText.setColour(juce::Label::textColourId, juce::Colours::green);
-            EventManager::getInstance().notifyOngoingSessionChanged(OngoingSessionChangedEvent(currentOngoingSession));
-            webSocketService.connectToServer();
-        } else {
-            mainText.setText("Vous n'avez pas de session en cours.", juce::dontSendNotification);
-            mainText.setColour(juce::Label::textColourId, juce::Colours::red);
+void MainPageComponent::onOngoingSessionsChanged(const std::vector<PopulatedSession> &ongoingSessions) {
+    if (ongoingSessions.size() == 1) {
+        mainText.setText(
+            "Vous avez une session en cours avec " + ongoingSessions.front().reservedByArtist.user.userAlias,
+            juce::dontSendNotification);
+        mainText.setColour(juce::Label::textColourId, juce::Colours::green);
+    } else if (!ongoingSessions.empty()) {
+        juce::StringArray artists;
+        for (const auto &session: ongoingSessions) {
+            artists.add(session.reservedByArtist.user.userAlias);
         }
+        mainText.setText("Vous avez " + juce::String(static_cast<int>(ongoingSessions.size())) + " sessions en cours avec "
+                         + artists.joinIntoString(", "), juce::dontSendNotification);
+        mainText.setColour(juce::Label::textColourId, juce::Colours::green);
+    } else {
+        mainText.setText("Vous n'avez pas de session en cours.", juce::dontSendNotification);
+        mainText.setColour(juce::Label::textColourId, juce::Colours::red);
     }
 }
 
-void MainPageComponent::onRTCStateChanged(const RTCStateChangeEvent &event) {
-    juce::MessageManager::callAsync([this, event] {
-        switch (event.state) {
-            case rtc::PeerConnection::State::Connected: {
-                connectButton.setButtonText(juce::String::fromUTF8("Déconnecter la connexion avec l'artiste"));
-                RTCStateText.setText(juce::String::fromUTF8("Vous êtes connecté avec l'artiste."),
-                                     juce::dontSendNotification);
-                break;
-            }
-            case rtc::PeerConnection::State::Connecting: {
-                connectButton.setButtonText(juce::String::fromUTF8(("Stopper la demande de connexion")));
-                RTCStateText.setText("En cours de connexion avec l'artiste...", juce::dontSendNotification);
-                break;
-            }
-            case rtc::PeerConnection::State::Closed:
-            case rtc::PeerConnection::State::Failed: {
-                connectButton.setVisible(true);
-                connectButton.setButtonText(juce::String::fromUTF8(("Se connecter avec l'artiste")));
-                RTCStateText.setText(juce::String::fromUTF8("Vous n'êtes pas connecté avec l'artiste"),
-                                     juce::dontSendNotification);
-                break;
-            }
-            default: {
-                connectButton.setVisible(true);
-                connectButton.setButtonText(juce::String::fromUTF8(("Se connecter avec l'artiste")));
-                RTCStateText.setText(juce::String::fromUTF8("Vous n'êtes pas connecté avec l'artiste"),
-                                     juce::dontSendNotification);
-                break;
-            }
+// Livré sur le message thread par le bus (MessageThread) : plus de callAsync capturant this,
+// aucune livraison après la destruction de la page
+void MainPageComponent::onRTCStateChanged(const rtc::PeerConnection::State state) {
+    switch (state) {
+        case rtc::PeerConnection::State::Connected: {
+            connectButton.setButtonText(juce::String::fromUTF8("Déconnecter la connexion avec l'artiste"));
+            RTCStateText.setText(juce::String::fromUTF8("Vous êtes connecté avec l'artiste."),
+                                 juce::dontSendNotification);
+            break;
+        }
+        case rtc::PeerConnection::State::Connecting: {
+            connectButton.setButtonText(juce::String::fromUTF8(("Stopper la demande de connexion")));
+            RTCStateText.setText("En cours de connexion avec l'artiste...", juce::dontSendNotification);
+            break;
         }
+        case rtc::PeerConnection::State::Closed:
+        case rtc::PeerConnection::State::Failed: {
+            connectButton.setVisible(true);
+            connectButton.setButtonText(juce::String::fromUTF8(("Se connecter avec l'artiste")));
+            RTCStateText.setText(juce::String::fromUTF8("Vous n'êtes pas connecté avec l'artiste"),
+                                 juce::dontSendNotification);
+            break;
+        }
+        default: {
+            connectButton.setVisible(true);
+            connectButton.setButtonText(juce::String::fromUTF8(("Se connecter avec l'artiste")));
+            RTCStateText.setText(juce::String::fromUTF8("Vous n'êtes pas connecté avec l'artiste"),
+                                 juce::dontSendNotification);
+            break;
+        }
+    }
 
-        RTCIceCandidateStateText.setText(webRTCAudioService.getIceCandidateStateLabel(), juce::dontSendNotification);
-        RTCSignalingStateText.setText(webRTCAudioService.getSignalingStateLabel(),
-                                      juce::dontSendNotification);
-    });
+    RTCIceCandidateStateText.setText(streamingEngine.getAudioService().getIceCandidateStateLabel(), juce::dontSendNotification);
+    RTCSignalingStateText.setText(streamingEngine.getAudioService().getSignalingStateLabel(),
+                                  juce::dontSendNotification);
 }
 
 MainPageComponent::~MainPageComponent() {
     logoutButton.onClick = nullptr;
-    EventManager::getInstance().removeListener(this);
+    rtcStateSubscription.reset();
+    userContextSubscription.reset();
+    ongoingSessionSubscription.reset();
 }
 
 void MainPageComponent::resized() {
@@ -184,5 +197,5 @@ void MainPageComponent::paint(juce::Graphics &g) {
 }
 
 void MainPageComponent::onLogoutButtonClick() {
-    AuthService::logout();
+    context.getAuthService().logout();
 }
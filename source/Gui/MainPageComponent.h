@@ -3,27 +3,25 @@
 //
 #pragma once
 #include <juce_gui_basics/juce_gui_basics.h>
-#include "../Api/AuthService.h"
-#include "../Common/EventListener.h"
-#include "../Api/WebSocketService.h"
+#include "../Common/EventBus.h"
+#include "../Common/Events.h"
 #include "../Models/Session.h"
 #include "../Debug/DebugAudioAppPlayer.h"
+#include "../MainAudioProcessor.h"
+#include "../StreamingEngine.h"
 
-#ifdef IN_RECEIVING_MODE
-#include "../RtcReceiver/WebRTCAudioReceiverService.h"
-#else
-#include "../RtcSender/WebRTCAudioSenderService.h"
-#endif
-
-class MainPageComponent final : public juce::Component, EventListener
+// Vue de l'état du StreamingEngine : la page ne possède aucun service, elle lit l'état courant à l'ouverture
+// puis suit les événements du bus, livrés sur le message thread
+class MainPageComponent final : public juce::Component
 {
 public:
-    explicit MainPageComponent();
+    explicit MainPageComponent(MainAudioProcessor& processor);
     ~MainPageComponent() override;
 
-    static void onLogoutButtonClick();
-    void onRTCStateChanged(const RTCStateChangeEvent &event) override;
-    void fetchOngoingSession();
+    void onLogoutButtonClick();
+    void onRTCStateChanged(rtc::PeerConnection::State state);
+    void onUserContextChanged(const std::optional<UserContext>& userContext);
+    void onOngoingSessionsChanged(const std::vector<PopulatedSession>& ongoingSessions);
 
     void resized() override;
     void paint(juce::Graphics &g) override;
@@ -31,13 +29,8 @@ public:
 private:
     juce::Label title, mainText, RTCStateText, RTCIceCandidateStateText, RTCSignalingStateText, appName;
     juce::TextButton logoutButton, connectButton, refreshButton;
-#ifdef IN_RECEIVING_MODE
-    WebRTCAudioReceiverService webRTCAudioService;
-#else
-    WebRTCAudioSenderService webRTCAudioService;
-#endif
+    EngineContext& context;
+    StreamingEngine& streamingEngine;
     // DebugAudioAppPlayer audioAppPlayer;
-    WebSocketService webSocketService;
-    juce::Array<PopulatedSession> ongoingSessions;
-    PopulatedSession currentOngoingSession;
+    EventSubscription rtcStateSubscription, userContextSubscription, ongoingSessionSubscription;
 };
\ No newline at end of file
@@ -6,27 +6,28 @@
 #include "../Common/EventManager.h"
 #include "../Common/JuceLocalStorage.h"
 
-MainWindow::MainWindow(const juce::String& name): Component(name)
+MainWindow::MainWindow(const juce::String& name, MainAudioProcessor& processor): Component(name), processor(processor)
 {
+    // Aucun appel réseau ici : le contexte utilisateur est chargé par le StreamingEngine du processeur ;
+    // si le jeton n'est plus valide, sa déconnexion ramènera à la page de connexion
     if (const auto accessToken = JuceLocalStorage::getInstance().loadValue("access_token"); accessToken.isEmpty()) {
         navigateToLoginPage();
     }
     else {
-        auto autoContext = AuthService::getInstance().fetchUserContext();
-        if (autoContext.has_value()) {
-            navigateToMainPage();
-        }
-        else {
-            navigateToLoginPage();
-        }
+        navigateToMainPage();
     }
 
     Component::setVisible (true);
-    EventManager::getInstance().addListener(this);
+    auto& eventManager = processor.getEngineContext().getEventManager();
+    loginSubscription = eventManager.subscribe<LoginEvent>(
+        [this](const LoginEvent& event) { onLoginEvent(event); }, EventDelivery::MessageThread);
+    logoutSubscription = eventManager.subscribe<LogoutEvent>(
+        [this](const LogoutEvent& event) { onLogoutEvent(event); }, EventDelivery::MessageThread);
 }
 
 MainWindow::~MainWindow() {
-    EventManager::getInstance().removeListener(this);
+    loginSubscription.reset();
+    logoutSubscription.reset();
 }
 
 void MainWindow::paint(juce::Graphics& g)
@@ -52,14 +53,14 @@ void MainWindow::onLogoutEvent(const LogoutEvent& event) {
 
 void MainWindow::navigateToLoginPage()
 {
-    currentPage = std::make_unique<LoginPageComponent>();
+    currentPage = std::make_unique<LoginPageComponent>(processor.getEngineContext().getAuthService());
     addAndMakeVisible(currentPage.get());
     resized();
 }
 
 void MainWindow::navigateToMainPage()
 {
-    currentPage = std::make_unique<MainPageComponent>();
+    currentPage = std::make_unique<MainPageComponent>(processor);
     addAndMakeVisible(currentPage.get());
     resized();
 }
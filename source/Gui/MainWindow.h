@@ -5,23 +5,29 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "MainPageComponent.h"
-#include "../Common/EventListener.h"
+#include "../MainAudioProcessor.h"
+#include "../Common/EventBus.h"
+#include "../Common/Events.h"
 
-class MainWindow final : public juce::Component, public EventListener
+class MainWindow final : public juce::Component
 {
 public:
-    explicit MainWindow (const juce::String& name);
+    MainWindow (const juce::String& name, MainAudioProcessor& processor);
     ~MainWindow() override;
 
     void paint (juce::Graphics&) override;
     void resized() override;
-    void onLoginEvent(const LoginEvent &event) override;
-    void onLogoutEvent(const LogoutEvent &event) override;
+    void onLoginEvent(const LoginEvent &event);
+    void onLogoutEvent(const LogoutEvent &event);
 
 private:
    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
 
+    MainAudioProcessor& processor;
     std::unique_ptr<Component> currentPage;
     void navigateToLoginPage();
     void navigateToMainPage();
+    // Livrés sur le message thread, après le retour du bouton qui a déclenché l'événement :
+    // la page courante peut alors être détruite sans risque
+    EventSubscription loginSubscription, logoutSubscription;
 };
\ No newline at end of file
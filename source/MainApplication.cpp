@@ -4,9 +4,9 @@
 
 MainApplication::MainApplication(MainAudioProcessor &p): AudioProcessorEditor(&p) {
 #ifdef IN_RECEIVING_MODE
-    mainWindow = std::make_unique<MainWindow>("MeloVST Receive");
+    mainWindow = std::make_unique<MainWindow>("MeloVST Receive", p);
 #else
-    mainWindow = std::make_unique<MainWindow>("MeloVST Send");
+    mainWindow = std::make_unique<MainWindow>("MeloVST Send", p);
 #endif
 
     addAndMakeVisible(mainWindow.get());
@@ -1,8 +1,17 @@
 #include "MainAudioProcessor.h"
 #include "MainApplication.h"
 #include "AudioSettings.h"
-#include "Common/EventManager.h"
-#include <chrono>
+#include "StreamingEngine.h"
+
+#ifndef IN_RECEIVING_MODE
+namespace {
+    // 500 ms de capture à la fréquence la plus élevée prise en charge, en stéréo : la tâche d'encodage repasse
+    // quand un bloc complet doit y être déposé, la marge n'est là que pour absorber ses retards
+    constexpr size_t maxCaptureSampleRate = 192000;
+    constexpr size_t maxCaptureChannels = 2;
+    constexpr size_t captureFifoCapacity = maxCaptureSampleRate / 2 * maxCaptureChannels;
+}
+#endif
 
 //==============================================================================
 MainAudioProcessor::MainAudioProcessor()
@@ -14,16 +23,17 @@ MainAudioProcessor::MainAudioProcessor()
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
     )
+{
+    // Initialisation en mémoire uniquement : le moteur ne démarre (réseau, libdatachannel) qu'à start()
 #ifdef IN_RECEIVING_MODE
-// , audioPacketQueue(AudioSettings::getInstance().getSampleRate() * AudioSettings::getInstance().getNumChannels())
+    streamingEngine = std::make_unique<StreamingEngine>(engineContext, audioPlayout);
+#else
+    captureFifo.prepare(captureFifoCapacity);
+    streamingEngine = std::make_unique<StreamingEngine>(engineContext, captureFifo);
 #endif
-{
-    EventManager::getInstance().addListener(this);
 }
 
-MainAudioProcessor::~MainAudioProcessor() {
-    EventManager::getInstance().removeListener(this);
-};
+MainAudioProcessor::~MainAudioProcessor() = default;
 
 const juce::String MainAudioProcessor::getProgramName(const int index) {
 #ifdef MELO_PLUGIN_NAME
@@ -86,22 +96,43 @@ void MainAudioProcessor::changeProgramName(int index, const juce::String &newNam
 
 //==============================================================================
 void MainAudioProcessor::prepareToPlay(const double sampleRate, const int samplesPerBlock) {
-    AudioSettings::getInstance().setSampleRate(sampleRate);
-    AudioSettings::getInstance().setBlockSize(samplesPerBlock);
-    AudioSettings::getInstance().setNumChannels(getMainBusNumOutputChannels());
-    AudioSettings::getInstance().setBitDepth(16);
-    AudioSettings::getInstance().setOpusSampleRate(48000);
-    AudioSettings::getInstance().setLatency(20); // 20 ms
-    AudioSettings::getInstance().setOpusBitRate(96000);
+    // Publication atomique et versionnée : la chaîne d'envoi se reconstruit d'elle-même entre deux blocs,
+    // sans couper la connexion WebRTC
+    auto& audioSettings = engineContext.getAudioSettings();
+    auto settings = audioSettings.getSnapshot();
+    settings.sampleRate = static_cast<int>(sampleRate);
+    settings.blockSize = samplesPerBlock;
+    settings.numChannels = getMainBusNumOutputChannels();
+    settings.bitDepth = 16;
+    settings.opusSampleRate = 48000;
+    settings.latency = 20; // 20 ms
+    settings.opusBitRate = 96000;
+    audioSettings.publish(settings);
 
     juce::Logger::outputDebugString("Sample rate: " + std::to_string(sampleRate));
     juce::Logger::outputDebugString("Block Size: " + std::to_string(samplesPerBlock));
     juce::Logger::outputDebugString("Num Channels: " + std::to_string(getMainBusNumOutputChannels()));
-    juce::Logger::outputDebugString("Bit depth: " + std::to_string(AudioSettings::getInstance().getBitDepth()));
+    juce::Logger::outputDebugString("Bit depth: " + std::to_string(audioSettings.getBitDepth()));
     juce::Logger::outputDebugString(
-        "Opus Sample rate: " + std::to_string(AudioSettings::getInstance().getOpusSampleRate()));
-    juce::Logger::outputDebugString("Latency: " + std::to_string(AudioSettings::getInstance().getLatency()));
-    juce::Logger::outputDebugString("Opus Bit rate: " + std::to_string(AudioSettings::getInstance().getOpusBitRate()));
+        "Opus Sample rate: " + std::to_string(audioSettings.getOpusSampleRate()));
+    juce::Logger::outputDebugString("Latency: " + std::to_string(audioSettings.getLatency()));
+    juce::Logger::outputDebugString("Opus Bit rate: " + std::to_string(audioSettings.getOpusBitRate()));
+
+#ifdef IN_RECEIVING_MODE
+    // Conversion 48 kHz -> fréquence de l'hôte, avec compensation de la dérive d'horloge
+    audioPlayout.prepare(sampleRate, samplesPerBlock);
+#else
+    // La file de capture est allouée une fois pour toutes dans le constructeur : la tâche d'encodage
+    // peut la lire pendant que l'hôte change de fréquence ou de taille de bloc
+    captureNumChannels = getMainBusNumOutputChannels();
+    // Écrite par le thread audio à chaque bloc : aucun défaut de page ne doit l'interrompre
+    if (lockedCaptureFifo.getLockedBytes() == 0
+        && ! lockedCaptureFifo.lock(captureFifo.getStorage(), captureFifo.getCapacity() * sizeof(float)))
+        juce::Logger::outputDebugString("Capture FIFO could not be locked in memory");
+#endif
+
+    // Premier prepareToPlay : l'hôte utilise vraiment le plugin, le moteur réseau démarre en arrière-plan
+    streamingEngine->start();
 }
 
 void MainAudioProcessor::releaseResources() {
@@ -137,51 +168,21 @@ bool MainAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) cons
 
 void MainAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                       juce::MidiBuffer &midiMessages) {
+    juce::ignoreUnused(midiMessages);
     const int numSamples = buffer.getNumSamples();
     const int numChannels = buffer.getNumChannels();
     buffer.clear();
 
-    int samplesWritten = 0;
-
-    while (samplesWritten < numSamples) {
-        {
-            juce::ScopedLock sl(lock);
-
-            if (currentBlock.empty()) {
-                if (audioQueue.empty()) {
-                    break;
-                } else {
-                    currentBlock = std::move(audioQueue.front());
-                    audioQueue.pop_front();
-                    currentSampleIndex = 0;
-                }
-            }
-        }
-
-        int samplesRemainingInBlock = static_cast<int>(currentBlock.size()) - currentSampleIndex;
-        int samplesToCopy = std::min(numSamples - samplesWritten, samplesRemainingInBlock);
-        for (int channel = 0; channel < numChannels; ++channel) {
-            auto writePointer = buffer.getWritePointer(channel, samplesWritten);
-            for (int sample = 0; sample < samplesToCopy; ++sample) {
-                writePointer[sample] = currentBlock[currentSampleIndex + sample];
-            }
-        }
-
-        samplesWritten += samplesToCopy; {
-            juce::ScopedLock sl(lock);
-            currentSampleIndex += samplesToCopy;
-
-            if (currentSampleIndex >= static_cast<int>(currentBlock.size())) {
-                currentBlock.clear();
-                currentSampleIndex = 0;
-            }
-        }
+    if (numChannels == 0 || numSamples == 0) {
+        return;
     }
-}
 
-void MainAudioProcessor::onAudioBlockReceivedDecoded(const AudioBlockReceivedDecodedEvent &event) {
-    juce::ScopedLock sl(lock);
-    audioQueue.push_back(event.data);
+    // Les paquets sont décodés à la demande dans le premier canal, puis dupliqués : le flux décodé est mono.
+    // En cas de manque, la fin du bloc reste silencieuse.
+    const auto samplesRead = static_cast<int>(audioPlayout.pull(buffer.getWritePointer(0), static_cast<size_t>(numSamples)));
+    for (int channel = 1; channel < numChannels; ++channel) {
+        buffer.copyFrom(channel, 0, buffer, 0, 0, samplesRead);
+    }
 }
 
 
@@ -191,35 +192,16 @@ void MainAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
 {
     juce::ignoreUnused (midiMessages);
 
-    const int numChannels = buffer.getNumChannels();
+    const int numChannels = std::min(buffer.getNumChannels(), captureNumChannels);
     const int numSamples = buffer.getNumSamples();
 
     if (numChannels == 0 || numSamples == 0) {
         return; // Rien à traiter
     }
 
-    // Optimisation mémoire : éviter les réallocations fréquentes
-    std::vector<float> pcmData;
-    pcmData.reserve(static_cast<size_t>(numChannels * numSamples));
-
-    // Copier les échantillons dans un format interleaved (L, R, L, R...)
-    for (int sample = 0; sample < numSamples; ++sample) {
-        for (int channel = 0; channel < numChannels; ++channel) {
-            pcmData.push_back(buffer.getReadPointer(channel)[sample]);
-        }
-    }
-
-    if (pcmData.empty()) return; // Vérification plus explicite
-
-    // Envoyer l'événement avec std::move pour éviter les copies inutiles
-    uint32_t timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
-    EventManager::getInstance().notifyAudioBlockProcessed(AudioBlockProcessedEvent{
-        std::move(pcmData), // Transfert des données
-        numChannels,
-        numSamples,
-        getSampleRate(),
-        timestamp
-    });
+    // Entrelacement (L, R, L, R...) directement dans la file préallouée : ni allocation ni verrou sur le thread audio.
+    // Si la tâche d'encodage ne suit pas, le bloc est rejeté et compté dans getNumOverruns().
+    captureFifo.writeInterleaved(buffer.getArrayOfReadPointers(), numChannels, numSamples);
 }
 #endif
 
@@ -230,6 +212,8 @@ bool MainAudioProcessor::hasEditor() const {
 }
 
 juce::AudioProcessorEditor *MainAudioProcessor::createEditor() {
+    // L'éditeur affiche le compte et la session : le moteur démarre s'il ne l'a pas encore fait
+    streamingEngine->start();
     return new MainApplication(*this);
 }
 
@@ -2,17 +2,24 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <fstream>
+#include <memory>
 
 #include "Common/CircularBuffer.h"
-#include "Common/EventListener.h"
-#include <deque>
+#include "Common/RealtimeThreads.h"
+#include "Common/SpscAudioFifo.h"
+#include "EngineContext.h"
+#ifdef IN_RECEIVING_MODE
+#include "RtcReceiver/AudioPlayout.h"
+#endif
+
+class StreamingEngine;
 
 // struct AudioPacket {
 //     uint64_t timestamp;
 //     std::vector<float> data;
 // };
 //==============================================================================
-class MainAudioProcessor final : public juce::AudioProcessor, EventListener
+class MainAudioProcessor final : public juce::AudioProcessor
 {
 public:
     //==============================================================================
@@ -50,17 +57,34 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // Réglages, bus d'événements et services propres à cette instance du plugin
+    EngineContext& getEngineContext() noexcept { return engineContext; }
+    // Connexion et session, indépendantes de l'éditeur : fermer la fenêtre ne coupe pas la diffusion
+    StreamingEngine& getStreamingEngine() noexcept { return *streamingEngine; }
+
+#ifdef IN_RECEIVING_MODE
+    // Tampon de gigue et décodage alimentés par WebRTCAudioReceiverService
+    AudioPlayout& getAudioPlayout() noexcept { return audioPlayout; }
+#else
+    // File de capture lue par la tâche d'encodage (WebRTCAudioSenderService)
+    SpscAudioFifo& getCaptureFifo() noexcept { return captureFifo; }
+#endif
+
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainAudioProcessor);
 
+    EngineContext engineContext;
 #ifdef IN_RECEIVING_MODE
-    void onAudioBlockReceivedDecoded(const AudioBlockReceivedDecodedEvent &event) override;
-    std::deque<std::vector<float>> audioQueue;
-    juce::CriticalSection lock;
-    std::vector<float> currentBlock;
-    size_t currentSampleIndex = 0;
-    double currentSampleRate = 0;
+    AudioPlayout audioPlayout;
+#else
+    // Échantillons entrelacés écrits par processBlock, préalloués dans le constructeur
+    SpscAudioFifo captureFifo;
+    int captureNumChannels = 0;
+    // File de capture verrouillée en mémoire au premier prepareToPlay (jamais pendant le scan)
+    RealtimeThreads::LockedMemory lockedCaptureFifo;
 #endif
+    // Détruit avant les files audio qu'il alimente ou qu'il lit
+    std::unique_ptr<StreamingEngine> streamingEngine;
 
 };
@@ -0,0 +1,19 @@
+#pragma once
+#include <mutex>
+#include <rtc/rtc.hpp>
+
+// Initialisation globale de libdatachannel (journalisation, OpenSSL, threads internes), commune au processus.
+// Coûteuse : jamais appelée depuis le constructeur du plugin, que les hôtes instancient en boucle pendant
+// le scan. Le StreamingEngine la lance en arrière-plan au premier prepareToPlay ou à l'ouverture de
+// l'éditeur ; une connexion demandée avant la fin attend simplement qu'elle se termine.
+namespace RtcRuntime
+{
+    inline void warmUp()
+    {
+        static std::once_flag initialized;
+        std::call_once(initialized, [] {
+            rtc::InitLogger(rtc::LogLevel::Info);
+            rtc::Preload();
+        });
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../Models/Session.h"
+
+// Connexions d'une instance du plugin, une par session en cours, indexées par identifiant de session.
+// setSessions() n'applique que la différence avec la liste précédente : une session qui reste garde sa
+// connexion (ni renégociation ni coupure), les nouvelles sont créées et celles qui disparaissent fermées.
+// Création et destruction (ouverture et fermeture d'une PeerConnection) se font hors du verrou : le thread
+// d'encodage, qui parcourt les connexions à chaque trame (forEach), n'attend jamais qu'une connexion s'ouvre.
+template <typename Connection>
+class SessionConnectionManager
+{
+public:
+    using Factory = std::function<std::shared_ptr<Connection>(const PopulatedSession&)>;
+
+    struct Changes
+    {
+        std::vector<std::string> added;
+        std::vector<std::string> removed;
+    };
+
+    explicit SessionConnectionManager(Factory connectionFactory) : factory(std::move(connectionFactory)) {}
+
+    SessionConnectionManager(const SessionConnectionManager&) = delete;
+    SessionConnectionManager& operator=(const SessionConnectionManager&) = delete;
+
+    // Les connexions retirées sont détruites avant le retour, sauf si l'appelant en garde une référence
+    Changes setSessions(const std::vector<PopulatedSession>& sessions)
+    {
+        // Deux mises à jour concurrentes créeraient deux connexions pour la même session
+        const std::lock_guard updateLock(updateMutex);
+
+        Changes changes;
+        auto previous = getConnectionMap();
+        std::map<std::string, std::shared_ptr<Connection>> next;
+        for (const auto& session: sessions)
+        {
+            if (session._id.empty() || next.contains(session._id))
+                continue;
+            if (const auto existing = previous.find(session._id); existing != previous.end())
+            {
+                next.emplace(session._id, existing->second);
+            }
+            else if (auto connection = factory(session))
+            {
+                next.emplace(session._id, std::move(connection));
+                changes.added.push_back(session._id);
+            }
+        }
+        for (const auto& [sessionId, connection]: previous)
+        {
+            if (!next.contains(sessionId))
+                changes.removed.push_back(sessionId);
+        }
+
+        {
+            const std::lock_guard lock(mutex);
+            connections.swap(next);
+        }
+        // next tient maintenant l'ancienne table : les connexions retirées sont fermées ici, hors du verrou
+        return changes;
+    }
+
+    void clear() { setSessions({}); }
+
+    [[nodiscard]] std::shared_ptr<Connection> find(const std::string& sessionId) const
+    {
+        const std::lock_guard lock(mutex);
+        const auto it = connections.find(sessionId);
+        return it != connections.end() ? it->second : nullptr;
+    }
+
+    // Copie des connexions, pour agir sur chacune sans tenir le verrou (connexion, déconnexion)
+    [[nodiscard]] std::vector<std::shared_ptr<Connection>> getConnections() const
+    {
+        const std::lock_guard lock(mutex);
+        std::vector<std::shared_ptr<Connection>> result;
+        result.reserve(connections.size());
+        for (const auto& [sessionId, connection]: connections)
+            result.push_back(connection);
+        return result;
+    }
+
+    // Parcours sous le verrou, sans copie ni allocation : fn ne doit ni bloquer ni modifier les sessions
+    template <typename Fn>
+    void forEach(Fn&& fn) const
+    {
+        const std::lock_guard lock(mutex);
+        for (const auto& [sessionId, connection]: connections)
+            fn(*connection);
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        const std::lock_guard lock(mutex);
+        return connections.size();
+    }
+
+private:
+    std::map<std::string, std::shared_ptr<Connection>> getConnectionMap() const
+    {
+        const std::lock_guard lock(mutex);
+        return connections;
+    }
+
+    Factory factory;
+    std::mutex updateMutex;
+    mutable std::mutex mutex;
+    std::map<std::string, std::shared_ptr<Connection>> connections;
+};
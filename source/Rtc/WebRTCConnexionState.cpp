@@ -5,22 +5,87 @@
 #include "../Api/SocketRoutes.h"
 #include "../Api/SocketEvents.h"
 
-WebRTCConnexionState::WebRTCConnexionState(const WsRoute wsRoute): reconnectTimer([this]() { attemptReconnect(); }),
-    meloWebSocketService(
-        WebSocketService(getWsRouteString(wsRoute))) {
-    EventManager::getInstance().addListener(this);
+#include <utility>
+
+WebRTCConnexionState::WebRTCConnexionState(const WsRoute wsRoute, EngineContext &engineContext): context(engineContext),
+    reconnectTimer([this]() { attemptReconnect(); }),
+    ownWebSocketService(std::make_unique<WebSocketService>(getWsRouteString(wsRoute), engineContext.getEventManager())),
+    meloWebSocketService(*ownWebSocketService) {
+    ongoingSessionSubscription = engineContext.getEventManager().subscribe<OngoingSessionChangedEvent>(
+        [this](const OngoingSessionChangedEvent &event) { onOngoingSessionChanged(event); });
+}
+
+WebRTCConnexionState::WebRTCConnexionState(EngineContext &engineContext, WebSocketService &signaling,
+                                           const PopulatedSession &session): context(engineContext),
+    reconnectTimer([this]() { attemptReconnect(); }),
+    meloWebSocketService(signaling),
+    ongoingSession(session) {
 }
 
 WebRTCConnexionState::~WebRTCConnexionState() {
-    EventManager::getInstance().removeListener(this);
-    if (peerConnection) {
-        peerConnection->close();
+    ongoingSessionSubscription.reset();
+    // Une connexion de session peut être détruite pendant que les autres vivent : plus aucun rappel vers this
+    stopConnectionCallbacks();
+    if (const auto connection = getPeerConnection()) {
+        connection->close();
+    }
+}
+
+std::shared_ptr<rtc::PeerConnection> WebRTCConnexionState::getPeerConnection() const {
+    const std::lock_guard lock(peerConnectionMutex);
+    return peerConnection;
+}
+
+std::shared_ptr<rtc::PeerConnection> WebRTCConnexionState::getPeerConnectionIfCurrent(const rtc::PeerConnection *owner) const {
+    const std::lock_guard lock(peerConnectionMutex);
+    return peerConnection.get() == owner ? peerConnection : nullptr;
+}
+
+namespace {
+    // Plus aucun rappel, puis fermeture : une connexion remplacée ne publie plus son état par-dessus la suivante
+    void retirePeerConnection(const std::shared_ptr<rtc::PeerConnection> &connection) {
+        if (connection) {
+            connection->resetCallbacks();
+            connection->close();
+        }
+    }
+}
+
+void WebRTCConnexionState::replacePeerConnection(std::shared_ptr<rtc::PeerConnection> next) {
+    // Fermée hors du verrou, que ses rappels encore en cours prennent aussi
+    retirePeerConnection(getPeerConnection());
+    {
+        const std::lock_guard lock(peerConnectionMutex);
+        pendingCandidates.clear();
+        peerConnection.swap(next);
     }
+    // Une autre connexion installée entre-temps (offre reçue pendant une reprise) : fermée à son tour
+    retirePeerConnection(next);
 }
 
-void WebRTCConnexionState::disconnect() const {
-    if (peerConnection) {
-        peerConnection->close();
+void WebRTCConnexionState::addPendingCandidate(const rtc::PeerConnection *owner, const rtc::Candidate &candidate) {
+    const std::lock_guard lock(peerConnectionMutex);
+    if (peerConnection.get() == owner) {
+        pendingCandidates.push_back(candidate);
+    }
+}
+
+std::vector<rtc::Candidate> WebRTCConnexionState::takePendingCandidates() {
+    const std::lock_guard lock(peerConnectionMutex);
+    return std::exchange(pendingCandidates, {});
+}
+
+void WebRTCConnexionState::stopConnectionCallbacks() {
+    callbackLiveness.invalidate();
+    if (const auto connection = getPeerConnection()) {
+        connection->resetCallbacks();
+    }
+}
+
+void WebRTCConnexionState::disconnect() {
+    reconnectTimer.stopTimer();
+    if (const auto connection = getPeerConnection()) {
+        connection->close();
     }
 }
 
@@ -30,80 +95,139 @@ void WebRTCConnexionState::resetConnection() {
 }
 
 void WebRTCConnexionState::notifyRTCStateChanged() const {
+    const auto connection = getPeerConnection();
+    if (!connection) {
+        return;
+    }
     juce::Logger::outputDebugString("RTC state changed, notifying listeners");
-    EventManager::getInstance().notifyOnRTCStateChanged({
-        peerConnection->state(), peerConnection->iceState(), peerConnection->signalingState()
+    context.getEventManager().publish(RTCStateChangeEvent{
+        connection->state(), connection->iceState(), connection->signalingState(), getSessionId()
     });
 }
 
+bool WebRTCConnexionState::isForThisSession(const MessageWsReceivedEvent &event) const {
+    // Message sans identifiant de session : rejeté, il pourrait venir de n'importe quelle session de la route.
+    // Offres, réponses et candidats émis par les plugins portent tous le leur
+    if (!event.data.contains("sessionId") || !event.data["sessionId"].is_string()) {
+        return false;
+    }
+    return ongoingSession.has_value() && event.data["sessionId"].get<std::string>() == ongoingSession->_id;
+}
+
+std::string WebRTCConnexionState::getSessionId() const {
+    return ongoingSession.has_value() ? ongoingSession->_id : std::string();
+}
+
 void WebRTCConnexionState::onOngoingSessionChanged(const OngoingSessionChangedEvent &event) {
     ongoingSession = event.ongoingSession;
-    if (meloWebSocketService.isConnected()) {
+    if (!ongoingSession.has_value()) {
+        disconnect();
+        meloWebSocketService.disconnectToServer();
         return;
     }
-    meloWebSocketService.connectToServer();
+    if (!meloWebSocketService.isConnected()) {
+        meloWebSocketService.connectToServer();
+    }
+    // Publié depuis le thread de travail du StreamingEngine : la collecte ICE se fait en arrière-plan
+    prewarmConnection();
+}
+
+void WebRTCConnexionState::stopSessionUpdates() {
+    ongoingSessionSubscription.reset();
+}
+
+void WebRTCConnexionState::onIceStateChangedForRecovery(const rtc::PeerConnection::IceState state) {
+    switch (state) {
+        case rtc::PeerConnection::IceState::Disconnected:
+            // Souvent passager (perte de quelques paquets de consentement) : ICE peut se rétablir seul
+            reconnectTimer.startTimer(disconnectGraceMs);
+            break;
+        case rtc::PeerConnection::IceState::Failed:
+            reconnectTimer.startTimer(1);
+            break;
+        case rtc::PeerConnection::IceState::Connected:
+        case rtc::PeerConnection::IceState::Completed: {
+            reconnectTimer.stopTimer();
+            const std::lock_guard lock(reconnectMutex);
+            if (reconnectBackoff.getAttempts() > 0) {
+                juce::Logger::outputDebugString("Reconnection successful.");
+            }
+            reconnectBackoff.reset();
+            break;
+        }
+        default:
+            break;
+    }
 }
 
+// Message thread (reconnectTimer)
 void WebRTCConnexionState::attemptReconnect() {
+    reconnectTimer.stopTimer();
     if (!ongoingSession.has_value()) {
         juce::Logger::outputDebugString("No ongoing session. Cannot reconnect.");
         return;
     }
-    if (peerConnection && peerConnection->state() == rtc::PeerConnection::State::Connected) {
-        juce::Logger::outputDebugString("Already connected. Skipping reconnection.");
-        return;
+
+    const auto state = getState();
+    int delayMs = 0;
+    int attempt = 0;
+    {
+        const std::lock_guard lock(reconnectMutex);
+        if (state == rtc::PeerConnection::State::Connected) {
+            juce::Logger::outputDebugString("Already connected. Skipping reconnection.");
+            reconnectBackoff.reset();
+            return;
+        }
+        delayMs = reconnectBackoff.nextDelayMs();
+        attempt = reconnectBackoff.getAttempts();
     }
-    if (reconnectAttempts >= maxReconnectAttempts) {
+    if (delayMs < 0) {
         juce::Logger::outputDebugString("Max reconnect attempts reached. Giving up.");
         return;
     }
 
-    juce::Logger::outputDebugString("Attempting to reconnect...");
-    reconnectAttempts++;
-
-    resetConnection();
-
-    reconnectTimer.callAfterDelay(reconnectDelayMs, [this]() {
-        if (!peerConnection || peerConnection->state() == rtc::PeerConnection::State::Closed) {
-            attemptReconnect();
-        } else {
-            juce::Logger::outputDebugString("Reconnection successful.");
-            reconnectAttempts = 0;
-        }
-    });
+    // Une connexion reconstruite à la tentative précédente est encore en négociation : on lui laisse le délai suivant
+    if (state != rtc::PeerConnection::State::Connecting) {
+        juce::Logger::outputDebugString("Attempting to reconnect (attempt " + std::to_string(attempt) + ")...");
+        resetConnection();
+    }
+    reconnectTimer.startTimer(delayMs);
 }
 
 bool WebRTCConnexionState::isConnected() const {
-    if (!peerConnection) {
-        return false;
-    }
-    return peerConnection->state() == rtc::PeerConnection::State::Connected;
+    return getState() == rtc::PeerConnection::State::Connected;
 }
 
 bool WebRTCConnexionState::isConnecting() const {
-    if (!peerConnection) {
-        return false;
+    return getState() == rtc::PeerConnection::State::Connecting;
+}
+
+rtc::PeerConnection::State WebRTCConnexionState::getState() const {
+    const auto connection = getPeerConnection();
+    if (!connection) {
+        return rtc::PeerConnection::State::New;
     }
-    return peerConnection->state() == rtc::PeerConnection::State::Connecting;
+    return connection->state();
 }
 
 bool WebRTCConnexionState::sendAnswerToRemote(const rtc::Description &sdp) {
     if (ongoingSession.has_value()) {
-        const auto offerEvent = new RTCAnswerSentEvent(sdp, ongoingSession.value());
-        meloWebSocketService.sendMessage(offerEvent->createMessage());
+        RTCAnswerSentEvent answerEvent(sdp, ongoingSession.value());
+        meloWebSocketService.sendMessage(answerEvent.type, answerEvent.createMessage());
         return true;
     }
     return false;
 }
 
 bool WebRTCConnexionState::sendOfferToRemote(const rtc::Description &sdp) {
-    if (peerConnection->signalingState() != rtc::PeerConnection::SignalingState::HaveLocalOffer
-        || peerConnection->state() == rtc::PeerConnection::State::Connected) {
+    const auto connection = getPeerConnection();
+    if (!connection || connection->signalingState() != rtc::PeerConnection::SignalingState::HaveLocalOffer
+        || connection->state() == rtc::PeerConnection::State::Connected) {
         return false;
     }
     if (ongoingSession.has_value()) {
-        const auto offerEvent = new RTCOfferSentEvent(sdp, ongoingSession.value());
-        meloWebSocketService.sendMessage(offerEvent->createMessage());
+        RTCOfferSentEvent offerEvent(sdp, ongoingSession.value());
+        meloWebSocketService.sendMessage(offerEvent.type, offerEvent.createMessage());
         return true;
     }
     return false;
@@ -114,16 +238,17 @@ bool WebRTCConnexionState::sendCandidateToRemote(const rtc::Candidate &candidate
         return false;
     }
     juce::Logger::outputDebugString("Sending candidate to remote");
-    const auto candidateEvent = new RTCIceCandidateSentEvent(candidate, ongoingSession.value());
-    meloWebSocketService.sendMessage(candidateEvent->createMessage());
+    RTCIceCandidateSentEvent candidateEvent(candidate, ongoingSession.value());
+    meloWebSocketService.sendMessage(candidateEvent.type, candidateEvent.createMessage());
     return true;
 }
 
 juce::String WebRTCConnexionState::getSignalingStateLabel() const {
-    if (!peerConnection) {
+    const auto connection = getPeerConnection();
+    if (!connection) {
         return juce::String::fromUTF8("Inconnu");
     }
-    switch (peerConnection->signalingState()) {
+    switch (connection->signalingState()) {
         case rtc::PeerConnection::SignalingState::Stable:
             return juce::String::fromUTF8("Stable");
         case rtc::PeerConnection::SignalingState::HaveLocalOffer:
@@ -140,10 +265,11 @@ juce::String WebRTCConnexionState::getSignalingStateLabel() const {
 }
 
 juce::String WebRTCConnexionState::getIceCandidateStateLabel() const {
-    if (!peerConnection) {
+    const auto connection = getPeerConnection();
+    if (!connection) {
         return juce::String::fromUTF8("Inconnu");
     }
-    switch (peerConnection->iceState()) {
+    switch (connection->iceState()) {
         case rtc::PeerConnection::IceState::New:
             return juce::String::fromUTF8("Nouveau");
         case rtc::PeerConnection::IceState::Checking:
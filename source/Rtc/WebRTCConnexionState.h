@@ -1,50 +1,104 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <rtc/rtc.hpp>
 #include <juce_core/juce_core.h>
 
 #include "../Api/WebSocketService.h"
-#include "../Common/EventListener.h"
+#include "../Common/EventBus.h"
+#include "../Common/Events.h"
+#include "../Common/LivenessToken.h"
 #include "../Models/Session.h"
 #include "../Api/SocketRoutes.h"
+#include "../Common/ReconnectBackoff.h"
 #include "../Common/ReconnectTimer.h"
+#include "../EngineContext.h"
 
-class WebRTCConnexionState: public virtual EventListener {
+class WebRTCConnexionState {
 public:
-    explicit WebRTCConnexionState(WsRoute wsRoute);
-    ~WebRTCConnexionState() override;
+    // Connexion qui suit la session en cours de l'instance (OngoingSessionChangedEvent), avec sa propre route
+    WebRTCConnexionState(WsRoute wsRoute, EngineContext& engineContext);
+    // Connexion d'une seule session, créée et détruite avec elle (voir SessionConnectionManager) ;
+    // la route de signalisation, partagée avec les autres sessions de l'instance, est connectée par l'appelant
+    WebRTCConnexionState(EngineContext& engineContext, WebSocketService& signaling, const PopulatedSession& session);
+    virtual ~WebRTCConnexionState();
 
     virtual void setupConnection() = 0;
-    virtual void disconnect() const;
+    // Prépare la connexion dès qu'une session est disponible, avant que l'utilisateur ne se connecte
+    virtual void prewarmConnection() {}
+    // Ferme la connexion et annule une reprise en cours
+    virtual void disconnect();
     virtual void resetConnection();
 
     [[nodiscard]] bool isConnected() const;
     [[nodiscard]] bool isConnecting() const;
+    // État courant de la connexion, New tant qu'aucune connexion n'a été créée
+    [[nodiscard]] rtc::PeerConnection::State getState() const;
 
     [[nodiscard]] juce::String getSignalingStateLabel() const;
     [[nodiscard]] juce::String getIceCandidateStateLabel() const;
 
+    // Vide tant qu'aucune session n'est connue (connexion qui suit la session en cours)
+    [[nodiscard]] std::string getSessionId() const;
+
 protected:
-    std::shared_ptr<rtc::PeerConnection> peerConnection;
+    // Contexte de l'instance du plugin : réglages audio et bus d'événements
+    EngineContext& context;
+
+    // Connexion courante, remplacée par le pré-chauffage (thread de travail), la connexion (message thread) ou
+    // une offre reçue (thread de la signalisation) : toujours lue par copie, jamais directement
+    [[nodiscard]] std::shared_ptr<rtc::PeerConnection> getPeerConnection() const;
+    // Copie de la connexion si owner est toujours la connexion courante, nullptr pour le rappel d'une
+    // connexion remplacée depuis
+    [[nodiscard]] std::shared_ptr<rtc::PeerConnection> getPeerConnectionIfCurrent(const rtc::PeerConnection* owner) const;
+    // Installe next : l'ancienne connexion est fermée et ses rappels retirés, ses candidats en attente oubliés
+    void replacePeerConnection(std::shared_ptr<rtc::PeerConnection> next);
+    // Candidat local gardé jusqu'à la description distante ; ignoré si owner n'est plus la connexion courante
+    void addPendingCandidate(const rtc::PeerConnection* owner, const rtc::Candidate& candidate);
+    std::vector<rtc::Candidate> takePendingCandidates();
+    // À appeler en tête du destructeur d'une classe dérivée : attend les rappels de libdatachannel en cours,
+    // aucun n'entre plus ensuite
+    void stopConnectionCallbacks();
+    // Capturé par les rappels de libdatachannel (voir LivenessToken)
+    LivenessToken callbackLiveness;
+
     void notifyRTCStateChanged() const;
-    void onOngoingSessionChanged(const OngoingSessionChangedEvent& event) override;
+    // Les messages d'une route arrivent pour toutes les sessions : seuls ceux de la nôtre sont traités
+    [[nodiscard]] bool isForThisSession(const MessageWsReceivedEvent& event) const;
+    void onOngoingSessionChanged(const OngoingSessionChangedEvent& event);
+    // À appeler dans le destructeur d'une classe dérivée qui surcharge prewarmConnection()
+    void stopSessionUpdates();
 
     bool sendCandidateToRemote(const rtc::Candidate& candidate);
     bool sendOfferToRemote(const rtc::Description &sdp);
     bool sendAnswerToRemote(const rtc::Description &sdp);
+
+    // Reprise après une coupure ICE (thread de libdatachannel) : Disconnected laisse un court délai de grâce
+    // à ICE pour se rétablir seul, Failed relance tout de suite, Connected arrête la reprise en cours
+    void onIceStateChangedForRecovery(rtc::PeerConnection::IceState state);
     void attemptReconnect();
 
     // Ice Reconnection
-    int reconnectAttempts = 0;
-    const int maxReconnectAttempts = 5;
-    const int reconnectDelayMs = 2000;
+    // Seule la connexion est reconstruite : encodeur, numéros de séquence RTP et tampon de gigue de l'autre
+    // côté vivent hors de la PeerConnection et sont conservés
+    static constexpr int disconnectGraceMs = 300;
+    std::mutex reconnectMutex;
+    ReconnectBackoff reconnectBackoff;
     ReconnectTimer reconnectTimer;
-    std::vector<rtc::Candidate> pendingCandidates;
 
 private:
-    WebSocketService meloWebSocketService;
+    mutable std::mutex peerConnectionMutex;
+    std::shared_ptr<rtc::PeerConnection> peerConnection;
+    std::vector<rtc::Candidate> pendingCandidates;
+
+    // Route propre à la connexion qui suit la session en cours ; sinon celle de l'appelant
+    std::unique_ptr<WebSocketService> ownWebSocketService;
+    WebSocketService& meloWebSocketService;
     std::optional<PopulatedSession> ongoingSession;
+    EventSubscription ongoingSessionSubscription;
 };
 
 
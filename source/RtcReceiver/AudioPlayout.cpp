@@ -0,0 +1,313 @@
+#include "AudioPlayout.h"
+#include <opus.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace {
+    // Remise à zéro demandée par le thread réseau et toujours pas faite par pull() au-delà de ce délai (transport
+    // de l'hôte à l'arrêt, processBlock plus appelé) : le thread réseau l'exécute lui-même
+    constexpr auto resetTimeout = std::chrono::milliseconds(100);
+
+    // Trame Opus la plus longue : 120 ms
+    constexpr int maxFrameSamples = AudioPlayout::sampleRate * 120 / 1000;
+    // Durée maximale pendant laquelle la dissimulation prolonge le son, en s'estompant, quand le flux s'interrompt
+    constexpr int maxBridgeSamples = AudioPlayout::sampleRate * 200 / 1000;
+
+    // Gain de la dissimulation après bridgedSamples échantillons : de 1 au début de la coupure à 0 à maxBridgeSamples
+    float bridgeGain(const int bridgedSamples) {
+        return 1.0f - static_cast<float>(std::min(bridgedSamples, maxBridgeSamples)) / static_cast<float>(maxBridgeSamples);
+    }
+}
+
+AudioPlayout::AudioPlayout() : decodeBuffer(static_cast<size_t>(maxFrameSamples * numChannels), 0.0f),
+                               crossfadeBuffer(static_cast<size_t>(maxFrameSamples * numChannels), 0.0f) {
+    // Sans verrouillage : les hôtes construisent le plugin en boucle pendant le scan
+    allocateOutputStage(sampleRate, maxFrameSamples);
+}
+
+void AudioPlayout::prepare(const double newHostSampleRate, const int maxBlockSize) {
+    // Le thread réseau peut être en train d'appliquer une remise à zéro restée en attente : il finit d'abord
+    bool busy = false;
+    while (!playoutBusy.compare_exchange_weak(busy, true, std::memory_order_acquire)) {
+        busy = false;
+        std::this_thread::yield();
+    }
+    // Seul l'étage de sortie dépend de l'hôte : rééchantillonneur et file de sortie repartent à vide (leurs
+    // prepare() les remettent à zéro). Tampon de gigue et décodeur, toujours à 48 kHz, gardent le flux reçu
+    allocateOutputStage(newHostSampleRate, maxBlockSize);
+    playoutBusy.store(false, std::memory_order_release);
+
+    // Le verrouillage suit les tampons réalloués ; refusé (RLIMIT_MEMLOCK), ils restent simplement paginables.
+    // Les nouvelles régions sont verrouillées avant de relâcher les anciennes : les pages communes le restent
+    RealtimeThreads::LockedMemory workingSet;
+    workingSet.lock(&jitterBuffer, sizeof(jitterBuffer));
+    workingSet.lockContainer(decodeBuffer);
+    workingSet.lockContainer(crossfadeBuffer);
+    workingSet.lockContainer(resampleBuffer);
+    workingSet.lock(outputFifo.getStorage(), outputFifo.getCapacity() * sizeof(float));
+    lockedMemory = std::move(workingSet);
+}
+
+void AudioPlayout::allocateOutputStage(const double newHostSampleRate, const int maxBlockSize) {
+    hostSampleRate = newHostSampleRate;
+    resampler.prepare(sampleRate, hostSampleRate, maxFrameSamples);
+    resampleBuffer.assign(static_cast<size_t>(resampler.getMaxOutputSamples() * numChannels), 0.0f);
+
+    // Un bloc de l'hôte plus une trame rééchantillonnée, avec de la marge
+    const auto capacity = static_cast<size_t>(maxBlockSize + resampler.getMaxOutputSamples()) * numChannels * 2;
+    outputFifo.prepare(capacity);
+}
+
+void AudioPlayout::pushPacket(const RtpPacketView& packet) {
+    const unsigned char* payload = packet.getPayloadData();
+    const size_t size = packet.getPayload().size();
+    const int numSamples = opus_packet_get_nb_samples(payload, static_cast<opus_int32>(size), sampleRate);
+    insertPayload(PayloadFormat::Opus, packet.getSequenceNumber(), packet.getSsrc(), packet.getTimestamp(), payload, size, numSamples);
+}
+
+void AudioPlayout::pushPcmFrame(const uint32_t streamId, const uint16_t sequenceNumber, const uint32_t timestamp,
+                                const float* samples, const int numSamples) {
+    insertPayload(PayloadFormat::Pcm, sequenceNumber, streamId, timestamp, reinterpret_cast<const unsigned char*>(samples),
+                  static_cast<size_t>(numSamples * numChannels) * sizeof(float), numSamples);
+}
+
+void AudioPlayout::insertPayload(const PayloadFormat format, const uint16_t sequenceNumber, const uint32_t ssrc,
+                                 const uint32_t timestamp, const unsigned char* payload, const size_t size, const int numSamples) {
+    if (resetPending.load(std::memory_order_acquire)) {
+        // Sans thread audio pour l'appliquer, la remise à zéro se fait ici ; pull() est alors tenu à l'écart
+        const auto requestedAt = std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(resetRequestedAt.load(std::memory_order_relaxed)));
+        if (std::chrono::steady_clock::now() - requestedAt < resetTimeout || !tryApplyPendingResetFromProducer()) {
+            return;
+        }
+    }
+
+    // Extension 64 bits, doublons et redémarrage du flux : le tampon de gigue remet ensuite les paquets dans l'ordre
+    int64_t sequence = 0;
+    const auto result = sequenceTracker.update(sequenceNumber, ssrc, sequence);
+    if (format != streamFormat || result == RtpSequenceTracker::Result::Restarted) {
+        // Nouveau flux (ou passage du transport local au réseau et inversement) : le thread audio vide
+        // le tampon et adopte le nouveau format, les paquets sont ignorés jusque-là
+        streamFormat = format;
+        requestReset(format);
+        return;
+    }
+    if (result != RtpSequenceTracker::Result::Accepted) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    const auto arrivalTime = std::chrono::duration_cast<std::chrono::microseconds>(now).count() * sampleRate / 1000000;
+    jitterBuffer.insert(sequence, timestamp, payload, size, numSamples, arrivalTime);
+}
+
+size_t AudioPlayout::pull(float* destination, const size_t numSamples) {
+    // Le thread réseau applique une remise à zéro restée en attente : ce bloc reste silencieux, sans attendre
+    bool busy = false;
+    if (!playoutBusy.compare_exchange_strong(busy, true, std::memory_order_acquire)) {
+        return 0;
+    }
+    applyPendingReset();
+
+    while (outputFifo.getNumReady() < numSamples * numChannels) {
+        if (!decodeNextFrame()) {
+            break;
+        }
+    }
+    const size_t samplesRead = outputFifo.read(destination, numSamples * numChannels) / numChannels;
+    updateDriftCorrection(samplesRead);
+    playoutBusy.store(false, std::memory_order_release);
+    return samplesRead;
+}
+
+// Thread réseau uniquement : tant que la remise à zéro est en attente, insertPayload() n'entre plus dans le
+// tampon de gigue, que le thread audio peut donc vider sans course avec insert()
+void AudioPlayout::requestReset(const PayloadFormat format) noexcept {
+    pendingFormat.store(format, std::memory_order_relaxed);
+    resetRequestedAt.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    resetPending.store(true, std::memory_order_release);
+}
+
+bool AudioPlayout::tryApplyPendingResetFromProducer() {
+    bool busy = false;
+    if (!playoutBusy.compare_exchange_strong(busy, true, std::memory_order_acquire)) {
+        return false;
+    }
+    applyPendingReset();
+    playoutBusy.store(false, std::memory_order_release);
+    return true;
+}
+
+bool AudioPlayout::decodeNextFrame() {
+    // Le flux reprend après une coupure (changement de réseau, reconstruction de la connexion) :
+    // le décodeur et le tampon de gigue sont conservés, seul le retard accumulé est abandonné
+    jitterBuffer.applyResync();
+    if (bridgedSamples > 0 && jitterBuffer.getHighestSequence() >= jitterBuffer.getNextSequence()) {
+        resumeAfterOutage();
+    }
+
+    const auto bufferedSamples = jitterBuffer.getBufferedSamples();
+    const auto targetDelay = jitterBuffer.getTargetDelaySamples();
+
+    if (!playing) {
+        // Mise en tampon jusqu'au délai cible avant de (re)commencer la lecture
+        if (bufferedSamples < targetDelay) {
+            return false;
+        }
+        playing = true;
+    }
+
+    // Trop d'avance sur la cible (gigue retombée) : on abandonne le paquet le plus ancien pour réduire la latence
+    if (bufferedSamples > targetDelay + 2 * jitterBuffer.getFrameSamples()) {
+        jitterBuffer.skip();
+        latencyDrops.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int decodedSamples = 0;
+    switch (jitterBuffer.consume([this, &decodedSamples](const JitterBuffer::Packet& packet) {
+        decodedSamples = decodePayload(packet);
+    })) {
+        case JitterBuffer::PopResult::Packet:
+            if (decodedSamples > 0) {
+                break;
+            }
+            decodedSamples = decoder.conceal_float(decodeBuffer.data(), jitterBuffer.getFrameSamples());
+            concealedFrames.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case JitterBuffer::PopResult::Missing: {
+            // Le paquet suivant transporte la FEC de la trame perdue : on la récupère sans le consommer,
+            // sinon dissimulation (PLC) à partir de l'état du décodeur
+            // Le PCM n'a pas de FEC ; la dissimulation d'un décodeur Opus qui n'a rien décodé est du silence
+            const int frameSamples = jitterBuffer.getFrameSamples();
+            const bool hasNextPacket = playoutFormat == PayloadFormat::Opus && jitterBuffer.peek([this, &decodedSamples, frameSamples](const JitterBuffer::Packet& packet) {
+                decodedSamples = decoder.decode_fec_float(packet.payload.data(), packet.size, decodeBuffer.data(), frameSamples);
+            });
+            if (hasNextPacket && decodedSamples > 0) {
+                recoveredFrames.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                decodedSamples = decoder.conceal_float(decodeBuffer.data(), frameSamples);
+                concealedFrames.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        }
+        case JitterBuffer::PopResult::Empty: {
+            // Plus rien à jouer : plutôt qu'un silence brutal, la dissimulation prolonge le son en s'estompant,
+            // puis la lecture s'arrête et se remet en tampon
+            if (bridgedSamples >= maxBridgeSamples) {
+                playing = false;
+                rebuffers.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (bridgedSamples == 0) {
+                outages.fetch_add(1, std::memory_order_relaxed);
+            }
+            decodedSamples = decoder.conceal_float(decodeBuffer.data(), jitterBuffer.getFrameSamples());
+            if (decodedSamples <= 0) {
+                return false;
+            }
+            for (int i = 0; i < decodedSamples; ++i) {
+                const float gain = bridgeGain(bridgedSamples + i);
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    decodeBuffer[static_cast<size_t>(i * numChannels + channel)] *= gain;
+                }
+            }
+            bridgedSamples += decodedSamples;
+            concealedFrames.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    if (decodedSamples <= 0) {
+        return false;
+    }
+    if (crossfadeSamples > 0) {
+        applyCrossfade(decodedSamples);
+    }
+    const int resampledSamples = resampler.process(decodeBuffer.data(), decodedSamples, resampleBuffer.data());
+    const auto resampled = static_cast<size_t>(resampledSamples * numChannels);
+    if (!outputFifo.write(resampleBuffer.data(), resampled)) {
+        // Sortie pleine : les échantillons les plus anciens sont abandonnés plutôt que la trame qui vient d'être décodée
+        outputOverruns.fetch_add(1, std::memory_order_relaxed);
+        outputFifo.writeDropOldest(resampleBuffer.data(), resampled);
+    }
+    return true;
+}
+
+int AudioPlayout::decodePayload(const JitterBuffer::Packet& packet) {
+    if (playoutFormat == PayloadFormat::Opus) {
+        return decoder.decode_float(packet.payload.data(), packet.size, decodeBuffer.data(), maxFrameSamples);
+    }
+    const auto numSamples = std::min(packet.size / (sizeof(float) * numChannels), static_cast<size_t>(maxFrameSamples));
+    std::memcpy(decodeBuffer.data(), packet.payload.data(), numSamples * numChannels * sizeof(float));
+    return static_cast<int>(numSamples);
+}
+
+void AudioPlayout::updateDriftCorrection(const size_t numSamplesPlayed) {
+    if (!playing || numSamplesPlayed == 0) {
+        return;
+    }
+
+    // Remplissage en échantillons à 48 kHz : paquets reçus mais pas encore décodés (écart entre le dernier
+    // timestamp RTP reçu et celui en cours de lecture) plus ce qui attend déjà à la sortie
+    const double hostToStream = sampleRate / hostSampleRate;
+    const double buffered = static_cast<double>(jitterBuffer.getBufferedSamples())
+                            + static_cast<double>(outputFifo.getNumReady() / numChannels) * hostToStream;
+    const double target = static_cast<double>(jitterBuffer.getTargetDelaySamples());
+
+    const double ratio = driftEstimator.update(buffered, target, static_cast<double>(numSamplesPlayed) * hostToStream);
+    resampler.setRatio(ratio);
+    driftCorrectionPpm.store(driftEstimator.getCorrectionPpm(), std::memory_order_relaxed);
+}
+
+void AudioPlayout::resumeAfterOutage() {
+    // Les paquets de la période déjà couverte par la dissimulation sont abandonnés d'un coup :
+    // la lecture repart avec le délai cible, pas avec le retard de la coupure
+    const int64_t frameSamples = std::max(1, jitterBuffer.getFrameSamples());
+    const int64_t targetPackets = std::max<int64_t>(1, jitterBuffer.getTargetDelaySamples() / frameSamples);
+    jitterBuffer.skipTo(jitterBuffer.getHighestSequence() + 1 - targetPackets);
+
+    // Trame de dissimulation qui aurait suivi, fondue avec la première trame reçue ; inutile si le son
+    // s'était déjà complètement estompé (la reprise se fait alors par un simple fondu d'entrée)
+    const float gain = bridgeGain(bridgedSamples);
+    crossfadeSamples = 0;
+    if (gain > 0.0f) {
+        crossfadeSamples = std::max(0, decoder.conceal_float(crossfadeBuffer.data(), static_cast<int>(frameSamples)));
+        for (int i = 0; i < crossfadeSamples * numChannels; ++i) {
+            crossfadeBuffer[static_cast<size_t>(i)] *= gain;
+        }
+    } else {
+        std::fill(crossfadeBuffer.begin(), crossfadeBuffer.end(), 0.0f);
+        crossfadeSamples = static_cast<int>(frameSamples);
+    }
+    bridgedSamples = 0;
+}
+
+void AudioPlayout::applyCrossfade(const int numSamples) {
+    const int length = std::min(numSamples, crossfadeSamples);
+    for (int i = 0; i < length; ++i) {
+        const float fadeIn = static_cast<float>(i + 1) / static_cast<float>(length);
+        for (int channel = 0; channel < numChannels; ++channel) {
+            const auto index = static_cast<size_t>(i * numChannels + channel);
+            decodeBuffer[index] = decodeBuffer[index] * fadeIn + crossfadeBuffer[index] * (1.0f - fadeIn);
+        }
+    }
+    crossfadeSamples = 0;
+}
+
+void AudioPlayout::applyPendingReset() {
+    if (!resetPending.load(std::memory_order_acquire)) {
+        return;
+    }
+    jitterBuffer.reset();
+    outputFifo.reset();
+    decoder.reset();
+    resampler.reset();
+    driftEstimator.reset();
+    playoutFormat = pendingFormat.load(std::memory_order_relaxed);
+    playing = false;
+    bridgedSamples = 0;
+    crossfadeSamples = 0;
+    resetPending.store(false, std::memory_order_release);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "../Common/AdaptiveResampler.h"
+#include "../Common/ClockDriftEstimator.h"
+#include "../Common/JitterBuffer.h"
+#include "../Common/OpusDecoderWrapper.h"
+#include "../Common/RealtimeThreads.h"
+#include "../Common/RTPWrapper.h"
+#include "../Common/RtpSequenceTracker.h"
+#include "../Common/SpscAudioFifo.h"
+
+// Chaîne de lecture côté réception, détenue par MainAudioProcessor.
+// Le thread réseau dépose les paquets RTP dans le tampon de gigue (pushPacket) ;
+// le thread audio tire les échantillons (pull) et ne décode qu'à la demande, au moment où ils sont joués.
+// Les trames décodées à 48 kHz sont converties à la fréquence de l'hôte par un rééchantillonneur
+// dont le rapport fin compense la dérive entre l'horloge de l'émetteur et celle de l'hôte.
+// Une coupure du flux est comblée par la dissimulation Opus qui s'estompe, puis la reprise est fondue
+// avec la dernière trame dissimulée : ni clic ni remise à zéro du décodeur.
+// Le transport local (LoopbackRing) dépose des trames PCM non compressées (pushPcmFrame) qui suivent le même
+// chemin : tampon de gigue, rééchantillonnage et compensation de dérive. Un seul producteur à la fois.
+class AudioPlayout {
+public:
+    // Format des charges du flux courant
+    enum class PayloadFormat { Opus, Pcm };
+
+    AudioPlayout();
+
+    // Alloue les tampons pour la fréquence de l'hôte (prepareToPlay, jamais pendant pull()) et les verrouille en
+    // mémoire avec le tampon de gigue. Peut être rappelé en cours de session : le flux reçu n'est pas interrompu.
+    void prepare(double hostSampleRate, int maxBlockSize);
+
+    // Thread réseau : la charge Opus est copiée directement du paquet reçu dans le tampon de gigue
+    void pushPacket(const RtpPacketView& packet);
+
+    // Thread réseau (ou de lecture du transport local) : trame float mono à 48 kHz, au plus
+    // JitterBuffer::maxPayloadSize octets. streamId joue le rôle du SSRC : un nouvel identifiant démarre un nouveau flux.
+    void pushPcmFrame(uint32_t streamId, uint16_t sequenceNumber, uint32_t timestamp, const float* samples, int numSamples);
+
+    // Thread audio : écrit au plus numSamples échantillons mono à la fréquence de l'hôte, renvoie le nombre écrit
+    size_t pull(float* destination, size_t numSamples);
+
+    [[nodiscard]] double getJitterMs() const noexcept { return jitterBuffer.getJitterMs(); }
+    // Correction de vitesse appliquée pour compenser la dérive d'horloge, en ppm
+    [[nodiscard]] double getDriftCorrectionPpm() const noexcept { return driftCorrectionPpm.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t getNumConcealedFrames() const noexcept { return concealedFrames.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t getNumRecoveredFrames() const noexcept { return recoveredFrames.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t getNumRebuffers() const noexcept { return rebuffers.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t getNumLatencyDrops() const noexcept { return latencyDrops.load(std::memory_order_relaxed); }
+    // Interruptions du flux comblées par la dissimulation (coupure réseau, reprise de la connexion)
+    [[nodiscard]] uint64_t getNumOutages() const noexcept { return outages.load(std::memory_order_relaxed); }
+    // Trames décodées qui n'ont pas trouvé de place à la sortie (les plus anciens échantillons ont été abandonnés)
+    [[nodiscard]] uint64_t getNumOutputOverruns() const noexcept { return outputOverruns.load(std::memory_order_relaxed); }
+
+    // Pertes, doublons et réordonnancements du flux courant
+    [[nodiscard]] RtpSequenceTracker::Statistics getSequenceStatistics() const noexcept { return sequenceTracker.getStatistics(); }
+    // Paquets arrivés après que leur trame a déjà été jouée ou dissimulée
+    [[nodiscard]] uint64_t getNumLatePackets() const noexcept { return jitterBuffer.getNumLatePackets(); }
+
+    static constexpr int sampleRate = 48000;
+    static constexpr int numChannels = 1;
+
+private:
+    // Étage de sortie à la fréquence de l'hôte, seule partie qui en dépend
+    void allocateOutputStage(double newHostSampleRate, int maxBlockSize);
+    // Thread réseau : dépose une charge dans le tampon de gigue après suivi de la séquence
+    void insertPayload(PayloadFormat format, uint16_t sequenceNumber, uint32_t ssrc, uint32_t timestamp,
+                       const unsigned char* payload, size_t size, int numSamples);
+    // Thread audio : charge en échantillons dans decodeBuffer, selon le format du flux
+    int decodePayload(const JitterBuffer::Packet& packet);
+    bool decodeNextFrame();
+    void resumeAfterOutage();
+    void applyCrossfade(int numSamples);
+    // Thread réseau uniquement (voir insertPayload)
+    void requestReset(PayloadFormat format) noexcept;
+    void applyPendingReset();
+    // Thread réseau : applique la remise à zéro si pull() n'est pas en cours
+    bool tryApplyPendingResetFromProducer();
+    void updateDriftCorrection(size_t numSamplesPlayed);
+
+    JitterBuffer jitterBuffer { sampleRate };
+    OpusDecoderWrapper decoder { sampleRate, numChannels };
+    AdaptiveResampler resampler;
+    ClockDriftEstimator driftEstimator { sampleRate };
+    SpscAudioFifo outputFifo; // à la fréquence de l'hôte
+    std::vector<float> decodeBuffer;
+    std::vector<float> resampleBuffer;
+    // Dissimulation à fondre avec la première trame reçue après une coupure
+    std::vector<float> crossfadeBuffer;
+    double hostSampleRate = sampleRate;
+    // Jeu de travail du thread audio : le tampon de gigue et les tampons de prepare()
+    RealtimeThreads::LockedMemory lockedMemory;
+    bool playing = false;
+    // Échantillons dissimulés depuis le début de la coupure en cours, 0 si le flux est continu
+    int bridgedSamples = 0;
+    int crossfadeSamples = 0;
+
+    // Mis à jour par le thread réseau uniquement
+    RtpSequenceTracker sequenceTracker;
+    PayloadFormat streamFormat = PayloadFormat::Opus;
+    // Format des paquets du tampon de gigue, changé avec lui par applyPendingReset() (thread audio)
+    PayloadFormat playoutFormat = PayloadFormat::Opus;
+    std::atomic<PayloadFormat> pendingFormat { PayloadFormat::Opus };
+
+    // Demandé par le thread réseau (nouveau flux) ou par prepare(), exécuté par le thread audio au début de
+    // pull(), ou par le thread réseau lui-même après resetTimeout si pull() n'est plus appelé
+    std::atomic<bool> resetPending { false };
+    std::atomic<std::chrono::steady_clock::rep> resetRequestedAt { 0 };
+    // Tenu par pull() pendant la lecture, ou par le thread réseau pendant qu'il applique la remise à zéro
+    std::atomic<bool> playoutBusy { false };
+    std::atomic<uint64_t> outputOverruns { 0 };
+
+    std::atomic<uint64_t> concealedFrames { 0 };
+    std::atomic<uint64_t> recoveredFrames { 0 };
+    std::atomic<uint64_t> rebuffers { 0 };
+    std::atomic<uint64_t> latencyDrops { 0 };
+    std::atomic<uint64_t> outages { 0 };
+    std::atomic<double> driftCorrectionPpm { 0.0 };
+};
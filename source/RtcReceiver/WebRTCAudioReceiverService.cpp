@@ -5,59 +5,109 @@
 #include <rtc/rtc.hpp>
 #include "../Api/SocketRoutes.h"
 #include "../Utils/VectorUtils.h"
-int error = 0;
-
-WebRTCAudioReceiverService::WebRTCAudioReceiverService(): WebRTCReceiverConnexionHandler(
-                                                              WsRoute::GetOngoingSessionRTCVoice),
-                                                          opusCodec(AudioSettings::getInstance().getOpusSampleRate(),
-                                                                    AudioSettings::getInstance().getNumChannels(),
-                                                                    AudioSettings::getInstance().getLatency(),
-                                                                    AudioSettings::getInstance().getOpusBitRate()),
-                                                          resampler(AudioSettings::getInstance().getSampleRate(),
-                                                                    AudioSettings::getInstance().getOpusSampleRate(),
-                                                                    AudioSettings::getInstance().getNumChannels()),
-                                                          decoder(opus_decoder_create(48000, 1, &error))
+#include <chrono>
+#include <vector>
+
+namespace {
+    constexpr auto loopbackPollInterval = std::chrono::milliseconds(1);
+    // Sans émetteur local, l'anneau n'est relu que pour le battement de cœur (au moins toutes les peerTimeoutMs / 2)
+    // et pour détecter une arrivée : pas de réveil à la milliseconde par instance pour rien
+    constexpr auto loopbackIdlePollInterval = std::chrono::milliseconds(LoopbackRing::peerTimeoutMs / 5);
+    // Une trame de l'anneau (LoopbackRing::frameSamples à 48 kHz)
+    constexpr auto loopbackFrameDuration = std::chrono::microseconds(LoopbackRing::frameSamples * 1000000LL / LoopbackRing::sampleRate);
+}
+
+WebRTCAudioReceiverService::WebRTCAudioReceiverService(EngineContext& engineContext, AudioPlayout& audioPlayout): WebRTCReceiverConnexionHandler(
+                                                              WsRoute::GetOngoingSessionRTCVoice, engineContext),
+                                                          audioPlayout(audioPlayout)
 {
-    if (error != OPUS_OK) {
-        std::cerr << "Échec de l'initialisation du décodeur Opus: " << opus_strerror(error) << std::endl;
-    }
+    audioBlockSubscription = engineContext.getEventManager().subscribe<AudioBlockReceivedEvent>(
+        [this](const AudioBlockReceivedEvent &event) { onAudioBlockReceived(event); });
+    loopbackSessionSubscription = engineContext.getEventManager().subscribe<OngoingSessionChangedEvent>(
+        [this](const OngoingSessionChangedEvent &event) { onSessionChangedForLoopback(event); });
 }
 
 WebRTCAudioReceiverService::~WebRTCAudioReceiverService() {
+    loopbackSessionSubscription.reset();
+    audioBlockSubscription.reset();
+    stopLoopback();
 }
 
 void WebRTCAudioReceiverService::onAudioBlockReceived(const AudioBlockReceivedEvent &event){
-    rtc::message_variant audioBlock = event.data;
-    uint64_t timestamp = event.timestamp;
+    const rtc::message_variant& audioBlock = event.data;
 
     if (!std::holds_alternative<rtc::binary>(audioBlock))
         return;
 
+    // Analyse de l'en-tête en place : CSRC, extensions et bourrage sont pris en compte, sans copie
     const rtc::binary& msg = std::get<rtc::binary>(audioBlock);
-    size_t rtpHeaderSize = 28; // Vérifie que c'est bien la bonne taille pour ton cas
-    if (msg.size() < rtpHeaderSize)
-        return; // Erreur : paquet trop petit
-
-    rtc::binary encodedData(msg.begin() + rtpHeaderSize, msg.end());
-    std::vector<unsigned char> encoded(encodedData.size());
-    std::transform(encodedData.begin(), encodedData.end(), encoded.begin(), [](std::byte b) {
-        return static_cast<unsigned char>(b);
-    });
-
-    auto packetFrameSize = opus_packet_get_samples_per_frame(encoded.data(), 48000);
-    auto nbChannels = opus_packet_get_nb_channels(encoded.data());
-    juce::ignoreUnused(packetFrameSize, nbChannels);
-
-    auto nbSamples = opus_packet_get_nb_samples(encoded.data(), encoded.size(), 48000);
-    juce::Logger::outputDebugString("Audio block received with " + std::to_string(encoded.size()) + " bytes");
-
-    std::vector<float> pcmBuffer(nbSamples, 0.0f);
-    int frameSize = opus_decode_float(decoder, encoded.data(), encoded.size(), pcmBuffer.data(), nbSamples, 0);
-    if (frameSize < 0) {
-        std::cerr << "Erreur lors du décodage Opus : " << opus_strerror(frameSize) << std::endl;
+    const auto packet = RtpPacketView::parse(msg);
+    if (!packet)
+        return; // Erreur : paquet RTP invalide
+
+    // Le décodage a lieu plus tard, sur le thread audio, quand le paquet doit être joué
+    const std::lock_guard lock(producerMutex);
+    if (!loopbackActive.load(std::memory_order_relaxed)) {
+        audioPlayout.pushPacket(*packet);
+    }
+}
+
+void WebRTCAudioReceiverService::onSessionChangedForLoopback(const OngoingSessionChangedEvent &event) {
+    if (event.ongoingSession.has_value()) {
+        startLoopback(event.ongoingSession->_id);
+    } else {
+        stopLoopback();
+    }
+}
+
+void WebRTCAudioReceiverService::startLoopback(const juce::String &sessionId) {
+    const std::lock_guard lock(loopbackMutex);
+    // La session est relue régulièrement : seul un changement de session rouvre l'anneau
+    if (sessionId == loopbackSessionId && loopbackRing.isOpen()) {
+        return;
+    }
+    loopbackSessionId = sessionId;
+    loopbackStream.reset();
+    if (!loopbackRing.open(LoopbackRing::getRingFile(sessionId), LoopbackRing::Role::Reader)) {
+        juce::Logger::outputDebugString("Transport local indisponible pour la session " + sessionId);
         return;
     }
+    loopbackStream = StreamWorkerPool::acquireShared()->registerStream([this] { return runLoopbackJob(); });
+    loopbackStream.scheduleNow(loopbackPollInterval);
+}
+
+void WebRTCAudioReceiverService::stopLoopback() {
+    const std::lock_guard lock(loopbackMutex);
+    // Attend la fin d'une lecture en cours ; aucune ne démarre ensuite
+    loopbackStream.reset();
+    loopbackRing.close();
+    loopbackSessionId.clear();
+    loopbackActive = false;
+}
+
+std::optional<StreamWorkerPool::Run> WebRTCAudioReceiverService::runLoopbackJob() {
+    loopbackRing.heartbeat();
+
+    const bool peerPresent = loopbackRing.isPeerPresent();
+    if (peerPresent != loopbackActive.load(std::memory_order_relaxed)) {
+        juce::Logger::outputDebugString(juce::String::fromUTF8(peerPresent ? "Émetteur local détecté : transport local"
+                                                                           : "Émetteur local parti : retour au réseau"));
+        const std::lock_guard lock(producerMutex);
+        loopbackActive = peerPresent;
+    }
 
-    pcmBuffer.resize(frameSize);
-    EventManager::getInstance().notifyOnAudioBlockReceivedDecoded(AudioBlockReceivedDecodedEvent{pcmBuffer, timestamp});
+    if (peerPresent) {
+        const std::lock_guard lock(producerMutex);
+        LoopbackRing::FrameInfo info;
+        while (loopbackRing.read(info, loopbackFrame.data())) {
+            // L'horloge de la trame suit son index : 48 kHz comme le RTP, une séquence continue d'un émetteur à l'autre
+            audioPlayout.pushPcmFrame(info.writerId, static_cast<uint16_t>(info.index),
+                                      static_cast<uint32_t>(info.index * LoopbackRing::frameSamples),
+                                      loopbackFrame.data(), info.numSamples);
+        }
+    }
+    // L'anneau n'a pas de réveil entre processus : une lecture à la milliseconde garde le transport sous la milliseconde
+    // en moyenne ; la trame lue doit être dans le tampon de gigue avant la suivante
+    const auto releaseTime = StreamWorkerPool::Clock::now() + (peerPresent ? loopbackPollInterval : loopbackIdlePollInterval);
+    return StreamWorkerPool::Run{releaseTime, releaseTime + loopbackFrameDuration};
 }
@@ -1,27 +1,49 @@
 #pragma once
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
+#include <vector>
 #include <juce_core/juce_core.h>
 
-#include "../Common/OpusEncoderWrapper.h"
 #include "../Api/WebSocketService.h"
-#include "../Common/EventListener.h"
 
-#include "../Common/ResamplerWrapper.h"
 #include "WebRTCReceiverConnexionHandler.h"
+#include "AudioPlayout.h"
+#include "../Common/LoopbackRing.h"
+#include "../Common/StreamWorkerPool.h"
 
 class WebRTCAudioReceiverService final : public WebRTCReceiverConnexionHandler {
 public:
-    WebRTCAudioReceiverService();
+    WebRTCAudioReceiverService(EngineContext& engineContext, AudioPlayout& audioPlayout);
     ~WebRTCAudioReceiverService() override;
 
+    // Vrai tant que l'audio arrive par le transport local : le flux RTP est alors ignoré
+    [[nodiscard]] bool isUsingLoopback() const noexcept { return loopbackActive.load(std::memory_order_relaxed); }
+
 private:
-    void onAudioBlockReceived(const AudioBlockReceivedEvent &event) override;
-    std::vector<float> decodeNextAudioPacket();
-    OpusEncoderWrapper opusCodec;
-    OpusDecoder* decoder;
-    ResamplerWrapper resampler;
-    // Buffer pour stocker les paquets audio triés par timestamp
-    std::map<uint64_t, rtc::binary> audioBuffer;
-    std::mutex bufferMutex;
+    void onAudioBlockReceived(const AudioBlockReceivedEvent &event);
+    void onSessionChangedForLoopback(const OngoingSessionChangedEvent &event);
+    void startLoopback(const juce::String &sessionId);
+    void stopLoopback();
+    // Une lecture de l'anneau sur la réserve partagée, reprogrammée toutes les millisecondes
+    std::optional<StreamWorkerPool::Run> runLoopbackJob();
+
+    // Tampon de gigue et décodage à la demande, détenus par MainAudioProcessor
+    AudioPlayout& audioPlayout;
+    // Un seul producteur à la fois pour le tampon de gigue : thread réseau ou tâche du transport local
+    std::mutex producerMutex;
+
+    // Transport local : émetteur de la même session sur la même machine (voir LoopbackRing)
+    std::mutex loopbackMutex;
+    LoopbackRing loopbackRing;
+    juce::String loopbackSessionId;
+    std::vector<float> loopbackFrame = std::vector<float>(LoopbackRing::frameSamples, 0.0f);
+    // Lecture de l'anneau, exécutée par la réserve de threads commune au processus
+    StreamWorkerPool::Stream loopbackStream;
+    std::atomic<bool> loopbackActive { false };
+
+    // Livraison synchrone sur le thread réseau : le paquet est poussé dans le tampon de gigue sans détour
+    EventSubscription audioBlockSubscription;
+    EventSubscription loopbackSessionSubscription;
 };
@@ -2,93 +2,130 @@
 #include "../Common/EventManager.h"
 #include "../ThirdParty/json.hpp"
 #include "../Api/SocketRoutes.h"
+#include "../Rtc/RtcRuntime.h"
 #include <opus.h>
 #include "../Utils/VectorUtils.h"
 
-WebRTCReceiverConnexionHandler::WebRTCReceiverConnexionHandler(const WsRoute wsRoute)
-    : WebRTCConnexionState(wsRoute) {
-    setupConnection();
+WebRTCReceiverConnexionHandler::WebRTCReceiverConnexionHandler(const WsRoute wsRoute, EngineContext &engineContext)
+    : WebRTCConnexionState(wsRoute, engineContext) {
+    // La connexion est créée à la réception de la première offre (handleOffer), pas à la construction
+    wsMessageSubscription = engineContext.getEventManager().subscribe<MessageWsReceivedEvent>(
+        [this](const MessageWsReceivedEvent &event) { onWsMessageReceived(event); });
 }
 
 WebRTCReceiverConnexionHandler::~WebRTCReceiverConnexionHandler() {
+    // Avant tout membre : les rappels de libdatachannel en cours se terminent, aucun n'entre plus
+    stopConnectionCallbacks();
+    wsMessageSubscription.reset();
 }
 
 void WebRTCReceiverConnexionHandler::setupConnection() {
-    rtc::InitLogger(rtc::LogLevel::Info);
+    RtcRuntime::warmUp();
     rtc::Configuration config;
     config.iceServers.emplace_back("stun:stun.l.google.com:19302");
 
-    peerConnection = std::make_shared<rtc::PeerConnection>(config);
+    // Installée avant ses rappels : ceux d'une connexion remplacée entre-temps sont ignorés
+    const auto connection = std::make_shared<rtc::PeerConnection>(config);
+    replacePeerConnection(connection);
+    const rtc::PeerConnection *owner = connection.get();
+    // Rappels sur les threads de libdatachannel : ni this détruit, ni connexion remplacée
+    const auto liveness = callbackLiveness.getState();
 
-    peerConnection->onLocalDescription([this](const rtc::Description &sdp) {
+    connection->onLocalDescription([this, liveness, owner](const rtc::Description &sdp) {
+        const LivenessToken::Scope scope(*liveness);
+        if (!scope || !getPeerConnectionIfCurrent(owner)) {
+            return;
+        }
         sendAnswerToRemote(sdp);
         juce::Logger::outputDebugString("Local description sent " + sdp.generateSdp());
     });
 
-    peerConnection->onLocalCandidate([this](const rtc::Candidate &candidate) {
+    connection->onLocalCandidate([this, liveness, owner](const rtc::Candidate &candidate) {
+        const LivenessToken::Scope scope(*liveness);
+        const auto current = scope ? getPeerConnectionIfCurrent(owner) : nullptr;
+        if (!current) {
+            return;
+        }
         juce::Logger::outputDebugString("Local candidate found");
-        if (peerConnection->localDescription()) {
+        if (current->localDescription()) {
             sendCandidateToRemote(candidate);
-            for (const auto &pendingCandidate: pendingCandidates) {
+            for (const auto &pendingCandidate: takePendingCandidates()) {
                 sendCandidateToRemote(pendingCandidate);
             }
-            pendingCandidates.clear();
         } else {
-            pendingCandidates.push_back(candidate);
+            addPendingCandidate(owner, candidate);
             juce::Logger::outputDebugString("Candidate stored temporarily. Waiting for remote description.");
         }
     });
 
     // Notifications des changements d'état
-    peerConnection->onStateChange([this](rtc::PeerConnection::State state) {
-        notifyRTCStateChanged();
-        // if (state == rtc::PeerConnection::State::Closed) {
-        // peerConnection.reset();
-        // }
+    connection->onStateChange([this, liveness, owner](rtc::PeerConnection::State) {
+        const LivenessToken::Scope scope(*liveness);
+        if (scope && getPeerConnectionIfCurrent(owner)) {
+            notifyRTCStateChanged();
+        }
     });
 
-    peerConnection->onSignalingStateChange([this](rtc::PeerConnection::SignalingState state) {
-        notifyRTCStateChanged();
+    connection->onSignalingStateChange([this, liveness, owner](rtc::PeerConnection::SignalingState) {
+        const LivenessToken::Scope scope(*liveness);
+        if (scope && getPeerConnectionIfCurrent(owner)) {
+            notifyRTCStateChanged();
+        }
     });
 
-    peerConnection->onTrack([this](const std::shared_ptr<rtc::Track> &track) {
+    connection->onTrack([this, liveness, owner](const std::shared_ptr<rtc::Track> &track) {
+        const LivenessToken::Scope scope(*liveness);
+        if (!scope || !getPeerConnectionIfCurrent(owner)) {
+            return;
+        }
         juce::Logger::outputDebugString("Track received");
         audioTrack = track;
-        track->onMessage([this](const rtc::message_variant &message) {
+        // Émet les rapports RTCP (taux de perte) utilisés par l'émetteur pour régler sa FEC,
+        // et retire les paquets RTCP du flux transmis à onMessage
+        track->setMediaHandler(std::make_shared<rtc::RtcpReceivingSession>());
+        track->onMessage([this, liveness](const rtc::message_variant &message) {
+            const LivenessToken::Scope messageScope(*liveness);
+            if (!messageScope) {
+                return;
+            }
             auto chrono = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::steady_clock::now().time_since_epoch());
             uint64_t timestamp = chrono.count();
-            EventManager::getInstance().notifyOnAudioBlockReceived(AudioBlockReceivedEvent{message, timestamp});
+            context.getEventManager().publish(AudioBlockReceivedEvent{message, timestamp});
         });
     });
 
     // Notification des changements d'état ICE
-    peerConnection->onIceStateChange([this](const rtc::PeerConnection::IceState state) {
-        notifyRTCStateChanged();
+    connection->onIceStateChange([this, liveness, owner](const rtc::PeerConnection::IceState) {
+        const LivenessToken::Scope scope(*liveness);
+        if (scope && getPeerConnectionIfCurrent(owner)) {
+            notifyRTCStateChanged();
+        }
     });
 }
 
 void WebRTCReceiverConnexionHandler::onWsMessageReceived(const MessageWsReceivedEvent &event) {
-    if (!peerConnection) {
+    if (!isForThisSession(event)) {
         return;
     }
     if (event.type == "offer" && event.data.contains("sdp")) {
         handleOffer(event.data["sdp"]);
-    } else if (event.type == "ice-candidate") {
+    } else if (const auto connection = getPeerConnection(); event.type == "ice-candidate" && connection) {
         const std::string candidate = event.data["candidate"];
         const std::string sdpMid = event.data["sdpMid"];
 
         const auto iceCandidate = rtc::Candidate(candidate, sdpMid);
-        peerConnection->addRemoteCandidate(iceCandidate);
+        connection->addRemoteCandidate(iceCandidate);
         juce::Logger::outputDebugString("Remote candidate added");
     }
 }
 
 void WebRTCReceiverConnexionHandler::handleOffer(const std::string &sdp) {
     resetConnection(); // Supposé réinitialiser l'état de la connexion
-    if (peerConnection->state() == rtc::PeerConnection::State::Connected) {
+    const auto connection = getPeerConnection();
+    if (connection->state() == rtc::PeerConnection::State::Connected) {
         return;
     }
     juce::Logger::outputDebugString("Offer received" + sdp);
-    peerConnection->setRemoteDescription(rtc::Description(sdp, rtc::Description::Type::Offer));
+    connection->setRemoteDescription(rtc::Description(sdp, rtc::Description::Type::Offer));
 }
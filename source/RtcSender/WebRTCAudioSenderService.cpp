@@ -6,120 +6,382 @@
 
 #include <rtc/rtc.hpp>
 
-WebRTCAudioSenderService::WebRTCAudioSenderService() : WebRTCSenderConnexionHandler (WsRoute::GetOngoingSessionRTCInstru),
-                                                       opusEncoder (AudioSettings::getInstance().getOpusSampleRate(),
-                                                           AudioSettings::getInstance().getNumChannels(),
-                                                           AudioSettings::getInstance().getLatency(),
-                                                           AudioSettings::getInstance().getOpusBitRate()),
-                                                       resampler (AudioSettings::getInstance().getSampleRate(),
-                                                           AudioSettings::getInstance().getOpusSampleRate(),
-                                                           AudioSettings::getInstance().getNumChannels())
-{
+namespace {
+    // Délai maximal entre deux exécutions de la tâche d'encodage quand la capture est silencieuse (hôte à l'arrêt)
+    constexpr auto wakeupTimeout = std::chrono::milliseconds(20);
+    // Délai minimal : la capture arrive par blocs de l'hôte, inutile de repasser avant la milliseconde
+    constexpr auto minWakeup = std::chrono::milliseconds(1);
+    // Une trame Opus (10 ms) : la trame prête doit être encodée et envoyée avant la suivante
+    constexpr auto frameDuration = std::chrono::milliseconds(10);
 }
 
-WebRTCAudioSenderService::~WebRTCAudioSenderService()
+WebRTCAudioSenderService::WebRTCAudioSenderService(EngineContext& engineContext, SpscAudioFifo& captureFifo) : context (engineContext),
+                                                       captureFifo (captureFifo),
+                                                       signalingService (getWsRouteString (WsRoute::GetOngoingSessionRTCInstru), engineContext.getEventManager()),
+                                                       connections ([this] (const PopulatedSession& session) {
+                                                           return std::make_shared<WebRTCSenderConnexionHandler> (context, signalingService, session);
+                                                       })
 {
-    stopAudioThread();
+    rtcStateSubscription = engineContext.getEventManager().subscribe<RTCStateChangeEvent> (
+        [this] (const RTCStateChangeEvent& event) { onRTCStateChanged (event); });
+    ongoingSessionsSubscription = engineContext.getEventManager().subscribe<OngoingSessionsChangedEvent> (
+        [this] (const OngoingSessionsChangedEvent& event) { onOngoingSessionsChanged (event); });
+    loopbackSessionSubscription = engineContext.getEventManager().subscribe<OngoingSessionChangedEvent> (
+        [this] (const OngoingSessionChangedEvent& event) { onSessionChangedForLoopback (event); });
 }
 
-void WebRTCAudioSenderService::onAudioBlockProcessedEvent (const AudioBlockProcessedEvent& event)
+WebRTCAudioSenderService::~WebRTCAudioSenderService()
 {
-    if (event.data.empty())
+    // D'abord le désabonnement : un changement d'état ne peut plus relancer l'encodage pendant l'arrêt
+    rtcStateSubscription.reset();
+    ongoingSessionsSubscription.reset();
+    loopbackSessionSubscription.reset();
     {
-        return;
+        const std::lock_guard lock (encodingMutex);
+        stopEncoding();
+        loopbackRing.close();
     }
+    // Tâche d'encodage retirée : plus personne ne parcourt les connexions
+    connections.clear();
+}
+
+void WebRTCAudioSenderService::reconfigurePipeline (const AudioSettings::Snapshot& settings)
+{
+    // L'encodeur Opus ne dépend que des réglages Opus : il survit à un changement de fréquence de l'hôte
+    if (! opusEncoder.has_value() || settings.numChannels != pipelineSettings.numChannels
+        || settings.opusSampleRate != pipelineSettings.opusSampleRate || settings.latency != pipelineSettings.latency
+        || settings.opusBitRate != pipelineSettings.opusBitRate)
     {
-        std::lock_guard<std::mutex> lock (audioQueueMutex);
-        audioEventQueue.push (std::make_shared<AudioBlockProcessedEvent> (event));
+        opusEncoder.emplace (settings.opusSampleRate, settings.numChannels, settings.latency, settings.opusBitRate);
+        appliedLossPercent = -1;
     }
+
+    // Trame Opus de 10 ms à 48 kHz (480 échantillons par canal), RTP compte aussi à 48 kHz
+    numChannels = settings.numChannels;
+    frameSamples = settings.opusSampleRate * 10 / 1000;
+
+    // La capture est lue par blocs de 10 ms à la fréquence de l'hôte, puis convertie à 48 kHz
+    captureFrames = std::max (1, settings.sampleRate * 10 / 1000);
+    captureBlockSamples = static_cast<size_t> (captureFrames * numChannels);
+    resampler.prepare (settings.sampleRate, settings.opusSampleRate, numChannels, captureFrames);
+
+    // Le reliquat de l'ancienne configuration (moins d'une trame) est abandonné
+    encoderFifo.prepare (static_cast<size_t> (resampler.getMaxOutputFrames() + frameSamples) * static_cast<size_t> (numChannels) * 2);
+
+    // Tampons réutilisés à chaque itération : aucune allocation en régime établi
+    captureData.assign (captureBlockSamples, 0.0f);
+    resampledData.assign (static_cast<size_t> (resampler.getMaxOutputFrames() * numChannels), 0.0f);
+    frameData.assign (static_cast<size_t> (frameSamples * numChannels), 0.0f);
+
+    // Aucun défaut de page pendant l'encodage ; refusé (RLIMIT_MEMLOCK), le jeu de travail reste simplement paginable.
+    // Le nouveau jeu est verrouillé avant de relâcher l'ancien : la réserve de paquets, inchangée, le reste
+    RealtimeThreads::LockedMemory workingSet;
+    workingSet.lockContainer (captureData);
+    workingSet.lockContainer (resampledData);
+    workingSet.lockContainer (frameData);
+    workingSet.lock (encoderFifo.getStorage(), encoderFifo.getCapacity() * sizeof (float));
+    workingSet.lock (&packetPool, sizeof (packetPool));
+    lockedWorkingSet = std::move (workingSet);
+
+    // Les échantillons déjà capturés sont périmés ou dans l'ancien format : on repart du direct
+    const size_t staleSamples = captureFifo.getNumReady();
+    captureFifo.discard (staleSamples - staleSamples % captureBlockSamples);
+
+    pipelineSettings = settings;
+    juce::Logger::outputDebugString ("Encoding pipeline configured for " + std::to_string (settings.sampleRate) + " Hz (settings v"
+                                     + std::to_string (settings.version) + ")");
 }
 
-void WebRTCAudioSenderService::processingThreadFunction()
+std::optional<StreamWorkerPool::Run> WebRTCAudioSenderService::runEncodeJob()
 {
-    // Calcul du nombre d'échantillons par canal pour une trame de 20ms
-    const int frameSamples = static_cast<int>(
-        AudioSettings::getInstance().getSampleRate() * 10 / 1000.0); // 48000 * 20/1000 = 960
-    const int totalFrameSamples = frameSamples * AudioSettings::getInstance().getNumChannels(); // ex: 960 * 2 = 1920
+    const auto& settings = context.getAudioSettings();
+    loopbackRing.heartbeat();
+
+    // Nouveaux réglages publiés par prepareToPlay : reconstruction entre deux blocs, la connexion reste ouverte
+    // et les numéros de séquence comme les timestamps RTP continuent sans rupture
+    if (settings.getVersion() != pipelineSettings.version)
+        reconfigurePipeline (settings.getSnapshot());
+
+    // Ajuste la FEC au taux de perte rapporté par les récepteurs
+    if (const int lossPercent = getWorstLossPercent(); lossPercent != appliedLossPercent)
+    {
+        opusEncoder->setPacketLossPercent (lossPercent);
+        appliedLossPercent = lossPercent;
+    }
 
-    // Buffer temporaire pour accumuler les samples (interleaved)
-    std::vector<float> accumulationBuffer;
-    accumulationBuffer.reserve(totalFrameSamples * 2); // pré-allocation (optionnelle)
+    const auto totalFrameSamples = static_cast<size_t> (frameSamples * numChannels);
 
-    while (threadRunning)
+    // Tant que la file de capture contient au moins un bloc complet
+    while (captureFifo.getNumReady() >= captureBlockSamples && settings.getVersion() == pipelineSettings.version)
     {
-        // Récupérer les événements audio dans l'ordre
+        captureFifo.read (captureData.data(), captureBlockSamples);
+        const int resampledFrames = resampler.processInterleaved (captureData.data(), captureFrames, resampledData);
+        encoderFifo.write (resampledData.data(), static_cast<size_t> (resampledFrames * numChannels));
+
+        // Encoder chaque trame complète en paquet Opus
+        while (encoderFifo.getNumReady() >= totalFrameSamples)
         {
-            const juce::ScopedLock sl(dequeLock);
-            while (!audioEventQueue.empty())
-            {
-                auto eventPtr = audioEventQueue.top();
-                audioEventQueue.pop();
-
-                // On ajoute les samples du bloc dans le buffer d'accumulation
-                accumulationBuffer.insert(accumulationBuffer.end(), eventPtr->data.begin(), eventPtr->data.end());
-            }
+            encoderFifo.read (frameData.data(), totalFrameSamples);
+            writeLoopbackFrame (frameData.data(), frameSamples);
+            if (rtcConnected)
+                encodeAndSendFrame (frameData.data(), frameSamples);
+            else
+                timestamp += static_cast<uint32_t> (frameSamples); // l'horloge RTP continue pendant la coupure
         }
+    }
+
+    // Prochain passage quand processBlock aura déposé le bloc suivant, d'après ce qui manque à la fréquence de
+    // l'hôte ; le délai maximal garantit que les changements de taux de perte sont pris en compte sans audio
+    const auto missingFrames = (captureBlockSamples - std::min (captureFifo.getNumReady(), captureBlockSamples))
+                               / static_cast<size_t> (std::max (1, numChannels));
+    const auto missing = std::chrono::microseconds (static_cast<int64_t> (missingFrames) * 1000000
+                                                    / std::max (1, pipelineSettings.sampleRate));
+    const auto releaseTime = StreamWorkerPool::Clock::now()
+                             + std::clamp<StreamWorkerPool::Clock::duration> (missing, minWakeup, wakeupTimeout);
+    return StreamWorkerPool::Run { releaseTime, releaseTime + frameDuration };
+}
+
+void WebRTCAudioSenderService::encodeAndSendFrame (const float* frame, const int numFrameSamples)
+{
+    // Opus écrit juste après l'en-tête réservé, puis l'en-tête précalculé est complété en place
+    auto* packet = packetPool.encode (*opusEncoder, frame, numFrameSamples);
+    if (packet == nullptr)
+        return;
 
-        // Tant que nous avons suffisamment de samples pour constituer une trame
-        while (accumulationBuffer.size() >= static_cast<size_t>(totalFrameSamples))
+    timestamp += static_cast<uint32_t> (numFrameSamples);
+
+    // Même réglages pour toutes les sessions de l'instance : la charge encodée une fois part sur chaque connexion,
+    // qui ne réécrit que l'en-tête (son SSRC, sa séquence) ; libdatachannel copie le paquet à l'envoi
+    connections.forEach ([&] (WebRTCSenderConnexionHandler& connection) { connection.sendAudioPacket (*packet, timestamp); });
+}
+
+int WebRTCAudioSenderService::getWorstLossPercent() const
+{
+    int lossPercent = -1;
+    connections.forEach ([&] (const WebRTCSenderConnexionHandler& connection) {
+        if (connection.isConnected())
+            lossPercent = std::max (lossPercent, connection.getReceiverLossPercent());
+    });
+    return lossPercent < 0 ? OpusEncoderWrapper::defaultPacketLossPercent : lossPercent;
+}
+
+void WebRTCAudioSenderService::writeLoopbackFrame (const float* frame, const int numFrameSamples)
+{
+    if (! loopbackRing.ownsRing() || ! loopbackRing.isPeerPresent() || pipelineSettings.opusSampleRate != LoopbackRing::sampleRate)
+    {
+        loopbackFill = 0;
+        return;
+    }
+
+    const float gain = 1.0f / static_cast<float> (std::max (1, numChannels));
+    for (int i = 0; i < numFrameSamples; ++i)
+    {
+        float sum = 0.0f;
+        for (int channel = 0; channel < numChannels; ++channel)
+            sum += frame[i * numChannels + channel];
+        loopbackFrame[static_cast<size_t> (loopbackFill++)] = sum * gain;
+
+        if (loopbackFill == LoopbackRing::frameSamples)
         {
-            // Extraire exactement totalFrameSamples depuis le début
-            std::vector<float> frameData(accumulationBuffer.begin(),
-                                         accumulationBuffer.begin() + totalFrameSamples);
-            // Notifier l'envoi (optionnel)
-            // EventManager::getInstance().notifyOnAudioBlockSent(AudioBlockSentEvent{ frameData, packetTimestamp });
-
-            // Encoder la trame en packet Opus
-            std::vector<unsigned char> opusPacket = opusEncoder.encode_float(frameData, frameSamples);
-            if (!opusPacket.empty() && audioTrack)
-            {
-                sendOpusPacket(opusPacket, timestamp, frameSamples);
-            }
-
-            // Supprimer les samples traités du buffer d'accumulation
-            accumulationBuffer.erase(accumulationBuffer.begin(),
-                                     accumulationBuffer.begin() + totalFrameSamples);
+            loopbackRing.write (loopbackFrame.data(), loopbackFill);
+            loopbackFill = 0;
         }
-        // Attente si pas assez de données accumulées
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
 }
 
-void WebRTCAudioSenderService::sendOpusPacket (const std::vector<unsigned char>& opusPacket, uint32_t packetTimestamp, int frameSamples)
+void WebRTCAudioSenderService::startEncoding()
 {
-    try
-    {
-        timestamp += frameSamples;
-        auto rtpPacket = RTPWrapper::createRTPPacket (opusPacket, seqNum++, timestamp, ssrc);
-        juce::Logger::outputDebugString ("Sending packet: seqNum=" + std::to_string (seqNum) + ", timestamp=" + std::to_string (packetTimestamp) + "vs inTimestamp=" + std::to_string (timestamp) + ", size=" + std::to_string (rtpPacket.size()) + " bytes");
-        audioTrack->send (reinterpret_cast<const std::byte*> (rtpPacket.data()), rtpPacket.size());
-    } catch (const std::exception& e)
+    // Reprise après une coupure : l'encodeur, le SSRC et la séquence RTP continuent (le récepteur garde
+    // son tampon de gigue et son décodeur), le timestamp avance du temps écoulé pour que l'estimation
+    // de gigue du récepteur ne voie pas la coupure comme un retard
+    if (encodingStoppedAt.has_value())
     {
-        juce::Logger::outputDebugString ("Error sending audio data: " + std::string (e.what()));
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now() - *encodingStoppedAt);
+        const auto rate = static_cast<int64_t> (std::max (1, pipelineSettings.opusSampleRate));
+        timestamp += static_cast<uint32_t> (elapsed.count() * rate / 1000000);
     }
+
+    // Tâche retirée : la chaîne est (re)construite ici, la capture accumulée pendant l'arrêt est abandonnée
+    reconfigurePipeline (context.getAudioSettings().getSnapshot());
+    encodingRunning = true;
+    const auto pool = StreamWorkerPool::acquireShared();
+    encodeStream = pool->registerStream ([this] { return runEncodeJob(); });
+    encodeStream.scheduleNow (frameDuration);
+
+    juce::StringArray threads;
+    for (const auto& report: pool->getThreadReports())
+        threads.add (report.describe());
+    juce::Logger::outputDebugString ("Encoding started on shared threads [" + threads.joinIntoString (", ") + "], "
+                                     + juce::String (lockedWorkingSet.getLockedBytes()) + " bytes locked");
 }
 
-void WebRTCAudioSenderService::startAudioThread()
+void WebRTCAudioSenderService::stopEncoding()
 {
-    threadRunning = true;
-    encodingThread = std::thread (&WebRTCAudioSenderService::processingThreadFunction, this);
+    encodingRunning = false;
+    if (encodeStream.isRegistered())
+    {
+        juce::Logger::outputDebugString ("Encoding stopped: " + juce::String (encodeStream.getNumRuns()) + " runs, "
+                                         + juce::String (encodeStream.getNumDeadlineMisses()) + " deadline misses");
+        // Attend la fin d'une exécution en cours ; aucune ne démarre ensuite
+        encodeStream.reset();
+        encodingStoppedAt = std::chrono::steady_clock::now();
+    }
 }
 
-void WebRTCAudioSenderService::stopAudioThread()
+void WebRTCAudioSenderService::updateEncoding()
 {
-    threadRunning = false;
-    if (encodingThread.joinable())
-        encodingThread.join();
+    const bool shouldRun = rtcConnected || loopbackRing.isOpen();
+    if (shouldRun && ! encodingRunning)
+        startEncoding();
+    else if (! shouldRun)
+        stopEncoding();
 }
 
 void WebRTCAudioSenderService::onRTCStateChanged (const RTCStateChangeEvent& event)
 {
-    if (event.state == rtc::PeerConnection::State::Connected && !threadRunning)
+    // Les changements d'état ICE ou de signalisation d'une connexion établie n'interrompent pas l'encodage
+    const bool connected = event.state == rtc::PeerConnection::State::Connected && connections.find (event.sessionId) != nullptr;
+    const std::lock_guard lock (encodingMutex);
+    if (connected)
+        connectedSessions.insert (event.sessionId);
+    else
+        connectedSessions.erase (event.sessionId);
+    rtcConnected = ! connectedSessions.empty();
+    updateEncoding();
+}
+
+void WebRTCAudioSenderService::onOngoingSessionsChanged (const OngoingSessionsChangedEvent& event)
+{
+    if (! event.ongoingSessions.empty() && ! signalingService.isConnected())
+        signalingService.connectToServer();
+
+    // Les connexions retirées sont fermées ici, hors de encodingMutex : leur fermeture peut attendre les
+    // threads de libdatachannel, qui publient les changements d'état (onRTCStateChanged)
+    const auto changes = connections.setSessions (event.ongoingSessions);
+    for (const auto& sessionId: changes.added)
+        juce::Logger::outputDebugString ("Session " + sessionId + " added");
+    // Collecte ICE des nouvelles sessions (et des connexions fermées) en arrière-plan ; sans effet sur les autres
+    prewarmConnection();
+    if (! changes.removed.empty())
+    {
+        const std::lock_guard lock (encodingMutex);
+        for (const auto& sessionId: changes.removed)
+        {
+            juce::Logger::outputDebugString ("Session " + sessionId + " removed");
+            connectedSessions.erase (sessionId);
+        }
+        rtcConnected = ! connectedSessions.empty();
+        updateEncoding();
+    }
+
+    if (event.ongoingSessions.empty())
+        signalingService.disconnectToServer();
+}
+
+void WebRTCAudioSenderService::setupConnection()
+{
+    for (const auto& connection: connections.getConnections())
+        connection->setupConnection();
+}
+
+void WebRTCAudioSenderService::prewarmConnection()
+{
+    for (const auto& connection: connections.getConnections())
+        connection->prewarmConnection();
+}
+
+void WebRTCAudioSenderService::disconnect()
+{
+    for (const auto& connection: connections.getConnections())
+        connection->disconnect();
+}
+
+void WebRTCAudioSenderService::resetConnection()
+{
+    for (const auto& connection: connections.getConnections())
+        connection->resetConnection();
+}
+
+void WebRTCAudioSenderService::setupConnection (const std::string& sessionId)
+{
+    if (const auto connection = connections.find (sessionId))
+        connection->setupConnection();
+}
+
+void WebRTCAudioSenderService::disconnect (const std::string& sessionId)
+{
+    if (const auto connection = connections.find (sessionId))
+        connection->disconnect();
+}
+
+bool WebRTCAudioSenderService::isConnected() const
+{
+    return getState() == rtc::PeerConnection::State::Connected;
+}
+
+bool WebRTCAudioSenderService::isConnecting() const
+{
+    return getState() == rtc::PeerConnection::State::Connecting;
+}
+
+bool WebRTCAudioSenderService::isConnected (const std::string& sessionId) const
+{
+    const auto connection = connections.find (sessionId);
+    return connection != nullptr && connection->isConnected();
+}
+
+rtc::PeerConnection::State WebRTCAudioSenderService::getState() const
+{
+    bool connecting = false;
+    for (const auto& connection: connections.getConnections())
     {
-        startAudioThread();
+        const auto state = connection->getState();
+        if (state == rtc::PeerConnection::State::Connected)
+            return state;
+        connecting = connecting || state == rtc::PeerConnection::State::Connecting;
     }
-    else
+    if (connecting)
+        return rtc::PeerConnection::State::Connecting;
+    const auto displayed = getDisplayedConnection();
+    return displayed != nullptr ? displayed->getState() : rtc::PeerConnection::State::New;
+}
+
+std::shared_ptr<WebRTCSenderConnexionHandler> WebRTCAudioSenderService::getDisplayedConnection() const
+{
+    const auto all = connections.getConnections();
+    for (const auto& connection: all)
     {
-        stopAudioThread();
+        if (connection->isConnected())
+            return connection;
     }
+    return all.empty() ? nullptr : all.front();
+}
+
+juce::String WebRTCAudioSenderService::getSignalingStateLabel() const
+{
+    const auto displayed = getDisplayedConnection();
+    return displayed != nullptr ? displayed->getSignalingStateLabel() : juce::String::fromUTF8 ("Inconnu");
+}
+
+juce::String WebRTCAudioSenderService::getIceCandidateStateLabel() const
+{
+    const auto displayed = getDisplayedConnection();
+    return displayed != nullptr ? displayed->getIceCandidateStateLabel() : juce::String::fromUTF8 ("Inconnu");
+}
+
+void WebRTCAudioSenderService::onSessionChangedForLoopback (const OngoingSessionChangedEvent& event)
+{
+    const std::string sessionId = event.ongoingSession.has_value() ? event.ongoingSession->_id : std::string();
+    const std::lock_guard lock (encodingMutex);
+    // La session est relue régulièrement : seul un changement de session rouvre l'anneau
+    if (sessionId == loopbackSessionId)
+        return;
+
+    // L'anneau n'est changé que tâche d'encodage arrêtée : elle l'utilise sans verrou
+    stopEncoding();
+    loopbackRing.close();
+    loopbackSessionId = sessionId;
+    if (! sessionId.empty() && ! loopbackRing.open (LoopbackRing::getRingFile (sessionId), LoopbackRing::Role::Writer))
+        juce::Logger::outputDebugString ("Transport local indisponible pour la session " + sessionId);
+    updateEncoding();
 }
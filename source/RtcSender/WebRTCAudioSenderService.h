@@ -1,59 +1,142 @@
 #pragma once
 
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
 #include <juce_core/juce_core.h>
 
 #include "../Common/OpusEncoderWrapper.h"
 #include "../Api/WebSocketService.h"
-#include "../Common/EventListener.h"
 
-#include "../Common/ResamplerWrapper.h"
+#include "../Common/RtpPacketPool.h"
+#include "../Common/StreamingResampler.h"
 #include "WebRTCSenderConnexionHandler.h"
-#include "../Common/CircularBuffer.h"
-
-struct CompareAudioEvent {
-    bool operator()(const std::shared_ptr<AudioBlockProcessedEvent> &a,
-                    const std::shared_ptr<AudioBlockProcessedEvent> &b) const {
-        // Plus ancien en haut de la file
-        return a->timestamp > b->timestamp;
-    }
-};
-
-class WebRTCAudioSenderService final : public WebRTCSenderConnexionHandler {
+#include "../Rtc/SessionConnectionManager.h"
+#include "../Common/SpscAudioFifo.h"
+#include "../Common/LoopbackRing.h"
+#include "../Common/RealtimeThreads.h"
+#include "../Common/StreamWorkerPool.h"
+
+// Émetteur d'une instance : un seul encodeur pour toutes les sessions en cours, une connexion par session
+// (voir SessionConnectionManager). Le coût d'encodage ne dépend pas du nombre d'auditeurs. L'ajout ou le retrait d'une session ne touche pas aux connexions des autres ;
+// les méthodes sans identifiant de session s'appliquent à toutes.
+class WebRTCAudioSenderService final {
 public:
-    WebRTCAudioSenderService();
+    WebRTCAudioSenderService(EngineContext& engineContext, SpscAudioFifo& captureFifo);
+
+    ~WebRTCAudioSenderService();
+
+    WebRTCAudioSenderService(const WebRTCAudioSenderService&) = delete;
+    WebRTCAudioSenderService& operator=(const WebRTCAudioSenderService&) = delete;
 
-    ~WebRTCAudioSenderService() override;
+    void setupConnection();
+    void prewarmConnection();
+    void disconnect();
+    void resetConnection();
+    // Une seule session ; sans effet si elle n'est pas en cours
+    void setupConnection(const std::string& sessionId);
+    void disconnect(const std::string& sessionId);
+
+    // Vrai si au moins une session est connectée (resp. en cours de connexion)
+    [[nodiscard]] bool isConnected() const;
+    [[nodiscard]] bool isConnecting() const;
+    [[nodiscard]] bool isConnected(const std::string& sessionId) const;
+    // État le plus avancé parmi les sessions, New sans session
+    [[nodiscard]] rtc::PeerConnection::State getState() const;
+    [[nodiscard]] size_t getNumSessions() const { return connections.size(); }
+
+    // États de la connexion affichée : la première connectée, sinon la première session
+    [[nodiscard]] juce::String getSignalingStateLabel() const;
+    [[nodiscard]] juce::String getIceCandidateStateLabel() const;
 
 private:
-    void stopAudioThread();
+    void stopEncoding();
 
-    void startAudioThread();
+    void startEncoding();
 
-    void onRTCStateChanged(const RTCStateChangeEvent &event) override;
+    // La tâche d'encodage tourne tant qu'une session est connectée ou que l'anneau local est ouvert
+    // (transport local possible) ; encodingMutex doit être tenu
+    void updateEncoding();
 
-    void onAudioBlockProcessedEvent(const AudioBlockProcessedEvent &event) override;
+    void onRTCStateChanged(const RTCStateChangeEvent &event);
 
-    void sendOpusPacket(const std::vector<unsigned char>& opusPacket,uint32_t packetTimestamp,int frameSamples);
+    // Thread de publication des sessions (thread de travail du moteur) : ouvre les connexions des nouvelles
+    // sessions et ferme celles des sessions terminées
+    void onOngoingSessionsChanged(const OngoingSessionsChangedEvent &event);
 
-    void processingThreadFunction();
+    [[nodiscard]] std::shared_ptr<WebRTCSenderConnexionHandler> getDisplayedConnection() const;
 
-    OpusEncoderWrapper opusEncoder;
-    ResamplerWrapper resampler;
-    uint16_t seqNum = 1;
-    uint32_t timestamp = 0;
-    uint32_t ssrc = 12345;
+    // Pire taux de perte rapporté par les récepteurs : l'encodeur partagé règle sa FEC pour le lien le plus dégradé
+    [[nodiscard]] int getWorstLossPercent() const;
 
-    std::deque<AudioBlockProcessedEvent> audioQueue;
+    void onSessionChangedForLoopback(const OngoingSessionChangedEvent &event);
 
-    std::atomic<bool> threadRunning{true};
-    std::thread encodingThread;
+    // Tâche d'encodage : envoie la trame, réduite en mono par blocs de LoopbackRing::frameSamples, à un récepteur local
+    void writeLoopbackFrame(const float* frame, int numFrameSamples);
 
-    std::mutex audioQueueMutex;
-    std::priority_queue<
-        std::shared_ptr<AudioBlockProcessedEvent>,
-        std::vector<std::shared_ptr<AudioBlockProcessedEvent> >,
-        CompareAudioEvent
-    > audioEventQueue;
-    juce::CriticalSection dequeLock;
+    // Tâche d'encodage : (re)construit encodeur, rééchantillonneur et tampons pour les réglages donnés
+    void reconfigurePipeline(const AudioSettings::Snapshot& settings);
+
+    // Encode une trame une seule fois, directement dans un paquet RTP préalloué, et l'envoie sur chaque connexion
+    void encodeAndSendFrame(const float* frame, int numFrameSamples);
+
+    // Une exécution de la tâche d'encodage sur la réserve partagée : encode tout ce qui est prêt, sans jamais
+    // attendre, et se reprogramme pour le moment où le bloc de capture suivant sera complet
+    std::optional<StreamWorkerPool::Run> runEncodeJob();
+
+    EngineContext& context;
+    // Alimentée par MainAudioProcessor::processBlock, lue uniquement par la tâche d'encodage
+    SpscAudioFifo& captureFifo;
+
+    // Route de signalisation commune aux connexions de l'instance ; chacune filtre les messages de sa session
+    WebSocketService signalingService;
+    SessionConnectionManager<WebRTCSenderConnexionHandler> connections;
+
+    // Chaîne d'encodage, utilisée et reconstruite par la tâche d'encodage uniquement (voir reconfigurePipeline)
+    AudioSettings::Snapshot pipelineSettings;
+    std::optional<OpusEncoderWrapper> opusEncoder;
+    int appliedLossPercent = -1;
+    int numChannels = 0;
+    int frameSamples = 0;
+    int captureFrames = 0;
+    size_t captureBlockSamples = 0;
+    // Fréquence de l'hôte -> 48 kHz
+    StreamingResampler resampler;
+    // Échantillons déjà rééchantillonnés en attente d'une trame Opus complète
+    SpscAudioFifo encoderFifo;
+    std::vector<float> captureData;
+    std::vector<float> resampledData;
+    std::vector<float> frameData;
+    // Tampons de la chaîne et paquets RTP, verrouillés en mémoire à chaque reconstruction
+    RealtimeThreads::LockedMemory lockedWorkingSet;
+
+    // Horloge RTP de l'encodeur, commune aux connexions : chacune y ajoute son décalage, et tient son SSRC
+    // et sa séquence (voir RtpFanoutOutput)
+    uint32_t timestamp = 0;
+    // Arrêt de la tâche d'encodage (coupure de la connexion), pour recaler le timestamp RTP à la reprise
+    std::optional<std::chrono::steady_clock::time_point> encodingStoppedAt;
+    RtpPacketPool<8> packetPool;
+
+    // Transport local vers un MeloVSTReceive de la même session sur cette machine (voir LoopbackRing)
+    LoopbackRing loopbackRing;
+    std::string loopbackSessionId;
+    std::vector<float> loopbackFrame = std::vector<float> (LoopbackRing::frameSamples, 0.0f);
+    int loopbackFill = 0;
+
+    // Sessions dont la connexion est établie (encodingMutex) ; l'encodage Opus tourne tant qu'il en reste une
+    std::set<std::string> connectedSessions;
+    std::atomic<bool> rtcConnected{false};
+    std::atomic<bool> encodingRunning{false};
+    // Ordonne démarrage et arrêt de l'encodage (changements d'état WebRTC et de session, sur des threads différents)
+    std::mutex encodingMutex;
+    // Tâche d'encodage de l'instance, exécutée par la réserve de threads commune au processus
+    StreamWorkerPool::Stream encodeStream;
+    EventSubscription rtcStateSubscription;
+    EventSubscription ongoingSessionsSubscription;
+    EventSubscription loopbackSessionSubscription;
 };
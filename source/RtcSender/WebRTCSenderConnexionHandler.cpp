@@ -3,20 +3,116 @@
 #include "../ThirdParty/json.hpp"
 #include "../AudioSettings.h"
 #include "../Api/SocketRoutes.h"
+#include "../Rtc/RtcRuntime.h"
 
-WebRTCSenderConnexionHandler::WebRTCSenderConnexionHandler(const WsRoute wsRoute): WebRTCConnexionState(wsRoute){
+#include <cmath>
+
+WebRTCSenderConnexionHandler::WebRTCSenderConnexionHandler(EngineContext &engineContext, WebSocketService &signaling,
+                                                           const PopulatedSession &session): WebRTCConnexionState(engineContext, signaling, session) {
+    wsMessageSubscription = context.getEventManager().subscribe<MessageWsReceivedEvent>(
+        [this](const MessageWsReceivedEvent &event) { onWsMessageReceived(event); });
+}
+
+WebRTCSenderConnexionHandler::~WebRTCSenderConnexionHandler() {
+    // Avant tout membre : les rappels de libdatachannel en cours se terminent, aucun n'entre plus
+    stopConnectionCallbacks();
+    wsMessageSubscription.reset();
+    // Le minuteur de renvoi de l'offre rappelle resetConnection() : arrêté avant la fermeture de la connexion
+    answerTimer.reset();
+    const std::lock_guard lock(trackMutex);
+    if (audioTrack) {
+        audioTrack->resetCallbacks();
+    }
+}
+
+bool WebRTCSenderConnexionHandler::sendAudioPacket(RtpPacketBuffer &packet, const uint32_t mediaTimestamp) {
+    std::shared_ptr<rtc::Track> track;
+    {
+        const std::lock_guard lock(trackMutex);
+        track = audioTrack;
+    }
+    // Piste fermée (connexion en cours ou reprise) : rien n'est envoyé et la séquence ne bouge pas
+    if (!track || !track->isOpen()) {
+        trackWasOpen = false;
+        return false;
+    }
+    if (!trackWasOpen) {
+        rtpOutput.restart();
+        trackWasOpen = true;
+    }
+    return rtpOutput.send(packet, mediaTimestamp, track->bufferedAmount(), [&track](const std::span<const std::byte> bytes) {
+        try {
+            return track->send(bytes.data(), bytes.size());
+        } catch (const std::exception &e) {
+            juce::Logger::outputDebugString("Error sending audio data: " + std::string(e.what()));
+            return false;
+        }
+    });
+}
+
+void WebRTCSenderConnexionHandler::prewarmConnection() {
+    const std::lock_guard lock(connectionMutex);
+    if (const auto connection = getPeerConnection(); connection && connection->state() != rtc::PeerConnection::State::Closed) {
+        return;
+    }
+    juce::Logger::outputDebugString("Pre-warming peer connection");
+    connectRequested = false;
+    // L'offre est préparée et la collecte ICE (hôte, srflx) démarre dès maintenant ;
+    // l'offre ne part vers l'artiste qu'à setupConnection()
+    createPeerConnection()->setLocalDescription(rtc::Description::Type::Offer);
 }
 
 void WebRTCSenderConnexionHandler::setupConnection() {
-    rtc::InitLogger(rtc::LogLevel::Info);
+    const std::lock_guard lock(connectionMutex);
+    connectRequested = true;
+    if (const auto connection = getPeerConnection(); isPrewarmed(connection.get())) {
+        sendPrewarmedOffer(*connection);
+        return;
+    }
+    setOffer(*createPeerConnection());
+}
+
+bool WebRTCSenderConnexionHandler::isPrewarmed(const rtc::PeerConnection *connection) {
+    return connection != nullptr && connection->state() == rtc::PeerConnection::State::New
+           && connection->signalingState() == rtc::PeerConnection::SignalingState::HaveLocalOffer
+           && connection->localDescription().has_value();
+}
+
+void WebRTCSenderConnexionHandler::sendPrewarmedOffer(rtc::PeerConnection &connection) {
+    juce::Logger::outputDebugString("Using pre-warmed peer connection");
+    // Collecte terminée : tous les candidats sont déjà dans l'offre, inutile de les renvoyer un par un
+    if (connection.gatheringState() == rtc::PeerConnection::GatheringState::Complete) {
+        takePendingCandidates();
+    }
+    if (sendOfferToRemote(connection.localDescription().value())) {
+        startAnswerReceivedCheckTimer();
+    }
+}
+
+std::shared_ptr<rtc::PeerConnection> WebRTCSenderConnexionHandler::createPeerConnection() {
+    RtcRuntime::warmUp();
     rtc::Configuration config;
     config.iceServers.emplace_back("stun:stun.l.google.com:19302");
 
-    peerConnection = std::make_shared<rtc::PeerConnection>(config);
+    // Installée avant ses rappels : ceux d'une connexion remplacée entre-temps sont ignorés
+    const auto connection = std::make_shared<rtc::PeerConnection>(config);
+    replacePeerConnection(connection);
+    const rtc::PeerConnection *owner = connection.get();
+    // Rappels sur les threads de libdatachannel : ni this détruit, ni connexion remplacée
+    const auto liveness = callbackLiveness.getState();
 
-    peerConnection->onLocalDescription([this](const rtc::Description &sdp) {
+    connection->onLocalDescription([this, liveness, owner](const rtc::Description &sdp) {
+        const LivenessToken::Scope scope(*liveness);
+        const auto current = scope ? getPeerConnectionIfCurrent(owner) : nullptr;
+        if (!current) {
+            return;
+        }
         juce::Logger::outputDebugString("Local description set");
-        if (!peerConnection->remoteDescription()) {
+        if (!connectRequested) {
+            juce::Logger::outputDebugString("Offer ready, waiting for connect.");
+            return;
+        }
+        if (!current->remoteDescription()) {
             juce::Logger::outputDebugString("No remote description. Waiting for answer.");
             if (sendOfferToRemote(sdp)) {
                 startAnswerReceivedCheckTimer();
@@ -24,86 +120,103 @@ void WebRTCSenderConnexionHandler::setupConnection() {
         }
     });
 
-    peerConnection->onLocalCandidate([this](const rtc::Candidate &candidate) {
-        if (peerConnection->signalingState() == rtc::PeerConnection::SignalingState::Stable) {
+    connection->onLocalCandidate([this, liveness, owner](const rtc::Candidate &candidate) {
+        const LivenessToken::Scope scope(*liveness);
+        const auto current = scope ? getPeerConnectionIfCurrent(owner) : nullptr;
+        if (!current || current->signalingState() == rtc::PeerConnection::SignalingState::Stable) {
             return;
         }
 
-        if (peerConnection->remoteDescription()) {
+        if (current->remoteDescription()) {
             sendCandidateToRemote(candidate);
         } else {
-            pendingCandidates.push_back(candidate);
+            addPendingCandidate(owner, candidate);
             juce::Logger::outputDebugString("Candidate stored temporarily. Waiting for remote description.");
         }
     });
 
-    peerConnection->onStateChange([this](rtc::PeerConnection::State state) {
-        notifyRTCStateChanged();
+    connection->onStateChange([this, liveness, owner](rtc::PeerConnection::State) {
+        const LivenessToken::Scope scope(*liveness);
+        if (scope && getPeerConnectionIfCurrent(owner)) {
+            notifyRTCStateChanged();
+        }
     });
 
-    peerConnection->onSignalingStateChange([this](rtc::PeerConnection::SignalingState state) {
-        notifyRTCStateChanged();
+    connection->onSignalingStateChange([this, liveness, owner](rtc::PeerConnection::SignalingState) {
+        const LivenessToken::Scope scope(*liveness);
+        if (scope && getPeerConnectionIfCurrent(owner)) {
+            notifyRTCStateChanged();
+        }
     });
 
-    peerConnection->onTrack([this](const std::shared_ptr<rtc::Track> &track) {
+    connection->onTrack([this, liveness, owner](const std::shared_ptr<rtc::Track> &track) {
+        const LivenessToken::Scope scope(*liveness);
+        if (!scope || !getPeerConnectionIfCurrent(owner)) {
+            return;
+        }
         juce::Logger::outputDebugString("Track received");
+        const std::lock_guard lock(trackMutex);
         audioTrack = track;
     });
 
-    peerConnection->onIceStateChange([this](const rtc::PeerConnection::IceState state) {
-        notifyRTCStateChanged();
-        switch (state) {
-            case rtc::PeerConnection::IceState::New:
-                juce::Logger::outputDebugString("ICE state changed to: New");
-                break;
-            case rtc::PeerConnection::IceState::Closed:
-            case rtc::PeerConnection::IceState::Disconnected: {
-                break;
-            }
-            case rtc::PeerConnection::IceState::Failed: {
-                juce::Logger::outputDebugString("ICE state changed to: Disconnected / Failed / Closed");
-                ReconnectTimer::callAfterDelay(reconnectDelayMs, [this]() { attemptReconnect(); });
-                break;
-            }
-            case rtc::PeerConnection::IceState::Checking:
-                break;
-            case rtc::PeerConnection::IceState::Completed:
-            case rtc::PeerConnection::IceState::Connected: {
-                if (peerConnection->state() == rtc::PeerConnection::State::Connected) {
-                    juce::Logger::outputDebugString("Already connected, skipping reconnection.");
-                    return;
-                }
-                reconnectAttempts = 0;
-                juce::Logger::outputDebugString("ICE state changed to: Connected");
-                break;
-            }
-            default:
-                break;
+    connection->onIceStateChange([this, liveness, owner](const rtc::PeerConnection::IceState state) {
+        const LivenessToken::Scope scope(*liveness);
+        if (!scope || !getPeerConnectionIfCurrent(owner)) {
+            return;
         }
+        notifyRTCStateChanged();
+        onIceStateChangedForRecovery(state);
     });
 
     rtc::Description::Audio newAudioTrack{};
-    newAudioTrack.addOpusCodec(111, "minptime=10;useinbandfec=0");
-    newAudioTrack.setBitrate(AudioSettings::getInstance().getOpusBitRate()); // Débit binaire en bits par seconde
+    newAudioTrack.addOpusCodec(111, "minptime=10;useinbandfec=1");
+    newAudioTrack.setBitrate(context.getAudioSettings().getOpusBitRate()); // Débit binaire en bits par seconde
     newAudioTrack.setDirection(rtc::Description::Direction::SendOnly);
-    newAudioTrack.addSSRC(12345, "CNAME");;
-    audioTrack = peerConnection->addTrack(static_cast<rtc::Description::Media>(newAudioTrack));
-    setOffer();
+    newAudioTrack.addSSRC(rtpOutput.getSsrc(), "CNAME");
+    const auto track = connection->addTrack(static_cast<rtc::Description::Media>(newAudioTrack));
+    // Le récepteur renvoie des rapports RTCP : on en tire le taux de perte pour régler la FEC Opus
+    track->onMessage([this, liveness](const rtc::message_variant &message) {
+        const LivenessToken::Scope scope(*liveness);
+        if (scope) {
+            onRtcpReceived(message);
+        }
+    });
+    const std::lock_guard lock(trackMutex);
+    audioTrack = track;
+    return connection;
+}
+
+void WebRTCSenderConnexionHandler::onRtcpReceived(const rtc::message_variant &message) {
+    if (!std::holds_alternative<rtc::binary>(message)) {
+        return;
+    }
+    const auto &packet = std::get<rtc::binary>(message);
+    const auto fractionLost = RTPWrapper::getRTCPFractionLost(reinterpret_cast<const unsigned char *>(packet.data()), packet.size());
+    if (!fractionLost.has_value()) {
+        return;
+    }
+
+    // Lissage : la fraction perdue porte sur un seul intervalle de rapport. En virgule flottante, sinon l'arrondi
+    // entier resterait bloqué à 1 % après la moindre perte et garderait la FEC engagée.
+    const int measuredPercent = (fractionLost.value() * 100 + 255) / 256;
+    smoothedLossPercent = (smoothedLossPercent * 3.0 + measuredPercent) / 4.0;
+    receiverLossPercent.store(static_cast<int>(std::lround(smoothedLossPercent)));
 }
 
 
 void WebRTCSenderConnexionHandler::onWsMessageReceived(const MessageWsReceivedEvent &event) {
-    if (!peerConnection) {
+    const auto connection = getPeerConnection();
+    if (!connection || !isForThisSession(event)) {
         return;
     }
-    if (peerConnection->signalingState() != rtc::PeerConnection::SignalingState::HaveLocalOffer) {
+    if (connection->signalingState() != rtc::PeerConnection::SignalingState::HaveLocalOffer) {
         return;
     }
 
     if (event.type == "answer" && event.data.contains("sdp")) {
-        handleAnswer(event.data["sdp"]);
+        handleAnswer(*connection, event.data["sdp"]);
     } else if (event.type == "ice-candidate") {
-        if (peerConnection->state() == rtc::PeerConnection::State::Connected) {
+        if (connection->state() == rtc::PeerConnection::State::Connected) {
             return;
         }
         juce::Logger::outputDebugString("Received ICE candidate ->" + event.data["candidate"]);
@@ -111,44 +224,42 @@ void WebRTCSenderConnexionHandler::onWsMessageReceived(const MessageWsReceivedEv
         const std::string sdpMid = event.data["sdpMid"];
 
         const auto iceCandidate(rtc::Candidate(candidate, sdpMid));
-        peerConnection->addRemoteCandidate(iceCandidate);
+        connection->addRemoteCandidate(iceCandidate);
     }
 }
 
-void WebRTCSenderConnexionHandler::setOffer() {
+void WebRTCSenderConnexionHandler::setOffer(rtc::PeerConnection &connection) {
     juce::Logger::outputDebugString("Setting offer");
-    if (peerConnection->signalingState() != rtc::PeerConnection::SignalingState::Stable && peerConnection->state() ==
+    if (connection.signalingState() != rtc::PeerConnection::SignalingState::Stable && connection.state() ==
         rtc::PeerConnection::State::Connected) {
         return;
     }
-    if (peerConnection->localDescription().has_value()) {
+    if (connection.localDescription().has_value()) {
         juce::Logger::outputDebugString("Offer already set, sending it to remote");
-        sendOfferToRemote(peerConnection->localDescription().value());
+        sendOfferToRemote(connection.localDescription().value());
     } else {
-        peerConnection->localDescription().reset();
-        peerConnection->setLocalDescription(rtc::Description::Type::Offer);
+        connection.setLocalDescription(rtc::Description::Type::Offer);
     }
 }
 
-void WebRTCSenderConnexionHandler::handleAnswer(const std::string &sdp) {
-    if (peerConnection->signalingState() != rtc::PeerConnection::SignalingState::HaveLocalOffer) {
+void WebRTCSenderConnexionHandler::handleAnswer(rtc::PeerConnection &connection, const std::string &sdp) {
+    if (connection.signalingState() != rtc::PeerConnection::SignalingState::HaveLocalOffer) {
         return;
     }
-    if (peerConnection->state() == rtc::PeerConnection::State::Connected) {
+    if (connection.state() == rtc::PeerConnection::State::Connected) {
         return;
     }
 
-    if (peerConnection->remoteDescription()) {
+    if (connection.remoteDescription()) {
         return;
     }
 
     juce::Logger::outputDebugString("Received answer");
-    peerConnection->setRemoteDescription(rtc::Description(sdp, "answer"));
+    connection.setRemoteDescription(rtc::Description(sdp, "answer"));
     answerReceived = true;
-    for (const auto &candidate: pendingCandidates) {
+    for (const auto &candidate: takePendingCandidates()) {
         sendCandidateToRemote(candidate);
     }
-    pendingCandidates.clear();
 }
 
 void WebRTCSenderConnexionHandler::startAnswerReceivedCheckTimer() {
@@ -1,33 +1,69 @@
 #pragma once
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <rtc/rtc.hpp>
 #include "../Utils/VectorUtils.h"
 #include <juce_core/juce_core.h>
 
-#include "../Common/EventListener.h"
 #include "../Api/SocketEvents.h"
 #include "../Api/SocketRoutes.h"
 #include "../Common/ReconnectTimer.h"
 #include "../Rtc/WebRTCConnexionState.h"
+#include "../Common/OpusEncoderWrapper.h"
+#include "../Common/RTPWrapper.h"
+#include "../Common/RtpFanout.h"
 
 
-class WebRTCSenderConnexionHandler: public WebRTCConnexionState {
+// Connexion vers l'artiste d'une session (voir SessionConnectionManager) : WebRTCAudioSenderService en tient
+// une par session en cours et leur envoie à toutes les paquets de son unique encodeur. Chaque connexion a son
+// propre état RTP (SSRC, séquence, timestamp) et sa propre contre-pression (voir RtpFanoutOutput).
+class WebRTCSenderConnexionHandler final : public WebRTCConnexionState {
 public:
-    explicit WebRTCSenderConnexionHandler(WsRoute wsRoute);
+    WebRTCSenderConnexionHandler(EngineContext& engineContext, WebSocketService& signaling, const PopulatedSession& session);
+    ~WebRTCSenderConnexionHandler() override;
+    // Envoie l'offre : celle de la connexion pré-chauffée si elle est prête, sinon une nouvelle connexion
     void setupConnection() override;
-protected:
-    std::shared_ptr<rtc::Track> audioTrack;
+    // Crée la connexion, la piste audio et l'offre locale, et lance la collecte ICE, sans rien envoyer
+    void prewarmConnection() override;
+
+    // Tâche d'encodage : complète l'en-tête du paquet partagé pour cette piste et l'envoie si la connexion
+    // est établie. N'attend jamais.
+    bool sendAudioPacket(RtpPacketBuffer& packet, uint32_t mediaTimestamp);
+    // Taux de perte mesuré par le récepteur (rapports RTCP), en pourcentage
+    [[nodiscard]] int getReceiverLossPercent() const noexcept { return receiverLossPercent.load(); }
 private:
-    void setOffer();
-    void handleAnswer(const std::string& sdp);
+    // Crée la connexion, ses rappels et la piste audio, et l'installe comme connexion courante
+    std::shared_ptr<rtc::PeerConnection> createPeerConnection();
+    [[nodiscard]] static bool isPrewarmed(const rtc::PeerConnection* connection);
+    void sendPrewarmedOffer(rtc::PeerConnection& connection);
+    void setOffer(rtc::PeerConnection& connection);
+    void handleAnswer(rtc::PeerConnection& connection, const std::string& sdp);
     void startAnswerReceivedCheckTimer();
-    void onWsMessageReceived(const MessageWsReceivedEvent &event) override;
+    void onRtcpReceived(const rtc::message_variant &message);
+    void onWsMessageReceived(const MessageWsReceivedEvent &event);
 
     // Answer monitoring
-    bool answerReceived = false;
+    std::atomic<bool> answerReceived{false};
     const int maxResendAttempts = 100;
     int resendAttempts = 0;
     int resendIntervalMs = 10000;
     std::optional<ReconnectTimer> answerTimer;
+
+    // Pré-chauffage (thread de travail du moteur) et connexion (message thread) ne créent pas deux connexions
+    std::mutex connectionMutex;
+    // Piste remplacée à chaque nouvelle connexion, lue par la tâche d'encodage
+    std::mutex trackMutex;
+    std::shared_ptr<rtc::Track> audioTrack;
+    // État RTP de la piste, conservé d'une PeerConnection à l'autre (reprise ICE) ; SSRC annoncé dans l'offre
+    RtpFanoutOutput rtpOutput = RtpFanoutOutput::withRandomState();
+    // Tâche d'encodage : piste ouverte à la trame précédente, pour marquer la reprise du flux
+    bool trackWasOpen = false;
+    std::atomic<int> receiverLossPercent{OpusEncoderWrapper::defaultPacketLossPercent};
+    // Thread des rapports RTCP uniquement
+    double smoothedLossPercent = OpusEncoderWrapper::defaultPacketLossPercent;
+    // Faux tant que l'utilisateur n'a pas demandé la connexion : l'offre préparée n'est pas envoyée
+    std::atomic<bool> connectRequested{false};
+    EventSubscription wsMessageSubscription;
 };
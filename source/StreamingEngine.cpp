@@ -0,0 +1,107 @@
+#include "StreamingEngine.h"
+#include "Api/ApiService.h"
+#include "Api/ApiRoutes.h"
+#include "Api/SocketRoutes.h"
+#include "Common/JuceLocalStorage.h"
+#include "Rtc/RtcRuntime.h"
+
+#ifdef IN_RECEIVING_MODE
+StreamingEngine::StreamingEngine(EngineContext &engineContext, AudioPlayout &audioPlayout): context(engineContext),
+    audioService(engineContext, audioPlayout),
+#else
+StreamingEngine::StreamingEngine(EngineContext &engineContext, SpscAudioFifo &captureFifo): context(engineContext),
+    audioService(engineContext, captureFifo),
+#endif
+    sessionWebSocketService(getWsRouteString(WsRoute::GetOngoingSession), engineContext.getEventManager()) {
+    auto &eventManager = engineContext.getEventManager();
+    loginSubscription = eventManager.subscribe<LoginEvent>([this](const LoginEvent &) { refreshOngoingSession(); });
+    logoutSubscription = eventManager.subscribe<LogoutEvent>([this](const LogoutEvent &) { onLogout(); });
+}
+
+StreamingEngine::~StreamingEngine() {
+    loginSubscription.reset();
+    logoutSubscription.reset();
+    // Les tâches capturent this : elles sont toutes terminées, sans délai maximal, avant la destruction des membres
+    if (worker != nullptr) {
+        worker->removeAllJobs(true, -1);
+        worker.reset();
+    }
+}
+
+void StreamingEngine::start() {
+    std::call_once(started, [this] {
+        worker = std::make_unique<juce::ThreadPool>(1);
+        worker->addJob([] { RtcRuntime::warmUp(); });
+        // Utilisateur déjà connecté lors d'une session précédente : le contexte est chargé avant qu'on l'affiche
+        if (JuceLocalStorage::getInstance().loadValue("access_token").isNotEmpty()) {
+            worker->addJob([this] { fetchUserContextAndSession(); });
+        }
+    });
+}
+
+std::optional<PopulatedSession> StreamingEngine::getOngoingSession() const {
+    const std::lock_guard lock(sessionMutex);
+    if (ongoingSessions.empty()) {
+        return std::nullopt;
+    }
+    return ongoingSessions.front();
+}
+
+std::vector<PopulatedSession> StreamingEngine::getOngoingSessions() const {
+    const std::lock_guard lock(sessionMutex);
+    return ongoingSessions;
+}
+
+void StreamingEngine::refreshUserContext() {
+    addJob([this] { fetchUserContextAndSession(); });
+}
+
+void StreamingEngine::refreshOngoingSession() {
+    addJob([this] { fetchOngoingSession(); });
+}
+
+void StreamingEngine::addJob(std::function<void()> job) {
+    start();
+    worker->addJob(std::move(job));
+}
+
+void StreamingEngine::fetchUserContextAndSession() {
+    // En cas d'échec, AuthService déconnecte l'utilisateur (LogoutEvent)
+    if (context.getAuthService().fetchUserContext().has_value()) {
+        fetchOngoingSession();
+    }
+}
+
+void StreamingEngine::fetchOngoingSession() {
+    const auto res = ApiService::makeGETRequest(ApiRoute::GetMyOngoingSessions);
+    if (res.isEmpty()) {
+        return;
+    }
+    const auto sessions = PopulatedSession::parseArrayFromJsonString(res);
+    // Toutes les sessions : l'émetteur garde une connexion par session, sans couper les autres quand la liste change
+    setOngoingSessions(std::vector<PopulatedSession>(sessions.begin(), sessions.end()));
+    if (sessions.isEmpty()) {
+        return;
+    }
+    if (!sessionWebSocketService.isConnected()) {
+        sessionWebSocketService.connectToServer();
+    }
+}
+
+void StreamingEngine::setOngoingSessions(const std::vector<PopulatedSession> &sessions) {
+    {
+        const std::lock_guard lock(sessionMutex);
+        ongoingSessions = sessions;
+    }
+    auto &eventManager = context.getEventManager();
+    eventManager.publish(OngoingSessionsChangedEvent{sessions});
+    eventManager.publish(OngoingSessionChangedEvent{
+        sessions.empty() ? std::nullopt : std::optional<PopulatedSession>(sessions.front())
+    });
+}
+
+void StreamingEngine::onLogout() {
+    audioService.disconnect();
+    sessionWebSocketService.disconnectToServer();
+    setOngoingSessions({});
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "EngineContext.h"
+#include "Api/WebSocketService.h"
+#include "Models/Session.h"
+
+#ifdef IN_RECEIVING_MODE
+#include "RtcReceiver/WebRTCAudioReceiverService.h"
+#else
+#include "RtcSender/WebRTCAudioSenderService.h"
+#endif
+
+// Moteur de diffusion d'une instance du plugin, détenu par MainAudioProcessor : connexion WebRTC,
+// WebSocket de la session en cours et appels à l'API. Il vit aussi longtemps que le processeur ;
+// l'éditeur n'en est qu'une vue, qui lit l'état courant et s'abonne aux événements du bus.
+// Les appels réseau passent par un thread de travail, jamais par le message thread : leurs résultats
+// sont publiés sur le bus (UserContextChangedEvent, OngoingSessionChangedEvent, OngoingSessionsChangedEvent).
+// La construction ne fait que de l'initialisation en mémoire (les hôtes instancient le plugin en boucle
+// pendant le scan) : thread de travail, libdatachannel et appels à l'API n'existent qu'après start().
+class StreamingEngine
+{
+public:
+#ifdef IN_RECEIVING_MODE
+    using AudioService = WebRTCAudioReceiverService;
+    StreamingEngine(EngineContext& engineContext, AudioPlayout& audioPlayout);
+#else
+    using AudioService = WebRTCAudioSenderService;
+    StreamingEngine(EngineContext& engineContext, SpscAudioFifo& captureFifo);
+#endif
+    ~StreamingEngine();
+
+    StreamingEngine(const StreamingEngine&) = delete;
+    StreamingEngine& operator=(const StreamingEngine&) = delete;
+
+    [[nodiscard]] AudioService& getAudioService() noexcept { return audioService; }
+    // Première session en cours
+    [[nodiscard]] std::optional<PopulatedSession> getOngoingSession() const;
+    [[nodiscard]] std::vector<PopulatedSession> getOngoingSessions() const;
+
+    // Démarre le moteur au premier appel (premier prepareToPlay, ouverture de l'éditeur) : crée le thread
+    // de travail, y initialise libdatachannel puis charge le contexte utilisateur. Sans effet ensuite.
+    void start();
+
+    // Relance en arrière-plan la lecture du contexte utilisateur puis de la session en cours (démarre le moteur)
+    void refreshUserContext();
+    // Relance en arrière-plan la recherche des sessions en cours (démarre le moteur)
+    void refreshOngoingSession();
+
+private:
+    // Thread de travail
+    void fetchUserContextAndSession();
+    void fetchOngoingSession();
+    void setOngoingSessions(const std::vector<PopulatedSession>& sessions);
+    void onLogout();
+    void addJob(std::function<void()> job);
+
+    EngineContext& context;
+    AudioService audioService;
+    WebSocketService sessionWebSocketService;
+
+    mutable std::mutex sessionMutex;
+    std::vector<PopulatedSession> ongoingSessions;
+
+    EventSubscription loginSubscription, logoutSubscription;
+    std::once_flag started;
+    // Créé par start() ; arrêté par le destructeur après la fin de toutes les requêtes en cours
+    std::unique_ptr<juce::ThreadPool> worker;
+};
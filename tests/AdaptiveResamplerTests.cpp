@@ -0,0 +1,83 @@
+#include <Common/AdaptiveResampler.h>
+#include <Common/ClockDriftEstimator.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <vector>
+
+TEST_CASE ("AdaptiveResampler", "[resampler]")
+{
+    constexpr int blockSize = 480;
+    AdaptiveResampler resampler;
+    resampler.prepare (48000.0, 48000.0, blockSize);
+
+    std::vector<float> input (blockSize);
+    std::vector<float> output (static_cast<size_t> (resampler.getMaxOutputSamples()));
+
+    SECTION ("a unit ratio passes samples through with a fixed delay")
+    {
+        std::vector<float> played;
+        for (int block = 0; block < 4; ++block)
+        {
+            for (int i = 0; i < blockSize; ++i)
+                input[static_cast<size_t> (i)] = static_cast<float> (block * blockSize + i);
+            const int numOutput = resampler.process (input.data(), blockSize, output.data());
+            CHECK (numOutput == blockSize);
+            played.insert (played.end(), output.begin(), output.begin() + numOutput);
+        }
+
+        for (size_t i = 2; i < played.size(); ++i)
+            REQUIRE (played[i] == Catch::Approx (static_cast<float> (i - 2)));
+    }
+
+    SECTION ("the fine ratio changes the number of samples produced")
+    {
+        resampler.setRatio (1.001);
+        int totalOutput = 0;
+        for (int block = 0; block < 100; ++block)
+            totalOutput += resampler.process (input.data(), blockSize, output.data());
+        CHECK (std::abs (totalOutput - static_cast<int> (100 * blockSize / 1.001)) <= 2);
+    }
+
+    SECTION ("the ratio is clamped to the preallocated range")
+    {
+        resampler.setRatio (0.5);
+        CHECK (resampler.getRatio() == Catch::Approx (1.0 - AdaptiveResampler::maxRatioDeviation));
+        CHECK (resampler.process (input.data(), blockSize, output.data()) <= resampler.getMaxOutputSamples());
+    }
+}
+
+TEST_CASE ("ClockDriftEstimator", "[resampler]")
+{
+    ClockDriftEstimator estimator;
+
+    SECTION ("a steady buffer on target needs no correction")
+    {
+        for (int i = 0; i < 1000; ++i)
+            estimator.update (960.0, 960.0, 480.0);
+        CHECK (estimator.getCorrectionPpm() == Catch::Approx (0.0));
+    }
+
+    SECTION ("the buffer stays bounded when the sender clock runs fast")
+    {
+        // Émetteur 150 ppm plus rapide que l'hôte, une heure simulée par pas de 10 ms
+        constexpr double senderDrift = 150.0e-6;
+        constexpr double target = 960.0;
+        double buffered = target;
+        double ratio = 1.0;
+        double maxError = 0.0;
+        double settledError = 0.0;
+        for (int step = 0; step < 360000; ++step)
+        {
+            buffered += 480.0 * (1.0 + senderDrift) - 480.0 * ratio;
+            ratio = estimator.update (buffered, target, 480.0);
+            maxError = std::max (maxError, std::abs (buffered - target));
+            if (step > 30000)
+                settledError = std::max (settledError, std::abs (buffered - target));
+        }
+
+        CHECK (estimator.getCorrectionPpm() == Catch::Approx (150.0).margin (1.0));
+        CHECK (maxError < 240.0); // jamais plus de 5 ms d'écart
+        CHECK (settledError < 5.0); // dérive rattrapée en moins de 5 minutes
+    }
+}
@@ -0,0 +1,64 @@
+#include <AudioSettings.h>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <thread>
+
+TEST_CASE ("AudioSettings snapshots", "[settings]")
+{
+    AudioSettings settings;
+    CHECK (settings.getVersion() == 0);
+
+    SECTION ("publishing new values bumps the version once")
+    {
+        auto snapshot = settings.getSnapshot();
+        snapshot.sampleRate = 96000;
+        snapshot.blockSize = 128;
+        REQUIRE (settings.publish (snapshot));
+
+        const auto published = settings.getSnapshot();
+        CHECK (published.version == 1);
+        CHECK (published.sampleRate == 96000);
+        CHECK (published.blockSize == 128);
+        CHECK (settings.getSampleRate() == 96000);
+    }
+
+    SECTION ("publishing identical values keeps the version")
+    {
+        // prepareToPlay est souvent rappelé avec les mêmes valeurs : rien ne doit être reconstruit
+        CHECK_FALSE (settings.publish (settings.getSnapshot()));
+        CHECK (settings.getVersion() == 0);
+    }
+
+    SECTION ("a reader never sees a half-published snapshot")
+    {
+        // Deux configurations cohérentes alternées : fréquence et taille de bloc changent toujours ensemble
+        AudioSettings::Snapshot low, high;
+        low.sampleRate = 44100;
+        low.blockSize = 441;
+        high.sampleRate = 96000;
+        high.blockSize = 960;
+
+        std::atomic<bool> running { true };
+        std::thread writer ([&] {
+            for (int i = 0; running.load(); ++i)
+                settings.publish (i % 2 == 0 ? high : low);
+        });
+
+        int tornReads = 0;
+        uint64_t lastVersion = 0;
+        bool versionsMonotonic = true;
+        for (int i = 0; i < 200000; ++i)
+        {
+            const auto snapshot = settings.getSnapshot();
+            if (snapshot.blockSize * 100 != snapshot.sampleRate && snapshot.version != 0)
+                ++tornReads;
+            versionsMonotonic = versionsMonotonic && snapshot.version >= lastVersion;
+            lastVersion = snapshot.version;
+        }
+
+        running.store (false);
+        writer.join();
+        CHECK (tornReads == 0);
+        CHECK (versionsMonotonic);
+    }
+}
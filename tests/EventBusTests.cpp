@@ -0,0 +1,181 @@
+#include <Common/EventBus.h>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct BlockEvent
+    {
+        int value;
+    };
+
+    struct StateEvent
+    {
+        bool connected;
+    };
+
+    using TestBus = EventBus<BlockEvent, StateEvent>;
+
+    // Attend qu'une condition devienne vraie, au plus une seconde
+    template <typename Predicate>
+    bool waitFor (Predicate predicate)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds (1);
+        while (! predicate())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+}
+
+TEST_CASE ("EventBus synchronous delivery", "[events]")
+{
+    TestBus bus;
+    int blockSum = 0;
+    int stateCount = 0;
+
+    auto blockSubscription = bus.subscribe<BlockEvent> ([&] (const BlockEvent& event) { blockSum += event.value; });
+    auto stateSubscription = bus.subscribe<StateEvent> ([&] (const StateEvent&) { ++stateCount; });
+
+    SECTION ("only the subscribers of the published type are called")
+    {
+        bus.publish (BlockEvent { 3 });
+        bus.publish (BlockEvent { 4 });
+        CHECK (blockSum == 7);
+        CHECK (stateCount == 0);
+
+        bus.publish (StateEvent { true });
+        CHECK (stateCount == 1);
+        CHECK (blockSum == 7);
+    }
+
+    SECTION ("a reset subscription is no longer called")
+    {
+        CHECK (bus.getNumSubscribers<BlockEvent>() == 1);
+        blockSubscription.reset();
+        CHECK_FALSE (blockSubscription.isActive());
+        CHECK (bus.getNumSubscribers<BlockEvent>() == 0);
+
+        bus.publish (BlockEvent { 3 });
+        CHECK (blockSum == 0);
+    }
+
+    SECTION ("a moved subscription keeps delivering")
+    {
+        EventSubscription moved = std::move (blockSubscription);
+        bus.publish (BlockEvent { 5 });
+        CHECK (blockSum == 5);
+
+        moved = EventSubscription();
+        bus.publish (BlockEvent { 5 });
+        CHECK (blockSum == 5);
+    }
+
+    SECTION ("a subscriber can unsubscribe from its own callback")
+    {
+        int calls = 0;
+        EventSubscription selfRemoving;
+        selfRemoving = bus.subscribe<BlockEvent> ([&] (const BlockEvent&) {
+            ++calls;
+            selfRemoving.reset();
+        });
+
+        bus.publish (BlockEvent { 1 });
+        bus.publish (BlockEvent { 1 });
+        CHECK (calls == 1);
+        CHECK (blockSum == 2);
+    }
+}
+
+TEST_CASE ("EventBus instances are independent", "[events]")
+{
+    // Une instance du plugin par bus : les blocs d'une piste ne doivent pas atteindre l'autre
+    TestBus drums, bass;
+    int drumsBlocks = 0;
+    int bassBlocks = 0;
+    const auto drumsSubscription = drums.subscribe<BlockEvent> ([&] (const BlockEvent&) { ++drumsBlocks; });
+    const auto bassSubscription = bass.subscribe<BlockEvent> ([&] (const BlockEvent&) { ++bassBlocks; });
+
+    drums.publish (BlockEvent { 1 });
+    drums.publish (BlockEvent { 1 });
+    bass.publish (BlockEvent { 1 });
+
+    CHECK (drumsBlocks == 2);
+    CHECK (bassBlocks == 1);
+}
+
+TEST_CASE ("EventBus concurrent publish and unsubscribe", "[events]")
+{
+    TestBus bus;
+    std::atomic<bool> running { true };
+    std::atomic<int> deliveredAfterReset { 0 };
+
+    // Thread de publication façon thread audio : ne s'arrête jamais pendant les (dés)abonnements
+    std::thread publisher ([&] {
+        while (running.load())
+            bus.publish (BlockEvent { 1 });
+    });
+
+    for (int i = 0; i < 500; ++i)
+    {
+        std::atomic<bool> removed { false };
+        auto subscription = bus.subscribe<BlockEvent> ([&] (const BlockEvent&) {
+            if (removed.load())
+                deliveredAfterReset.fetch_add (1);
+        });
+        std::this_thread::yield();
+        subscription.reset();
+        removed.store (true);
+    }
+
+    running.store (false);
+    publisher.join();
+
+    CHECK (deliveredAfterReset.load() == 0);
+    CHECK (bus.getNumSubscribers<BlockEvent>() == 0);
+}
+
+TEST_CASE ("EventBus reclaims retired lists while publishing never stops", "[events]")
+{
+    TestBus bus;
+    std::binary_semaphore firstGate { 0 }, secondGate { 0 };
+    std::atomic<int> entered { 0 };
+    std::atomic<bool> running { true };
+
+    // Chaque publication bloque dans le callback : il y a toujours un lecteur en cours quand la liste change
+    auto blocking = bus.subscribe<BlockEvent> ([&] (const BlockEvent&) {
+        const int call = entered.fetch_add (1);
+        if (call == 0)
+            firstGate.acquire();
+        else if (call == 1)
+            secondGate.acquire();
+    });
+    std::thread publisher ([&] {
+        while (running.load())
+            bus.publish (BlockEvent { 1 });
+    });
+
+    REQUIRE (waitFor ([&] { return entered.load() == 1; }));
+    auto second = bus.subscribe<BlockEvent> ([] (const BlockEvent&) {});
+    // Le lecteur bloqué peut encore parcourir l'ancienne liste
+    CHECK (bus.getNumRetiredLists<BlockEvent>() == 1);
+
+    firstGate.release();
+    REQUIRE (waitFor ([&] { return entered.load() >= 2; }));
+    auto third = bus.subscribe<BlockEvent> ([] (const BlockEvent&) {});
+    // Le lecteur de l'époque précédente est sorti : sa liste est libérée, seule la plus récente reste
+    CHECK (bus.getNumRetiredLists<BlockEvent>() == 1);
+
+    running.store (false);
+    secondGate.release();
+    publisher.join();
+    third.reset();
+    CHECK (bus.getNumRetiredLists<BlockEvent>() == 0);
+}
@@ -0,0 +1,123 @@
+#include <Common/JitterBuffer.h>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace
+{
+    const unsigned char payload[] = { 0x01, 0x02, 0x03 };
+
+    bool insertFrame (JitterBuffer& buffer, const int64_t sequence, const int64_t arrivalTime)
+    {
+        return buffer.insert (sequence, static_cast<uint32_t> (sequence * 480), payload, sizeof (payload), 480, arrivalTime);
+    }
+}
+
+TEST_CASE ("JitterBuffer", "[jitter]")
+{
+    JitterBuffer buffer;
+
+    SECTION ("nothing to consume before the first packet")
+    {
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Empty);
+        CHECK (buffer.getBufferedSamples() == 0);
+    }
+
+    SECTION ("reordered packets are played in sequence order")
+    {
+        REQUIRE (insertFrame (buffer, 10, 0));
+        REQUIRE (insertFrame (buffer, 12, 960));
+        REQUIRE (insertFrame (buffer, 11, 1200));
+        CHECK (buffer.getBufferedSamples() == 3 * 480);
+
+        std::vector<int64_t> played;
+        while (buffer.consume ([&] (const JitterBuffer::Packet& packet) { played.push_back (packet.sequence); }) == JitterBuffer::PopResult::Packet)
+        {
+        }
+        CHECK (played == std::vector<int64_t> { 10, 11, 12 });
+    }
+
+    SECTION ("duplicates and late packets are rejected")
+    {
+        REQUIRE (insertFrame (buffer, 10, 0));
+        CHECK_FALSE (insertFrame (buffer, 10, 0));
+        CHECK (buffer.getNumDuplicatePackets() == 1);
+
+        buffer.skip();
+        CHECK_FALSE (insertFrame (buffer, 9, 0));
+        CHECK (buffer.getNumLatePackets() == 1);
+    }
+
+    SECTION ("a gap is reported as missing once later packets have arrived")
+    {
+        REQUIRE (insertFrame (buffer, 10, 0));
+        REQUIRE (insertFrame (buffer, 12, 960));
+
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Packet);
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Missing);
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Packet);
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Empty);
+    }
+
+    SECTION ("peek reads the expected packet without consuming it")
+    {
+        REQUIRE (insertFrame (buffer, 10, 0));
+
+        int64_t peeked = -1;
+        CHECK (buffer.peek ([&] (const JitterBuffer::Packet& packet) { peeked = packet.sequence; }));
+        CHECK (peeked == 10);
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Packet);
+        CHECK_FALSE (buffer.peek ([] (const JitterBuffer::Packet&) {}));
+    }
+
+    SECTION ("the stream resumes after an outage longer than the buffer")
+    {
+        REQUIRE (insertFrame (buffer, 10, 0));
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Packet);
+
+        // Coupure d'une seconde (100 paquets perdus) : le premier paquet de la reprise déclenche le recalage
+        CHECK_FALSE (insertFrame (buffer, 111, 48000));
+        CHECK (buffer.getNumOverflowPackets() == 1);
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Empty);
+        CHECK (buffer.getNextSequence() == 111);
+
+        REQUIRE (insertFrame (buffer, 112, 48480));
+        CHECK (buffer.consume ([] (const JitterBuffer::Packet&) {}) == JitterBuffer::PopResult::Missing);
+        int64_t played = -1;
+        CHECK (buffer.consume ([&] (const JitterBuffer::Packet& packet) { played = packet.sequence; }) == JitterBuffer::PopResult::Packet);
+        CHECK (played == 112);
+    }
+
+    SECTION ("skipTo drops the backlog in one step")
+    {
+        for (int64_t sequence = 10; sequence < 20; ++sequence)
+            REQUIRE (insertFrame (buffer, sequence, sequence * 480));
+
+        buffer.skipTo (18);
+        CHECK (buffer.getBufferedSamples() == 2 * 480);
+        int64_t played = -1;
+        CHECK (buffer.consume ([&] (const JitterBuffer::Packet& packet) { played = packet.sequence; }) == JitterBuffer::PopResult::Packet);
+        CHECK (played == 18);
+
+        // Les cases abandonnées sont réutilisables par les paquets suivants
+        for (int64_t sequence = 20; sequence < 20 + JitterBuffer::numSlots - 1; ++sequence)
+            REQUIRE (insertFrame (buffer, sequence, sequence * 480));
+    }
+
+    SECTION ("regular arrivals keep the target delay at one frame")
+    {
+        for (int64_t sequence = 0; sequence < 50; ++sequence)
+            REQUIRE (insertFrame (buffer, sequence, sequence * 480));
+
+        CHECK (buffer.getJitterSamples() == 0.0);
+        CHECK (buffer.getTargetDelaySamples() == 480);
+    }
+
+    SECTION ("irregular arrivals raise the target delay")
+    {
+        for (int64_t sequence = 0; sequence < 50; ++sequence)
+            REQUIRE (insertFrame (buffer, sequence, sequence * 480 + (sequence % 2) * 480));
+
+        CHECK (buffer.getJitterSamples() > 0.0);
+        CHECK (buffer.getTargetDelaySamples() > 480);
+    }
+}
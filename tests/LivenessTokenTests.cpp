@@ -0,0 +1,49 @@
+#include <Common/LivenessToken.h>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <semaphore>
+#include <thread>
+
+TEST_CASE ("LivenessToken", "[rtc]")
+{
+    auto token = std::make_unique<LivenessToken>();
+    const auto state = token->getState();
+
+    SECTION ("a callback runs only while the owner is alive")
+    {
+        {
+            const LivenessToken::Scope scope (*state);
+            CHECK (static_cast<bool> (scope));
+        }
+        token.reset();
+        const LivenessToken::Scope scope (*state);
+        CHECK_FALSE (static_cast<bool> (scope));
+    }
+
+    SECTION ("invalidation waits for a callback running on another thread")
+    {
+        std::binary_semaphore entered { 0 }, release { 0 };
+        std::atomic<bool> finished { false };
+        std::thread callback ([&] {
+            const LivenessToken::Scope scope (*state);
+            entered.release();
+            release.acquire();
+            std::this_thread::sleep_for (std::chrono::milliseconds (5));
+            finished = true;
+        });
+
+        entered.acquire();
+        release.release();
+        token->invalidate();
+        CHECK (finished.load());
+        callback.join();
+    }
+
+    SECTION ("an owner destroyed from its own callback does not wait for itself")
+    {
+        const LivenessToken::Scope scope (*state);
+        token.reset();
+        CHECK_FALSE (static_cast<bool> (scope));
+    }
+}
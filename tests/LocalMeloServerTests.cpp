@@ -0,0 +1,100 @@
+#include <LocalMeloServer.h>
+#include <Api/ApiService.h>
+#include <Api/SocketRoutes.h>
+#include <Api/WebSocketService.h>
+#include <Common/EventManager.h>
+#include <Config.h>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace
+{
+    // Dernier message reçu sur le bus d'une instance (thread ixwebsocket)
+    class MessageProbe
+    {
+    public:
+        explicit MessageProbe (EventManager& eventManager)
+        {
+            subscription = eventManager.subscribe<MessageWsReceivedEvent> ([this] (const MessageWsReceivedEvent& event) {
+                {
+                    const std::lock_guard lock (mutex);
+                    received = event;
+                }
+                condition.notify_all();
+            });
+        }
+
+        std::optional<MessageWsReceivedEvent> waitForMessage (const std::chrono::milliseconds timeout)
+        {
+            std::unique_lock lock (mutex);
+            condition.wait_for (lock, timeout, [&] { return received.has_value(); });
+            return received;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::optional<MessageWsReceivedEvent> received;
+        EventSubscription subscription;
+    };
+}
+
+TEST_CASE ("LocalMeloServer stands in for the Melo server", "[server]")
+{
+    LocalMeloServer server (LocalMeloServer::defaultPort + 200);
+    REQUIRE (server.start());
+    const auto previousUrls = Config::getServerUrls();
+    REQUIRE (Config::setServerUrls ({ server.getApiUrl(), server.getWebsocketUrl() }));
+
+    SECTION ("the API routes answer with the local session")
+    {
+        CHECK (ApiService::makeGETRequest (ApiRoute::GetHealth).contains ("ok"));
+
+        const auto sessions = PopulatedSession::parseArrayFromJsonString (ApiService::makeGETRequest (ApiRoute::GetMyOngoingSessions));
+        REQUIRE (sessions.size() == 1);
+        CHECK (sessions.getFirst()._id == "local-session");
+        CHECK (sessions.getFirst().seller.user._id == "local-seller-user");
+        CHECK (sessions.getFirst().reservedByArtist.user._id == "local-artist-user");
+    }
+
+    SECTION ("signaling is relayed from one RTC route to the other")
+    {
+        EventManager senderEvents, receiverEvents;
+        WebSocketService senderSocket (getWsRouteString (WsRoute::GetOngoingSessionRTCInstru), senderEvents);
+        WebSocketService receiverSocket (getWsRouteString (WsRoute::GetOngoingSessionRTCVoice), receiverEvents);
+        MessageProbe senderProbe (senderEvents), receiverProbe (receiverEvents);
+        receiverSocket.connectToServer();
+        // Le serveur ne garde rien : le récepteur doit être connecté avant que l'offre ne soit relayée
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds (5);
+        while (! receiverSocket.isConnected() && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for (std::chrono::milliseconds (5));
+        REQUIRE (receiverSocket.isConnected());
+
+        // Envoyé avant l'ouverture : mis en file par la connexion partagée puis relayé au récepteur
+        senderSocket.sendMessage ("offer", StringUtils::createWsMessage ("offer", { { "sdp", "v=0" }, { "sessionId", "local-session" } }));
+
+        const auto offer = receiverProbe.waitForMessage (std::chrono::seconds (5));
+        REQUIRE (offer.has_value());
+        CHECK (offer->type == "offer");
+        CHECK (offer->data["sdp"] == "v=0");
+        CHECK_FALSE (senderProbe.waitForMessage (std::chrono::milliseconds (100)).has_value());
+        CHECK (server.getNumRelayedMessages() == 1);
+    }
+
+    Config::setServerUrls (previousUrls);
+}
+
+TEST_CASE ("Config recognises a local server", "[server]")
+{
+    CHECK (Config::isLoopbackUrl ("http://127.0.0.1:5055/api"));
+    CHECK (Config::isLoopbackUrl ("ws://localhost:5055"));
+    CHECK (Config::isLoopbackUrl ("ws://[::1]:5055"));
+    CHECK_FALSE (Config::isLoopbackUrl (Config::apiUrl));
+    CHECK_FALSE (Config::isLoopbackUrl ("https://127.0.0.1.example.com/api"));
+    CHECK_FALSE (Config::isLoopbackUrl ("https://127.0.0.1@example.com/api"));
+    CHECK_FALSE (Config::isLoopbackUrl ("https://localhost.example.com"));
+}
@@ -0,0 +1,147 @@
+#include <Common/LoopbackRing.h>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+
+namespace
+{
+    // Fichier d'anneau propre à un test, supprimé à la fin
+    struct TemporaryRingFile
+    {
+        TemporaryRingFile() : file (juce::File::getSpecialLocation (juce::File::tempDirectory).getNonexistentChildFile ("LoopbackRingTest", ".ring")) {}
+        ~TemporaryRingFile() { file.deleteFile(); }
+
+        juce::File file;
+    };
+
+    std::array<float, LoopbackRing::frameSamples> makeFrame (const float value)
+    {
+        std::array<float, LoopbackRing::frameSamples> frame {};
+        frame.fill (value);
+        return frame;
+    }
+}
+
+TEST_CASE ("LoopbackRing", "[loopback]")
+{
+    // Deux projections du même fichier : émetteur et récepteur comme dans deux processus
+    const TemporaryRingFile ringFile;
+    LoopbackRing writer, reader;
+    REQUIRE (writer.open (ringFile.file, LoopbackRing::Role::Writer));
+
+    LoopbackRing::FrameInfo info;
+    std::array<float, LoopbackRing::frameSamples> received {};
+
+    SECTION ("each side detects the other through its heartbeat")
+    {
+        CHECK (writer.ownsRing());
+        CHECK_FALSE (writer.isPeerPresent());
+
+        REQUIRE (reader.open (ringFile.file, LoopbackRing::Role::Reader));
+        CHECK (writer.isPeerPresent());
+        CHECK (reader.isPeerPresent());
+
+        writer.close();
+        CHECK_FALSE (reader.isPeerPresent());
+    }
+
+    SECTION ("frames arrive in order, without loss")
+    {
+        REQUIRE (reader.open (ringFile.file, LoopbackRing::Role::Reader));
+        for (int i = 0; i < 10; ++i)
+            writer.write (makeFrame (static_cast<float> (i)).data(), LoopbackRing::frameSamples);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            REQUIRE (reader.read (info, received.data()));
+            CHECK (info.index == static_cast<uint64_t> (i));
+            CHECK (info.numSamples == LoopbackRing::frameSamples);
+            CHECK (received.front() == static_cast<float> (i));
+            CHECK (received.back() == static_cast<float> (i));
+        }
+        CHECK_FALSE (reader.read (info, received.data()));
+        CHECK (reader.getNumOverruns() == 0);
+    }
+
+    SECTION ("a reader starts live, not at the start of the history")
+    {
+        writer.write (makeFrame (1.0f).data(), LoopbackRing::frameSamples);
+        REQUIRE (reader.open (ringFile.file, LoopbackRing::Role::Reader));
+        CHECK_FALSE (reader.read (info, received.data()));
+
+        writer.write (makeFrame (2.0f).data(), 100);
+        REQUIRE (reader.read (info, received.data()));
+        CHECK (info.index == 1);
+        CHECK (info.numSamples == 100);
+        CHECK (received.front() == 2.0f);
+    }
+
+    SECTION ("a lagging reader skips the overwritten frames")
+    {
+        REQUIRE (reader.open (ringFile.file, LoopbackRing::Role::Reader));
+        const int numFrames = LoopbackRing::numSlots + 20;
+        for (int i = 0; i < numFrames; ++i)
+            writer.write (makeFrame (static_cast<float> (i)).data(), LoopbackRing::frameSamples);
+
+        REQUIRE (reader.read (info, received.data()));
+        CHECK (info.index == static_cast<uint64_t> (numFrames - LoopbackRing::numSlots + 1));
+        CHECK (received.front() == static_cast<float> (info.index));
+        CHECK (reader.getNumOverruns() == static_cast<uint64_t> (numFrames - LoopbackRing::numSlots + 1));
+    }
+
+    SECTION ("a second sender of the session cannot take a live ring")
+    {
+        LoopbackRing otherWriter;
+        REQUIRE (otherWriter.open (ringFile.file, LoopbackRing::Role::Writer));
+        CHECK_FALSE (otherWriter.ownsRing());
+
+        // Ses écritures sont ignorées
+        REQUIRE (reader.open (ringFile.file, LoopbackRing::Role::Reader));
+        otherWriter.write (makeFrame (9.0f).data(), LoopbackRing::frameSamples);
+        CHECK_FALSE (reader.read (info, received.data()));
+
+        // Le premier parti, il reprend l'anneau sous un autre identifiant
+        writer.write (makeFrame (1.0f).data(), LoopbackRing::frameSamples);
+        writer.close();
+        otherWriter.heartbeat();
+        CHECK (otherWriter.ownsRing());
+        otherWriter.write (makeFrame (2.0f).data(), LoopbackRing::frameSamples);
+
+        LoopbackRing::FrameInfo first, second;
+        REQUIRE (reader.read (first, received.data()));
+        REQUIRE (reader.read (second, received.data()));
+        CHECK (second.index == first.index + 1);
+        CHECK (second.writerId != first.writerId);
+        CHECK (received.front() == 2.0f);
+    }
+
+    SECTION ("the ring file is removed with its last user")
+    {
+        REQUIRE (reader.open (ringFile.file, LoopbackRing::Role::Reader));
+        writer.close();
+        CHECK (ringFile.file.existsAsFile());
+        reader.close();
+        CHECK_FALSE (ringFile.file.existsAsFile());
+
+        // Rouvert ensuite : un anneau neuf
+        REQUIRE (writer.open (ringFile.file, LoopbackRing::Role::Writer));
+        CHECK (writer.ownsRing());
+        CHECK (ringFile.file.existsAsFile());
+    }
+
+#if ! JUCE_WINDOWS // un fichier projeté ne peut pas y être supprimé
+    SECTION ("the last user of a replaced ring leaves the new ring file alone")
+    {
+        REQUIRE (reader.open (ringFile.file, LoopbackRing::Role::Reader));
+        writer.close();
+
+        // Fichier supprimé sous le récepteur (nettoyage du dossier temporaire), puis recréé par un autre émetteur
+        REQUIRE (ringFile.file.deleteFile());
+        LoopbackRing otherWriter;
+        REQUIRE (otherWriter.open (ringFile.file, LoopbackRing::Role::Writer));
+
+        reader.close();
+        CHECK (ringFile.file.existsAsFile());
+        CHECK (otherWriter.ownsRing());
+    }
+#endif
+}
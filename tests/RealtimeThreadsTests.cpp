@@ -0,0 +1,144 @@
+#include <Common/RealtimeThreads.h>
+#include <Common/StreamWorkerPool.h>
+#include <catch2/catch_message.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // Retards d'une tâche périodique de 2 ms (échéance à 3 ms) pendant que des threads à la priorité par défaut
+    // occupent tous les cœurs autorisés
+    struct ContentionResult
+    {
+        uint64_t runs = 0;
+        uint64_t deadlineMisses = 0;
+        RealtimeThreads::Elevation elevation = RealtimeThreads::Elevation::Unchanged;
+    };
+
+    ContentionResult measureDeadlineMisses (const bool realtimeWorkers)
+    {
+        std::atomic<bool> contending { true };
+        std::vector<std::thread> spinners;
+        const auto numSpinners = std::max<size_t> (1, RealtimeThreads::getAllowedCpus().size());
+        for (size_t i = 0; i < numSpinners; ++i)
+            spinners.emplace_back ([&] {
+                while (contending.load (std::memory_order_relaxed)) {}
+            });
+
+        ContentionResult result;
+        {
+            StreamWorkerPool pool (1, realtimeWorkers);
+            auto periodic = pool.registerStream ([] {
+                const auto release = StreamWorkerPool::Clock::now() + 2ms;
+                return std::optional<StreamWorkerPool::Run> ({ release, release + 3ms });
+            });
+            periodic.scheduleNow (3ms);
+            std::this_thread::sleep_for (500ms);
+            result.runs = periodic.getNumRuns();
+            result.deadlineMisses = periodic.getNumDeadlineMisses();
+            result.elevation = pool.getThreadReports().front().elevation;
+        }
+
+        contending = false;
+        for (auto& spinner: spinners)
+            spinner.join();
+        return result;
+    }
+}
+
+TEST_CASE ("RealtimeThreads", "[realtime]")
+{
+    SECTION ("promotion reports what was obtained")
+    {
+        // Le résultat dépend des droits de la machine de test : seule la cohérence du rapport est vérifiée
+        const int cpu = RealtimeThreads::getWorkerCpu (0);
+        RealtimeThreads::Report report;
+        std::thread worker ([&] {
+            RealtimeThreads::Options options;
+            options.cpu = cpu;
+            report = RealtimeThreads::promoteCurrentThread (options);
+        });
+        worker.join();
+
+        if (report.elevation == RealtimeThreads::Elevation::Realtime)
+            CHECK (report.priority > 0);
+        if (report.elevation == RealtimeThreads::Elevation::Unchanged)
+            CHECK (report.describe().rfind ("default priority", 0) == 0);
+        // Un cœur du cpuset est toujours accordé
+        CHECK (report.affinitySet == (cpu >= 0));
+    }
+
+    SECTION ("a core outside the allowed set is not requested")
+    {
+        const auto allowed = RealtimeThreads::getAllowedCpus();
+        RealtimeThreads::Report report;
+        std::thread worker ([&] {
+            RealtimeThreads::Options options;
+            options.cpu = allowed.empty() ? 0 : allowed.back() + 1;
+            report = RealtimeThreads::promoteCurrentThread (options);
+        });
+        worker.join();
+        CHECK_FALSE (report.affinitySet);
+    }
+
+    SECTION ("locked memory is released with its owner")
+    {
+        std::vector<float> workingSet (4096, 0.0f);
+        RealtimeThreads::LockedMemory locked;
+        CHECK (locked.lock (nullptr, 0));
+        if (locked.lockContainer (workingSet))
+            CHECK (locked.getLockedBytes() == workingSet.size() * sizeof (float));
+        locked.unlockAll();
+        CHECK (locked.getLockedBytes() == 0);
+    }
+
+    SECTION ("a page shared by two regions stays locked until both are released")
+    {
+        const auto lockedBefore = RealtimeThreads::LockedMemory::getNumLockedPages();
+        std::vector<float> buffer (64, 0.0f);
+        RealtimeThreads::LockedMemory first, second;
+        if (first.lock (buffer.data(), 32 * sizeof (float)) && second.lock (buffer.data() + 32, 32 * sizeof (float)))
+        {
+            const auto lockedPages = RealtimeThreads::LockedMemory::getNumLockedPages();
+            CHECK (lockedPages > lockedBefore);
+            first.unlockAll();
+            CHECK (RealtimeThreads::LockedMemory::getNumLockedPages() == lockedPages);
+
+            // Reconstruction : le nouveau jeu, verrouillé d'abord, remplace l'ancien sans rien déverrouiller
+            RealtimeThreads::LockedMemory rebuilt;
+            REQUIRE (rebuilt.lock (buffer.data(), buffer.size() * sizeof (float)));
+            second = std::move (rebuilt);
+            CHECK (RealtimeThreads::LockedMemory::getNumLockedPages() == lockedPages);
+            second.unlockAll();
+        }
+        CHECK (RealtimeThreads::LockedMemory::getNumLockedPages() == lockedBefore);
+    }
+
+    SECTION ("each started pool thread reports its promotion")
+    {
+        StreamWorkerPool pool (2, true);
+        auto a = pool.registerStream ([] { return std::optional<StreamWorkerPool::Run>(); });
+        CHECK (pool.getThreadReports().size() == 1);
+        auto b = pool.registerStream ([] { return std::optional<StreamWorkerPool::Run>(); });
+        CHECK (pool.getThreadReports().size() == 2);
+    }
+
+    SECTION ("a real-time worker keeps its deadlines under contention")
+    {
+        const auto promoted = measureDeadlineMisses (true);
+        const auto plain = measureDeadlineMisses (false);
+        UNSCOPED_INFO ("real-time worker: " << promoted.deadlineMisses << " misses / " << promoted.runs << " runs");
+        UNSCOPED_INFO ("default worker: " << plain.deadlineMisses << " misses / " << plain.runs << " runs");
+        CHECK (promoted.runs > 0);
+        CHECK (plain.runs > 0);
+
+        // Sans droit au temps réel (machine de CI), seule la mesure est rapportée
+        if (promoted.elevation == RealtimeThreads::Elevation::Realtime)
+            CHECK (promoted.deadlineMisses * 100 <= promoted.runs);
+    }
+}
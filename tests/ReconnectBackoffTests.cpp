@@ -0,0 +1,38 @@
+#include <Common/ReconnectBackoff.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE ("ReconnectBackoff", "[rtc]")
+{
+    ReconnectBackoff backoff ({ 100, 1000, 6 }, 42);
+
+    SECTION ("the ceiling doubles up to the maximum delay")
+    {
+        CHECK (backoff.getCeilingMs (0) == 100);
+        CHECK (backoff.getCeilingMs (1) == 200);
+        CHECK (backoff.getCeilingMs (3) == 800);
+        CHECK (backoff.getCeilingMs (4) == 1000);
+        CHECK (backoff.getCeilingMs (30) == 1000);
+    }
+
+    SECTION ("each delay is jittered between half and all of its ceiling")
+    {
+        for (int attempt = 0; attempt < 6; ++attempt)
+        {
+            const int delay = backoff.nextDelayMs();
+            CHECK (delay >= backoff.getCeilingMs (attempt) / 2);
+            CHECK (delay <= backoff.getCeilingMs (attempt));
+        }
+        CHECK (backoff.isExhausted());
+        CHECK (backoff.nextDelayMs() == -1);
+    }
+
+    SECTION ("a reset starts again from the initial delay")
+    {
+        for (int attempt = 0; attempt < 6; ++attempt)
+            backoff.nextDelayMs();
+        backoff.reset();
+
+        CHECK (backoff.getAttempts() == 0);
+        CHECK (backoff.nextDelayMs() <= 100);
+    }
+}
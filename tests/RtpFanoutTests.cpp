@@ -0,0 +1,100 @@
+#include <Common/RtpFanout.h>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace
+{
+    // Tient lieu de piste : garde une copie des paquets envoyés, comme libdatachannel
+    struct FakeTrack
+    {
+        bool accept = true;
+        std::vector<std::vector<std::byte>> sent;
+
+        bool operator() (const std::span<const std::byte> packet)
+        {
+            if (accept)
+                sent.emplace_back (packet.begin(), packet.end());
+            return accept;
+        }
+    };
+
+    RtpPacketBuffer makePacket()
+    {
+        RtpPacketBuffer packet;
+        packet.payload()[0] = 0x42;
+        packet.size = RtpHeaderTemplate::size + 1;
+        return packet;
+    }
+}
+
+TEST_CASE ("RtpFanoutOutput", "[rtp]")
+{
+    auto packet = makePacket();
+    RtpFanoutOutput artist { 0x1111, 100, 0 };
+    RtpFanoutOutput engineer { 0x2222, 65535, 1000 };
+    FakeTrack artistTrack;
+    FakeTrack engineerTrack;
+
+    SECTION ("one shared packet carries each listener's own RTP state")
+    {
+        for (uint32_t timestamp = 480; timestamp <= 960; timestamp += 480)
+        {
+            CHECK (artist.send (packet, timestamp, 0, artistTrack));
+            CHECK (engineer.send (packet, timestamp, 0, engineerTrack));
+        }
+
+        const auto first = RtpPacketView::parse (artistTrack.sent[0]);
+        REQUIRE (first.has_value());
+        CHECK (first->getSsrc() == 0x1111);
+        CHECK (first->getSequenceNumber() == 100);
+        CHECK (first->getTimestamp() == 480);
+        CHECK (first->getMarker());
+
+        const auto second = RtpPacketView::parse (engineerTrack.sent[1]);
+        REQUIRE (second.has_value());
+        CHECK (second->getSsrc() == 0x2222);
+        CHECK (second->getSequenceNumber() == 0);
+        CHECK (second->getTimestamp() == 1960);
+        CHECK_FALSE (second->getMarker());
+        CHECK (std::to_integer<int> (second->getPayload()[0]) == 0x42);
+    }
+
+    SECTION ("a backlogged track skips frames without affecting the others")
+    {
+        CHECK_FALSE (artist.send (packet, 480, RtpFanoutOutput::maxBufferedBytes + 1, artistTrack));
+        CHECK (engineer.send (packet, 480, 0, engineerTrack));
+        CHECK (artist.send (packet, 960, 0, artistTrack));
+
+        // La trame sautée compte comme une perte pour le récepteur
+        const auto view = RtpPacketView::parse (artistTrack.sent.at (0));
+        REQUIRE (view.has_value());
+        CHECK (view->getSequenceNumber() == 101);
+        CHECK (artist.getDroppedPackets() == 1);
+        CHECK (engineer.getSentPackets() == 1);
+    }
+
+    SECTION ("repeated send failures rest the track until it restarts")
+    {
+        artistTrack.accept = false;
+        for (int i = 0; i < RtpFanoutOutput::maxConsecutiveFailures; ++i)
+            CHECK_FALSE (artist.send (packet, 480, 0, artistTrack));
+
+        artistTrack.accept = true;
+        CHECK_FALSE (artist.send (packet, 960, 0, artistTrack));
+        CHECK (artistTrack.sent.empty());
+
+        artist.restart();
+        CHECK (artist.send (packet, 1440, 0, artistTrack));
+        const auto view = RtpPacketView::parse (artistTrack.sent.at (0));
+        REQUIRE (view.has_value());
+        CHECK (view->getMarker());
+    }
+
+    SECTION ("random state differs between listeners")
+    {
+        const auto a = RtpFanoutOutput::withRandomState();
+        const auto b = RtpFanoutOutput::withRandomState();
+        CHECK (a.getSsrc() != 0);
+        CHECK ((a.getSsrc() != b.getSsrc() || a.getNextSequenceNumber() != b.getNextSequenceNumber()));
+    }
+}
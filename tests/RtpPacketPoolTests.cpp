@@ -0,0 +1,64 @@
+#include <Common/RtpPacketPool.h>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+TEST_CASE ("RtpHeaderTemplate", "[rtp]")
+{
+    const RtpHeaderTemplate header { PAYLOAD_TYPE, 0xCAFEBABE };
+
+    SECTION ("the patched header matches createRTPPacket")
+    {
+        const std::vector<unsigned char> payload { 1, 2, 3 };
+        const auto reference = RTPWrapper::createRTPPacket (payload, 0xBEEF, 0x01020304, 0xCAFEBABE);
+
+        RtpPacketBuffer packet;
+        header.write (packet.data.data(), 0xBEEF, 0x01020304);
+        std::memcpy (packet.payload(), payload.data(), payload.size());
+        packet.size = RtpHeaderTemplate::size + payload.size();
+
+        const auto bytes = packet.bytes();
+        REQUIRE (bytes.size() == reference.size());
+        CHECK (std::memcmp (bytes.data(), reference.data(), reference.size()) == 0);
+    }
+
+    SECTION ("sequence, timestamp and marker are rewritten in place")
+    {
+        RtpPacketBuffer packet;
+        header.write (packet.data.data(), 1, 2, true);
+        header.write (packet.data.data(), 65535, 0xFFFFFFFF);
+        packet.payload()[0] = 0x42;
+        packet.size = RtpHeaderTemplate::size + 1;
+
+        const auto view = RtpPacketView::parse (packet.bytes());
+        REQUIRE (view.has_value());
+        CHECK_FALSE (view->getMarker());
+        CHECK (view->getPayloadType() == PAYLOAD_TYPE);
+        CHECK (view->getSequenceNumber() == 65535);
+        CHECK (view->getTimestamp() == 0xFFFFFFFF);
+        CHECK (view->getSsrc() == 0xCAFEBABE);
+    }
+}
+
+TEST_CASE ("RtpPacketPool", "[rtp]")
+{
+    constexpr int frameSamples = 480;
+    OpusEncoderWrapper encoder (48000, 2, 10, 96000);
+    RtpPacketPool<2> pool;
+    const std::vector<float> frame (static_cast<size_t> (frameSamples * 2), 0.1f);
+
+    SECTION ("a frame is encoded in place after the reserved header")
+    {
+        auto* packet = pool.encode (encoder, frame.data(), frameSamples);
+        REQUIRE (packet != nullptr);
+        CHECK (packet->size > RtpHeaderTemplate::size);
+        CHECK (packet->size <= RtpPacketBuffer::capacity);
+    }
+
+    SECTION ("packets are reused in turn")
+    {
+        auto& first = pool.acquire();
+        auto& second = pool.acquire();
+        CHECK (&first != &second);
+        CHECK (&pool.acquire() == &first);
+    }
+}
@@ -0,0 +1,89 @@
+#include <Common/RTPWrapper.h>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace
+{
+    std::vector<std::byte> toBytes (const std::vector<uint8_t>& data)
+    {
+        std::vector<std::byte> bytes (data.size());
+        for (size_t i = 0; i < data.size(); ++i)
+            bytes[i] = static_cast<std::byte> (data[i]);
+        return bytes;
+    }
+
+    // En-tête fixe : seq 0x1234, timestamp 0x01020304, SSRC 0xAABBCCDD
+    std::vector<uint8_t> makeHeader (const uint8_t v_p_x_cc, const uint8_t m_pt)
+    {
+        return { v_p_x_cc, m_pt, 0x12, 0x34, 0x01, 0x02, 0x03, 0x04, 0xAA, 0xBB, 0xCC, 0xDD };
+    }
+}
+
+TEST_CASE ("RtpPacketView", "[rtp]")
+{
+    SECTION ("header fields are read in network order")
+    {
+        auto data = makeHeader (0x80, 0x80 | 111);
+        data.insert (data.end(), { 0x10, 0x20 });
+        const auto bytes = toBytes (data);
+
+        const auto packet = RtpPacketView::parse (bytes);
+        REQUIRE (packet.has_value());
+        CHECK (packet->getMarker());
+        CHECK (packet->getPayloadType() == 111);
+        CHECK (packet->getSequenceNumber() == 0x1234);
+        CHECK (packet->getTimestamp() == 0x01020304);
+        CHECK (packet->getSsrc() == 0xAABBCCDD);
+        REQUIRE (packet->getPayload().size() == 2);
+        CHECK (packet->getPayloadData()[0] == 0x10);
+        CHECK (packet->getPayload().data() == bytes.data() + 12);
+    }
+
+    SECTION ("CSRC list, header extension and padding are skipped")
+    {
+        // P=1, X=1, CC=2
+        auto data = makeHeader (0x80 | 0x20 | 0x10 | 0x02, 111);
+        data.insert (data.end(), { 1, 1, 1, 1, 2, 2, 2, 2 }); // CSRC
+        data.insert (data.end(), { 0xBE, 0xDE, 0x00, 0x01, 9, 9, 9, 9 }); // extension d'un mot
+        data.insert (data.end(), { 0x42, 0x43, 0x44 }); // charge utile
+        data.insert (data.end(), { 0, 0, 3 }); // bourrage
+        const auto bytes = toBytes (data);
+
+        const auto packet = RtpPacketView::parse (bytes);
+        REQUIRE (packet.has_value());
+        REQUIRE (packet->getPayload().size() == 3);
+        CHECK (packet->getPayloadData()[0] == 0x42);
+        CHECK (packet->getPayloadData()[2] == 0x44);
+    }
+
+    SECTION ("truncated or malformed packets are rejected")
+    {
+        CHECK_FALSE (RtpPacketView::parse (toBytes ({ 0x80, 111, 0, 1 })).has_value());
+        CHECK_FALSE (RtpPacketView::parse (toBytes (makeHeader (0x80, 111))).has_value()); // pas de charge utile
+
+        auto wrongVersion = makeHeader (0x40, 111);
+        wrongVersion.push_back (0x10);
+        CHECK_FALSE (RtpPacketView::parse (toBytes (wrongVersion)).has_value());
+
+        auto missingCsrc = makeHeader (0x80 | 0x03, 111);
+        missingCsrc.insert (missingCsrc.end(), { 1, 2, 3, 4 });
+        CHECK_FALSE (RtpPacketView::parse (toBytes (missingCsrc)).has_value());
+
+        auto oversizedPadding = makeHeader (0x80 | 0x20, 111);
+        oversizedPadding.insert (oversizedPadding.end(), { 0x10, 0x20 });
+        CHECK_FALSE (RtpPacketView::parse (toBytes (oversizedPadding)).has_value());
+    }
+
+    SECTION ("removeRTPHeader returns the payload of a packet built by createRTPPacket")
+    {
+        const std::vector<unsigned char> payload { 7, 8, 9 };
+        const auto rtpPacket = RTPWrapper::createRTPPacket (payload, 42, 960, 1234);
+        CHECK (RTPWrapper::removeRTPHeader (rtpPacket) == payload);
+
+        const auto packet = RtpPacketView::parse (std::as_bytes (std::span (rtpPacket)));
+        REQUIRE (packet.has_value());
+        CHECK (packet->getSequenceNumber() == 42);
+        CHECK (packet->getTimestamp() == 960);
+        CHECK (packet->getSsrc() == 1234);
+    }
+}
@@ -0,0 +1,100 @@
+#include <Common/RtpSequenceTracker.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr uint32_t ssrc = 0x12345678;
+
+    RtpSequenceTracker::Result update (RtpSequenceTracker& tracker, const uint16_t sequenceNumber, int64_t& extended)
+    {
+        return tracker.update (sequenceNumber, ssrc, extended);
+    }
+}
+
+TEST_CASE ("RtpSequenceTracker", "[rtp]")
+{
+    RtpSequenceTracker tracker;
+    int64_t extended = -1;
+
+    SECTION ("sequence numbers are extended across the 16-bit wraparound")
+    {
+        REQUIRE (update (tracker, 65534, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (extended == 65534);
+        REQUIRE (update (tracker, 65535, extended) == RtpSequenceTracker::Result::Accepted);
+        REQUIRE (update (tracker, 0, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (extended == 65536);
+        REQUIRE (update (tracker, 1, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (extended == 65537);
+        CHECK (tracker.getStatistics().lost == 0);
+    }
+
+    SECTION ("a packet reordered across the wraparound keeps its place")
+    {
+        REQUIRE (update (tracker, 65535, extended) == RtpSequenceTracker::Result::Accepted);
+        REQUIRE (update (tracker, 1, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (extended == 65537);
+        CHECK (tracker.getStatistics().lost == 1);
+
+        REQUIRE (update (tracker, 0, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (extended == 65536);
+
+        const auto statistics = tracker.getStatistics();
+        CHECK (statistics.reordered == 1);
+        CHECK (statistics.lost == 0);
+        CHECK (statistics.received == 3);
+    }
+
+    SECTION ("duplicates are dropped, including late ones")
+    {
+        REQUIRE (update (tracker, 10, extended) == RtpSequenceTracker::Result::Accepted);
+        REQUIRE (update (tracker, 11, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (update (tracker, 11, extended) == RtpSequenceTracker::Result::Duplicate);
+        CHECK (update (tracker, 10, extended) == RtpSequenceTracker::Result::Duplicate);
+
+        const auto statistics = tracker.getStatistics();
+        CHECK (statistics.duplicates == 2);
+        CHECK (statistics.received == 2);
+    }
+
+    SECTION ("a packet late by less than the misorder limit is still accepted")
+    {
+        REQUIRE (update (tracker, 1000, extended) == RtpSequenceTracker::Result::Accepted);
+        for (uint16_t sequence = 1002; sequence < 1000 + RtpSequenceTracker::maxMisorder; ++sequence)
+            REQUIRE (update (tracker, sequence, extended) == RtpSequenceTracker::Result::Accepted);
+
+        // Dans la fenêtre de réordonnancement : accepté bien que très en retard
+        CHECK (update (tracker, 1001, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (extended == 1001);
+        CHECK (tracker.getStatistics().lost == 0);
+        CHECK (update (tracker, 1001, extended) == RtpSequenceTracker::Result::Duplicate);
+    }
+
+    SECTION ("a large jump needs two consecutive packets to restart the stream")
+    {
+        REQUIRE (update (tracker, 100, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (update (tracker, 40000, extended) == RtpSequenceTracker::Result::Invalid);
+        CHECK (update (tracker, 101, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (update (tracker, 40000, extended) == RtpSequenceTracker::Result::Invalid);
+        CHECK (update (tracker, 40001, extended) == RtpSequenceTracker::Result::Restarted);
+        CHECK (extended == 40001);
+        CHECK (update (tracker, 40002, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (tracker.getStatistics().received == 2);
+    }
+
+    SECTION ("a new SSRC restarts the stream immediately")
+    {
+        REQUIRE (update (tracker, 5, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (tracker.update (9000, ssrc + 1, extended) == RtpSequenceTracker::Result::Restarted);
+        CHECK (extended == 9000);
+        CHECK (tracker.update (9001, ssrc + 1, extended) == RtpSequenceTracker::Result::Accepted);
+    }
+
+    SECTION ("loss is the gap between expected and distinct received packets")
+    {
+        REQUIRE (update (tracker, 0, extended) == RtpSequenceTracker::Result::Accepted);
+        REQUIRE (update (tracker, 3, extended) == RtpSequenceTracker::Result::Accepted);
+        REQUIRE (update (tracker, 3, extended) == RtpSequenceTracker::Result::Duplicate);
+        REQUIRE (update (tracker, 5, extended) == RtpSequenceTracker::Result::Accepted);
+        CHECK (tracker.getStatistics().lost == 3);
+    }
+}
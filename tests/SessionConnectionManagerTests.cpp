@@ -0,0 +1,81 @@
+#include <Rtc/SessionConnectionManager.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    // Tient lieu de connexion WebRTC : compte les connexions ouvertes
+    struct FakeConnection
+    {
+        FakeConnection (const std::string& id, int& openCount) : sessionId (id), open (openCount) { ++open; }
+        ~FakeConnection() { --open; }
+
+        std::string sessionId;
+        int& open;
+    };
+
+    PopulatedSession makeSession (const std::string& id)
+    {
+        PopulatedSession session;
+        session._id = id;
+        return session;
+    }
+}
+
+TEST_CASE ("SessionConnectionManager", "[sessions]")
+{
+    int openConnections = 0;
+    int createdConnections = 0;
+    SessionConnectionManager<FakeConnection> manager ([&] (const PopulatedSession& session) {
+        ++createdConnections;
+        return std::make_shared<FakeConnection> (session._id, openConnections);
+    });
+
+    auto changes = manager.setSessions ({ makeSession ("a"), makeSession ("b") });
+    CHECK (changes.added == std::vector<std::string> { "a", "b" });
+    CHECK (changes.removed.empty());
+    CHECK (manager.size() == 2);
+    CHECK (openConnections == 2);
+    const auto connectionA = manager.find ("a");
+    REQUIRE (connectionA != nullptr);
+
+    SECTION ("a session that stays keeps its connection")
+    {
+        changes = manager.setSessions ({ makeSession ("b"), makeSession ("a"), makeSession ("c") });
+        CHECK (changes.added == std::vector<std::string> { "c" });
+        CHECK (changes.removed.empty());
+        CHECK (manager.find ("a") == connectionA);
+        CHECK (createdConnections == 3);
+    }
+
+    SECTION ("removing a session closes only its connection")
+    {
+        changes = manager.setSessions ({ makeSession ("a") });
+        CHECK (changes.removed == std::vector<std::string> { "b" });
+        CHECK (manager.find ("b") == nullptr);
+        CHECK (manager.find ("a") == connectionA);
+        CHECK (openConnections == 1);
+    }
+
+    SECTION ("duplicated and empty identifiers are ignored")
+    {
+        changes = manager.setSessions ({ makeSession ("a"), makeSession ("a"), makeSession ("") });
+        CHECK (changes.added.empty());
+        CHECK (manager.size() == 1);
+    }
+
+    SECTION ("clearing closes every connection")
+    {
+        manager.clear();
+        CHECK (manager.size() == 0);
+        // La référence gardée par le test est la dernière
+        CHECK (openConnections == 1);
+        CHECK (connectionA.use_count() == 1);
+    }
+
+    SECTION ("forEach visits each session once")
+    {
+        std::vector<std::string> visited;
+        manager.forEach ([&] (FakeConnection& connection) { visited.push_back (connection.sessionId); });
+        CHECK (visited == std::vector<std::string> { "a", "b" });
+    }
+}
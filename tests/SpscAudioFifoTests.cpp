@@ -0,0 +1,196 @@
+#include <Common/SpscAudioFifo.h>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+TEST_CASE ("SpscAudioFifo", "[fifo]")
+{
+    SpscAudioFifo fifo;
+    fifo.prepare (6);
+
+    SECTION ("capacity is rounded up to a power of two")
+    {
+        CHECK (fifo.getCapacity() == 8);
+        CHECK (fifo.getFreeSpace() == 8);
+    }
+
+    SECTION ("reads wrap around the end of the buffer")
+    {
+        const float block[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+        float out[8] = {};
+
+        REQUIRE (fifo.write (block, 5));
+        REQUIRE (fifo.read (out, 3) == 3);
+        REQUIRE (fifo.write (block, 5));
+        REQUIRE (fifo.read (out, 8) == 7);
+        CHECK (out[0] == 4.0f);
+        CHECK (out[2] == 1.0f);
+        CHECK (out[6] == 5.0f);
+    }
+
+    SECTION ("channels are interleaved on write")
+    {
+        const float left[] = { 1.0f, 2.0f };
+        const float right[] = { 3.0f, 4.0f };
+        const float* channels[] = { left, right };
+        float out[4] = {};
+
+        REQUIRE (fifo.writeInterleaved (channels, 2, 2));
+        REQUIRE (fifo.read (out, 4) == 4);
+        CHECK (out[0] == 1.0f);
+        CHECK (out[1] == 3.0f);
+        CHECK (out[2] == 2.0f);
+        CHECK (out[3] == 4.0f);
+    }
+
+    SECTION ("a block that does not fit is rejected whole and counted")
+    {
+        const float block[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+
+        REQUIRE (fifo.write (block, 5));
+        CHECK_FALSE (fifo.write (block, 5));
+        CHECK (fifo.getNumReady() == 5);
+        CHECK (fifo.getNumOverruns() == 1);
+    }
+
+    SECTION ("writeDropOldest overwrites the oldest samples")
+    {
+        const float block[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+        float out[8] = {};
+
+        fifo.writeDropOldest (block, 6);
+        fifo.writeDropOldest (block, 6);
+        CHECK (fifo.getNumReady() == 8);
+        CHECK (fifo.getNumDroppedSamples() == 4);
+        CHECK (fifo.getNumOverruns() == 1);
+
+        REQUIRE (fifo.read (out, 8) == 8);
+        CHECK (out[0] == 5.0f);
+        CHECK (out[1] == 6.0f);
+        CHECK (out[2] == 1.0f);
+    }
+
+    SECTION ("short reads are counted as underruns")
+    {
+        const float block[] = { 1.0f, 2.0f };
+        float out[4] = {};
+
+        REQUIRE (fifo.write (block, 2));
+        CHECK (fifo.read (out, 4) == 2);
+        CHECK (fifo.getNumUnderruns() == 1);
+    }
+}
+
+TEST_CASE ("SpscAudioFifo keeps order across threads", "[fifo]")
+{
+    SpscAudioFifo fifo;
+    fifo.prepare (256);
+    constexpr int totalSamples = 100000;
+
+    std::thread producer ([&fifo] {
+        float value = 0.0f;
+        while (value < static_cast<float> (totalSamples))
+        {
+            if (fifo.write (&value, 1))
+                value += 1.0f;
+        }
+    });
+
+    float expected = 0.0f;
+    bool inOrder = true;
+    while (expected < static_cast<float> (totalSamples))
+    {
+        float value;
+        if (fifo.read (&value, 1) == 1)
+        {
+            inOrder = inOrder && value == expected;
+            expected += 1.0f;
+        }
+    }
+    producer.join();
+
+    CHECK (inOrder);
+}
+
+TEST_CASE ("SpscAudioFifo drop-oldest never reorders samples", "[fifo]")
+{
+    SpscAudioFifo fifo;
+    fifo.prepare (64);
+    std::atomic<bool> done { false };
+
+    std::thread producer ([&] {
+        float value = 0.0f;
+        for (int block = 0; block < 100000; ++block)
+        {
+            float samples[7];
+            for (auto& sample : samples)
+                sample = value++;
+            fifo.writeDropOldest (samples, 7);
+        }
+        done = true;
+    });
+
+    float last = -1.0f;
+    bool increasing = true;
+    while (! done || fifo.getNumReady() > 0)
+    {
+        float samples[5];
+        const auto numRead = fifo.read (samples, 5);
+        for (size_t i = 0; i < numRead; ++i)
+        {
+            increasing = increasing && samples[i] > last;
+            last = samples[i];
+        }
+    }
+    producer.join();
+
+    CHECK (increasing);
+}
+
+TEST_CASE ("SpscAudioFifo wakes a waiting consumer", "[fifo]")
+{
+    SpscAudioFifo fifo;
+    fifo.prepare (1024);
+
+    SECTION ("waiting times out when the threshold is not reached")
+    {
+        const float samples[4] {};
+        fifo.write (samples, 4);
+        const auto start = std::chrono::steady_clock::now();
+        CHECK_FALSE (fifo.waitForReady (8, start + std::chrono::milliseconds (20)));
+        CHECK (std::chrono::steady_clock::now() - start >= std::chrono::milliseconds (20));
+        CHECK (fifo.waitForReady (4, std::chrono::steady_clock::now()));
+    }
+
+    SECTION ("every block is delivered without polling")
+    {
+        constexpr int numBlocks = 2000;
+        constexpr size_t blockSize = 64;
+        std::atomic<bool> done { false };
+
+        std::thread producer ([&] {
+            float block[blockSize] {};
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                while (! fifo.write (block, blockSize))
+                    std::this_thread::yield();
+                if (i % 100 == 0)
+                    std::this_thread::sleep_for (std::chrono::microseconds (200));
+            }
+            done = true;
+        });
+
+        int received = 0;
+        float block[blockSize];
+        while (received < numBlocks)
+        {
+            // Une échéance longue : un réveil manqué ferait échouer le test par dépassement
+            REQUIRE (fifo.waitForReady (blockSize, std::chrono::steady_clock::now() + std::chrono::seconds (5)));
+            fifo.read (block, blockSize);
+            ++received;
+        }
+        producer.join();
+        CHECK (done);
+    }
+}
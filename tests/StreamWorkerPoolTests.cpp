@@ -0,0 +1,157 @@
+#include <Common/StreamWorkerPool.h>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <mutex>
+#include <semaphore>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // Attend qu'une condition devienne vraie, au plus une seconde
+    template <typename Predicate>
+    bool waitUntil (Predicate predicate)
+    {
+        const auto deadline = StreamWorkerPool::Clock::now() + 1s;
+        while (! predicate())
+        {
+            if (StreamWorkerPool::Clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for (1ms);
+        }
+        return true;
+    }
+}
+
+TEST_CASE ("StreamWorkerPool", "[pool]")
+{
+    SECTION ("threads follow the number of streams, up to the cap")
+    {
+        StreamWorkerPool pool (2);
+        auto a = pool.registerStream ([] { return std::optional<StreamWorkerPool::Run>(); });
+        CHECK (pool.getNumThreads() == 1);
+        auto b = pool.registerStream ([] { return std::optional<StreamWorkerPool::Run>(); });
+        auto c = pool.registerStream ([] { return std::optional<StreamWorkerPool::Run>(); });
+        CHECK (pool.getNumThreads() == 2);
+    }
+
+    SECTION ("ready jobs run earliest deadline first")
+    {
+        StreamWorkerPool pool (1);
+        std::binary_semaphore release { 0 };
+        std::atomic<bool> blocked { false };
+        std::mutex orderMutex;
+        std::vector<std::string> order;
+
+        // Occupe le seul thread pendant que les autres flux sont programmés
+        auto blocker = pool.registerStream ([&] {
+            blocked = true;
+            release.acquire();
+            return std::optional<StreamWorkerPool::Run>();
+        });
+        const auto record = [&] (const std::string& name) {
+            return [&, name] {
+                const std::lock_guard lock (orderMutex);
+                order.push_back (name);
+                return std::optional<StreamWorkerPool::Run>();
+            };
+        };
+        auto late = pool.registerStream (record ("late"));
+        auto urgent = pool.registerStream (record ("urgent"));
+        auto middle = pool.registerStream (record ("middle"));
+
+        blocker.scheduleNow (1s);
+        REQUIRE (waitUntil ([&] { return blocked.load(); }));
+        late.scheduleNow (30ms);
+        urgent.scheduleNow (10ms);
+        middle.scheduleNow (20ms);
+        release.release();
+
+        REQUIRE (waitUntil ([&] {
+            const std::lock_guard lock (orderMutex);
+            return order.size() == 3;
+        }));
+        CHECK (order == std::vector<std::string> { "urgent", "middle", "late" });
+    }
+
+    SECTION ("an idle thread steals from a busy one")
+    {
+        StreamWorkerPool pool (2);
+        std::binary_semaphore release { 0 };
+        std::atomic<int> quickRuns { 0 };
+
+        auto blocker = pool.registerStream ([&] {
+            release.acquire();
+            return std::optional<StreamWorkerPool::Run>();
+        });
+        auto other = pool.registerStream ([] { return std::optional<StreamWorkerPool::Run>(); });
+        // Même thread d'origine que blocker (répartition circulaire sur deux threads)
+        auto quick = pool.registerStream ([&] {
+            ++quickRuns;
+            return std::optional<StreamWorkerPool::Run>();
+        });
+
+        blocker.scheduleNow (1s);
+        std::this_thread::sleep_for (5ms);
+        quick.scheduleNow (10ms);
+        CHECK (waitUntil ([&] { return quickRuns.load() == 1; }));
+        release.release();
+    }
+
+    SECTION ("a job reschedules itself and never overlaps")
+    {
+        StreamWorkerPool pool (4);
+        std::atomic<int> running { 0 };
+        std::atomic<bool> overlapped { false };
+        std::atomic<int> runs { 0 };
+
+        auto periodic = pool.registerStream ([&] {
+            if (running.fetch_add (1) != 0)
+                overlapped = true;
+            ++runs;
+            running.fetch_sub (1);
+            const auto now = StreamWorkerPool::Clock::now();
+            return std::optional<StreamWorkerPool::Run> ({ now + 1ms, now + 11ms });
+        });
+        periodic.scheduleNow (10ms);
+        for (int i = 0; i < 20; ++i)
+            periodic.scheduleNow (10ms);
+
+        CHECK (waitUntil ([&] { return runs.load() >= 10; }));
+        CHECK_FALSE (overlapped.load());
+
+        periodic.reset();
+        const int stoppedAt = runs.load();
+        std::this_thread::sleep_for (10ms);
+        CHECK (runs.load() == stoppedAt);
+        CHECK_FALSE (periodic.isRegistered());
+    }
+
+    SECTION ("a job finished after its deadline counts as a miss")
+    {
+        StreamWorkerPool pool (1);
+        auto slow = pool.registerStream ([] {
+            std::this_thread::sleep_for (5ms);
+            return std::optional<StreamWorkerPool::Run>();
+        });
+        slow.scheduleNow (1ms);
+        CHECK (waitUntil ([&] { return slow.getNumRuns() == 1; }));
+        CHECK (slow.getNumDeadlineMisses() == 1);
+    }
+
+    SECTION ("the shared pool lives as long as its streams")
+    {
+        std::weak_ptr<StreamWorkerPool> released;
+        {
+            auto stream = StreamWorkerPool::acquireShared()->registerStream ([] { return std::optional<StreamWorkerPool::Run>(); });
+            released = StreamWorkerPool::acquireShared();
+            CHECK (StreamWorkerPool::acquireShared()->getNumThreads() == 1);
+            CHECK_FALSE (released.expired());
+        }
+        // Dernier flux retiré : threads arrêtés, la suivante repart de zéro
+        CHECK (released.expired());
+        CHECK (StreamWorkerPool::acquireShared()->getNumThreads() == 0);
+    }
+}
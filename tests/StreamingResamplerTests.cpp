@@ -0,0 +1,58 @@
+#include <Common/StreamingResampler.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <vector>
+
+TEST_CASE ("StreamingResampler", "[resampler]")
+{
+    constexpr int numChannels = 2;
+    StreamingResampler resampler;
+
+    SECTION ("equal rates deinterleave without filtering")
+    {
+        resampler.prepare (48000.0, 48000.0, numChannels, 4);
+        CHECK (resampler.getLatencyFrames() == 0.0);
+
+        const std::vector<float> input { 1.0f, -1.0f, 2.0f, -2.0f, 3.0f, -3.0f };
+        std::vector<float> left (4), right (4);
+        float* const outputs[] = { left.data(), right.data() };
+
+        REQUIRE (resampler.process (input.data(), 3, outputs) == 3);
+        CHECK (left[2] == 3.0f);
+        CHECK (right[0] == -1.0f);
+
+        std::vector<float> interleaved (8);
+        REQUIRE (resampler.processInterleaved (input.data(), 3, interleaved) == 3);
+        CHECK (interleaved[4] == 3.0f);
+        CHECK (interleaved[5] == -3.0f);
+    }
+
+    SECTION ("44.1 kHz to 48 kHz keeps the rate and the channels apart")
+    {
+        constexpr int blockFrames = 441;
+        resampler.prepare (44100.0, 48000.0, numChannels, blockFrames);
+        CHECK (resampler.getLatencyFrames() > 0.0);
+
+        // Sinus à gauche, silence à droite, une seconde par blocs de 10 ms
+        std::vector<float> input (static_cast<size_t> (blockFrames * numChannels));
+        std::vector<float> output (static_cast<size_t> (resampler.getMaxOutputFrames() * numChannels));
+        int totalOutput = 0;
+        float maxRight = 0.0f;
+        for (int block = 0; block < 100; ++block)
+        {
+            for (int frame = 0; frame < blockFrames; ++frame)
+                input[static_cast<size_t> (frame * numChannels)] = static_cast<float> (0.5 * std::sin (2.0 * 3.14159265358979 * 440.0 * (block * blockFrames + frame) / 44100.0));
+
+            const int numOutput = resampler.processInterleaved (input.data(), blockFrames, output);
+            REQUIRE (numOutput <= resampler.getMaxOutputFrames());
+            for (int frame = 0; frame < numOutput; ++frame)
+                maxRight = std::max (maxRight, std::abs (output[static_cast<size_t> (frame * numChannels + 1)]));
+            totalOutput += numOutput;
+        }
+
+        // Une seconde en sortie, moins le retard de groupe que r8brain retire du début du flux
+        CHECK (std::abs (totalOutput + resampler.getLatencyFrames() - 48000.0) < 2.0);
+        CHECK (maxRight == 0.0f);
+    }
+}
@@ -0,0 +1,164 @@
+#include "LocalMeloServer.h"
+#include <Api/ApiRoutes.h>
+#include <Api/SocketRoutes.h>
+#include <vector>
+
+namespace {
+    bool isRtcRoute(const std::string &route) {
+        return route == getWsRouteString(WsRoute::GetOngoingSessionRTCInstru).toStdString()
+               || route == getWsRouteString(WsRoute::GetOngoingSessionRTCVoice).toStdString();
+    }
+
+    bool matches(const std::string &path, const ApiRoute route) {
+        return path == "/api" + getApiRouteString(route).toStdString();
+    }
+
+    ix::HttpResponsePtr jsonResponse(const int statusCode, const std::string &description, const nlohmann::json &body) {
+        ix::WebSocketHttpHeaders headers;
+        headers["Content-Type"] = "application/json";
+        return std::make_shared<ix::HttpResponse>(statusCode, description, ix::HttpErrorCode::Ok, headers, body.dump());
+    }
+}
+
+LocalMeloServer::LocalMeloServer(const int listenPort, const std::string &listenHost): port(listenPort), host(listenHost),
+    server(listenPort, listenHost) {
+    sellerContext = {
+        {"user", {{"_id", "local-seller-user"}, {"email", "seller@melo.local"}, {"firstname", "Local"}, {"lastname", "Seller"}}},
+        {"seller", {{"_id", "local-seller"}, {"userId", "local-seller-user"}}}
+    };
+    artistContext = {
+        {"user", {{"_id", "local-artist-user"}, {"email", "artist@melo.local"}, {"firstname", "Local"}, {"lastname", "Artist"}}},
+        {"artist", {{"_id", "local-artist"}, {"userId", "local-artist-user"}}}
+    };
+    session = {
+        {"_id", "local-session"},
+        {"sellerId", "local-seller"},
+        {"reservedByArtistId", "local-artist"},
+        {"status", "ongoing"},
+        {"isTest", true},
+        {"seller", sellerContext},
+        {"reservedByArtist", artistContext}
+    };
+
+    server.setOnConnectionCallback([this](const ix::HttpRequestPtr &request, const std::shared_ptr<ix::ConnectionState> &) {
+        return handleHttpRequest(request);
+    });
+    server.setOnClientMessageCallback([this](const std::shared_ptr<ix::ConnectionState> &, ix::WebSocket &webSocket,
+                                             const ix::WebSocketMessagePtr &msg) {
+        handleClientMessage(webSocket, msg);
+    });
+}
+
+LocalMeloServer::~LocalMeloServer() {
+    stop();
+}
+
+bool LocalMeloServer::start() {
+    if (const auto [listening, error] = server.listen(); !listening) {
+        juce::Logger::outputDebugString("Serveur local : impossible d'écouter sur le port " + std::to_string(port) + " (" + error + ")");
+        return false;
+    }
+    server.start();
+    return true;
+}
+
+void LocalMeloServer::stop() {
+    server.stop();
+    const std::lock_guard lock(clientsMutex);
+    clientRoutes.clear();
+}
+
+std::string LocalMeloServer::getApiUrl() const {
+    return "http://" + host + ":" + std::to_string(port) + "/api";
+}
+
+std::string LocalMeloServer::getWebsocketUrl() const {
+    return "ws://" + host + ":" + std::to_string(port);
+}
+
+size_t LocalMeloServer::getNumConnectedClients() {
+    const std::lock_guard lock(clientsMutex);
+    return clientRoutes.size();
+}
+
+// Thread ixwebsocket de la requête
+ix::HttpResponsePtr LocalMeloServer::handleHttpRequest(const ix::HttpRequestPtr &request) const {
+    const auto path = request->uri.substr(0, request->uri.find('?'));
+    const bool isGet = request->method == "GET";
+    const bool isPost = request->method == "POST";
+
+    if (isPost && matches(path, ApiRoute::PostLogin)) {
+        return jsonResponse(201, "Created", {{"access_token", "local-access-token"}});
+    }
+    if (isPost && matches(path, ApiRoute::CreateCrashReport)) {
+        return jsonResponse(201, "Created", {{"_id", "local-crash"}});
+    }
+    if (isGet && matches(path, ApiRoute::GetMyUserContext)) {
+        return jsonResponse(200, "OK", sellerContext);
+    }
+    if (isGet && matches(path, ApiRoute::GetMyOngoingSessions)) {
+        return jsonResponse(200, "OK", nlohmann::json::array({session}));
+    }
+    if (isGet && matches(path, ApiRoute::GetHealth)) {
+        return jsonResponse(200, "OK", {{"status", "ok"}});
+    }
+    return jsonResponse(404, "Not Found", {{"statusCode", 404}, {"error", "Not Found"}});
+}
+
+// Thread ixwebsocket du client
+void LocalMeloServer::handleClientMessage(ix::WebSocket &webSocket, const ix::WebSocketMessagePtr &msg) {
+    switch (msg->type) {
+        case ix::WebSocketMessageType::Open: {
+            const std::lock_guard lock(clientsMutex);
+            clientRoutes[&webSocket] = msg->openInfo.uri;
+            break;
+        }
+        case ix::WebSocketMessageType::Close: {
+            const std::lock_guard lock(clientsMutex);
+            clientRoutes.erase(&webSocket);
+            break;
+        }
+        case ix::WebSocketMessageType::Message: {
+            // Messages des plugins : { event, data } (StringUtils::createWsMessage)
+            const auto message = nlohmann::json::parse(msg->str, nullptr, false);
+            if (message.is_discarded() || !message.contains("event")) {
+                break;
+            }
+            relay(webSocket, message);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void LocalMeloServer::relay(const ix::WebSocket &from, const nlohmann::json &message) {
+    const nlohmann::json relayed = {
+        {"type", message["event"]},
+        {"data", message.value("data", nlohmann::json::object())}
+    };
+    const auto text = relayed.dump();
+
+    std::string fromRoute;
+    std::vector<std::shared_ptr<ix::WebSocket>> recipients;
+    {
+        const std::lock_guard lock(clientsMutex);
+        if (const auto route = clientRoutes.find(&from); route != clientRoutes.end()) {
+            fromRoute = route->second;
+        }
+        if (!isRtcRoute(fromRoute)) {
+            return;
+        }
+        for (const auto &client: server.getClients()) {
+            const auto route = clientRoutes.find(client.get());
+            if (route != clientRoutes.end() && isRtcRoute(route->second) && route->second != fromRoute) {
+                recipients.push_back(client);
+            }
+        }
+    }
+    // Hors du verrou : l'envoi peut bloquer le temps de vider le tampon du client
+    for (const auto &client: recipients) {
+        client->sendText(text);
+        relayedMessages.fetch_add(1);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <ixwebsocket/ixwebsocket/IXHttpServer.h>
+#include <ThirdParty/json.hpp>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Remplaçant local du serveur Melo, pour connecter un émetteur et un récepteur de bout en bout sans staging :
+// les routes de l'API (ApiRoute) et les routes de signalisation /ongoing-session* sur un seul port, comme le
+// serveur de développement (Config : http://localhost:5055/api, ws://localhost:5055).
+// Une seule session, toujours en cours, et des réponses d'API fixes. Sur les routes RTC, chaque message
+// (offre, réponse, candidat ICE) est relayé aux clients des autres routes RTC : l'émetteur (route instru)
+// et le récepteur (route voice) se répondent comme à travers le vrai serveur.
+class LocalMeloServer
+{
+public:
+    static constexpr int defaultPort = 5055;
+
+    explicit LocalMeloServer(int listenPort = defaultPort, const std::string& listenHost = "127.0.0.1");
+    ~LocalMeloServer();
+
+    LocalMeloServer(const LocalMeloServer&) = delete;
+    LocalMeloServer& operator=(const LocalMeloServer&) = delete;
+
+    // Ouvre le port et répond sur un thread ixwebsocket ; false si le port est déjà pris
+    bool start();
+    void stop();
+
+    // À passer à Config::setServerUrls() (ou MELO_API_URL / MELO_WEBSOCKET_URL)
+    [[nodiscard]] std::string getApiUrl() const;
+    [[nodiscard]] std::string getWebsocketUrl() const;
+
+    // Session renvoyée par GetMyOngoingSessions, au format lu par PopulatedSession::fromJSON
+    [[nodiscard]] const nlohmann::json& getSession() const noexcept { return session; }
+
+    [[nodiscard]] size_t getNumConnectedClients();
+    [[nodiscard]] uint64_t getNumRelayedMessages() const noexcept { return relayedMessages.load(); }
+
+private:
+    ix::HttpResponsePtr handleHttpRequest(const ix::HttpRequestPtr& request) const;
+    void handleClientMessage(ix::WebSocket& webSocket, const ix::WebSocketMessagePtr& msg);
+    // Relaie un message reçu sur une route RTC, au format attendu par SignalingConnection ({ type, data })
+    void relay(const ix::WebSocket& from, const nlohmann::json& message);
+
+    const int port;
+    const std::string host;
+
+    nlohmann::json sellerContext;
+    nlohmann::json artistContext;
+    nlohmann::json session;
+
+    ix::HttpServer server;
+
+    // Route ouverte par chaque client WebSocket
+    std::mutex clientsMutex;
+    std::map<const ix::WebSocket*, std::string> clientRoutes;
+    std::atomic<uint64_t> relayedMessages { 0 };
+};
@@ -0,0 +1,26 @@
+// Serveur local autonome : lancer les plugins avec
+//   MELO_API_URL=http://127.0.0.1:5055/api MELO_WEBSOCKET_URL=ws://127.0.0.1:5055
+// pour établir une session sans passer par staging.
+
+#include "LocalMeloServer.h"
+#include <cstdlib>
+#include <iostream>
+
+int main (int argc, char* argv[])
+{
+    const int port = argc > 1 ? std::atoi (argv[1]) : LocalMeloServer::defaultPort;
+    LocalMeloServer server (port);
+    if (!server.start())
+    {
+        std::cerr << "Impossible d'écouter sur le port " << port << std::endl;
+        return 1;
+    }
+
+    std::cout << "MELO_API_URL=" << server.getApiUrl() << std::endl;
+    std::cout << "MELO_WEBSOCKET_URL=" << server.getWebsocketUrl() << std::endl;
+    std::cout << "Entrée pour arrêter." << std::endl;
+    std::cin.get();
+
+    server.stop();
+    return 0;
+}